@@ -55,15 +55,18 @@ namespace frame {
         }
 
         void AABB::transform(glm::mat4& transform) {
-            m_min = m_max = glm::vec4(m_min, 1.0f) * transform;
-
-            update(glm::vec4(m_min.x, m_min.y, m_max.z, 1.0f) * transform);
-            update(glm::vec4(m_min.x, m_max.y, m_min.z, 1.0f) * transform);
-            update(glm::vec4(m_min.x, m_max.y, m_max.z, 1.0f) * transform);
-            update(glm::vec4(m_max.x, m_min.y, m_min.z, 1.0f) * transform);
-            update(glm::vec4(m_max.x, m_min.y, m_max.z, 1.0f) * transform);
-            update(glm::vec4(m_max.x, m_max.y, m_min.z, 1.0f) * transform);
-            update(glm::vec4(m_max, 1.0f) * transform);
+            const glm::vec3 min = m_min;
+            const glm::vec3 max = m_max;
+
+            m_min = m_max = glm::vec3(transform * glm::vec4(min, 1.0f));
+
+            update(glm::vec3(transform * glm::vec4(min.x, min.y, max.z, 1.0f)));
+            update(glm::vec3(transform * glm::vec4(min.x, max.y, min.z, 1.0f)));
+            update(glm::vec3(transform * glm::vec4(min.x, max.y, max.z, 1.0f)));
+            update(glm::vec3(transform * glm::vec4(max.x, min.y, min.z, 1.0f)));
+            update(glm::vec3(transform * glm::vec4(max.x, min.y, max.z, 1.0f)));
+            update(glm::vec3(transform * glm::vec4(max.x, max.y, min.z, 1.0f)));
+            update(glm::vec3(transform * glm::vec4(max, 1.0f)));
         }
 
         glm::vec3 AABB::getScale() const {
@@ -83,8 +86,8 @@ namespace frame {
         }
 
         void AABB::reset() {
-            m_min = std::numeric_limits<glm::vec3>::max();
-            m_max = std::numeric_limits<glm::vec3>::min();
+            m_min = glm::vec3(std::numeric_limits<float>::max());
+            m_max = glm::vec3(std::numeric_limits<float>::lowest());
         }
     }
 }
\ No newline at end of file
@@ -46,6 +46,10 @@ namespace frame {
 
         void Application::inputEvent(const InputEvent&/*input_event*/) {}
 
+        bool Application::waitForFrame() {
+            return false;
+        }
+
         ImguiDrawer* Application::getDrawer() {
             return nullptr;
         }
@@ -51,6 +51,8 @@ namespace frame {
             virtual void finish();
             virtual bool resize(const uint32_t width, const uint32_t height);
             virtual void inputEvent(const InputEvent& input_event);
+            // Paced applications block until input for the next frame should be sampled and return true
+            virtual bool waitForFrame();
             
             virtual ImguiDrawer* getDrawer();
             const std::string& getName() const;
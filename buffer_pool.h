@@ -179,6 +179,9 @@ namespace frame {
 				usage == vk::BufferUsageFlagBits::eIndirectBuffer) {
 				return 16;
 			}
+			else if (usage == vk::BufferUsageFlagBits::eTransferSrc) {
+				return limits.optimalBufferCopyOffsetAlignment;
+			}
 			else {
 				throw std::runtime_error("[BufferPool] ERROR: Usage not recognised");
 			}
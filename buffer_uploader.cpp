@@ -0,0 +1,155 @@
+/* Copyright (c) 2025, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "common/buffer_uploader.h"
+
+#include "core/command_buffer.h"
+#include "core/command_pool.h"
+#include "core/device.h"
+#include "core/fence_pool.h"
+#include "core/physical_device.h"
+#include "core/queue.h"
+#include "core/timeline_semaphore.h"
+
+namespace frame {
+	namespace common {
+		BufferUploader::BufferUploader(core::Device& device, vk::DeviceSize staging_block_size) :
+			m_device{ device },
+			m_queue{ device.getSuitableGraphicsQueue() },
+			m_command_pool{ std::make_unique<core::CommandPool>(device, m_queue.getFamilyIndex()) },
+			m_staging_pool{ device, staging_block_size, vk::BufferUsageFlagBits::eTransferSrc, VMA_MEMORY_USAGE_CPU_ONLY },
+			m_staging_block_size{ staging_block_size }
+		{
+			// Staging is skipped when a host-visible type lives in the largest device-local heap, as with unified memory.
+			// A small host-visible window into a bigger heap, like a 256 MiB BAR, is not enough for scene geometry
+			const auto& memory_properties = device.getPhysicalDevice().getMemoryProperties();
+
+			uint32_t main_heap = VK_MAX_MEMORY_HEAPS;
+			for (uint32_t i = 0; i < memory_properties.memoryHeapCount; ++i) {
+				const auto& heap = memory_properties.memoryHeaps[i];
+				if ((heap.flags & vk::MemoryHeapFlagBits::eDeviceLocal) &&
+					(main_heap == VK_MAX_MEMORY_HEAPS || heap.size > memory_properties.memoryHeaps[main_heap].size)) {
+					main_heap = i;
+				}
+			}
+
+			const vk::MemoryPropertyFlags host_visible_device_local = vk::MemoryPropertyFlagBits::eDeviceLocal | vk::MemoryPropertyFlagBits::eHostVisible;
+			bool host_visible_main_heap = false;
+			for (uint32_t i = 0; i < memory_properties.memoryTypeCount; ++i) {
+				const auto& type = memory_properties.memoryTypes[i];
+				host_visible_main_heap = host_visible_main_heap ||
+					(type.heapIndex == main_heap && (type.propertyFlags & host_visible_device_local) == host_visible_device_local);
+			}
+
+			m_device_local = !host_visible_main_heap;
+		}
+
+		BufferUploader::~BufferUploader() {
+			flush();
+			waitForUpload();
+		}
+
+		Buffer BufferUploader::upload(const std::vector<uint8_t>& data, vk::BufferUsageFlags usage) {
+			if (!m_device_local) {
+				Buffer buffer{ m_device, data.size(), usage, VMA_MEMORY_USAGE_CPU_TO_GPU };
+				buffer.update(data);
+				return buffer;
+			}
+
+			// Keep a single staging batch bounded, large scenes are flushed in several submissions
+			if (m_pending_size > 0 && m_pending_size + data.size() > m_staging_block_size) {
+				flush();
+			}
+
+			if (!m_command_buffer) {
+				waitForUpload();
+				m_command_buffer = &m_command_pool->requestCommandBuffer();
+				m_command_buffer->begin(vk::CommandBufferUsageFlagBits::eOneTimeSubmit);
+			}
+
+			auto staging = m_staging_pool.requestBufferBlock(data.size()).allocate(data.size());
+			staging.update(data);
+
+			Buffer buffer{ m_device, data.size(), usage | vk::BufferUsageFlagBits::eTransferDst, VMA_MEMORY_USAGE_GPU_ONLY };
+
+			m_command_buffer->copyBuffer(staging.getBuffer(), buffer, data.size(), staging.getOffset(), 0);
+			m_pending_size += data.size();
+
+			return buffer;
+		}
+
+		void BufferUploader::flush() {
+			if (!m_command_buffer) {
+				return;
+			}
+
+			vk::MemoryBarrier memory_barrier{ vk::AccessFlagBits::eTransferWrite,
+				vk::AccessFlagBits::eVertexAttributeRead | vk::AccessFlagBits::eIndexRead | vk::AccessFlagBits::eShaderRead };
+			m_command_buffer->getHandle().pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
+				vk::PipelineStageFlagBits::eVertexInput | vk::PipelineStageFlagBits::eVertexShader | vk::PipelineStageFlagBits::eComputeShader,
+				{}, memory_barrier, {}, {});
+
+			m_command_buffer->end();
+
+			if (m_device.hasTimelineSemaphores()) {
+				// Later graphics work is ordered by the barrier above, only the staging memory has to wait
+				auto& timeline = m_device.getTimelineSemaphore(m_queue);
+				m_upload_value = timeline.advance();
+
+				vk::TimelineSemaphoreSubmitInfo timeline_info{};
+				timeline_info.setSignalSemaphoreValues(m_upload_value);
+
+				vk::SubmitInfo submit_info{};
+				submit_info.setCommandBuffers(m_command_buffer->getHandle());
+				submit_info.setSignalSemaphores(timeline.getHandle());
+				submit_info.setPNext(&timeline_info);
+				m_queue.getHandle().submit(submit_info);
+			}
+			else {
+				m_queue.submit(*m_command_buffer, m_device.getFencePool().requestFence());
+
+				m_device.getFencePool().wait();
+				m_device.getFencePool().reset();
+				m_command_pool->resetPool();
+				m_staging_pool.reset();
+			}
+
+			m_command_buffer = nullptr;
+			m_pending_size = 0;
+		}
+
+		bool BufferUploader::isUploadComplete() const {
+			return m_upload_value == 0 || m_device.getTimelineSemaphore(m_queue).isComplete(m_upload_value);
+		}
+
+		void BufferUploader::waitForUpload() {
+			if (m_upload_value == 0) {
+				return;
+			}
+
+			m_device.getTimelineSemaphore(m_queue).wait(m_upload_value);
+			m_command_pool->resetPool();
+			m_staging_pool.reset();
+			m_upload_value = 0;
+		}
+
+		bool BufferUploader::isDeviceLocal() const {
+			return m_device_local;
+		}
+	}
+}
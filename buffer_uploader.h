@@ -0,0 +1,76 @@
+/* Copyright (c) 2025, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "common/buffer.h"
+#include "common/buffer_pool.h"
+
+namespace frame {
+	namespace core {
+		class CommandBuffer;
+		class CommandPool;
+		class Device;
+		class Queue;
+	}
+
+	namespace common {
+		// Creates GPU buffers from host data. The data goes through pooled staging blocks into device-local
+		// memory, with every copy recorded into one command buffer, unless host-visible memory covers the main
+		// device-local heap, as on unified-memory devices, where it is written directly. Copies are submitted to
+		// the queue the render context renders on, so later frames are ordered after them. With timeline semaphores
+		// a flush does not block, the staging memory is recycled once the next batch sees the copies completed.
+		class BufferUploader {
+		public:
+			static constexpr vk::DeviceSize STAGING_BLOCK_SIZE = 64 * 1024 * 1024;
+
+			BufferUploader(core::Device& device, vk::DeviceSize staging_block_size = STAGING_BLOCK_SIZE);
+			BufferUploader(const BufferUploader&) = delete;
+			BufferUploader(BufferUploader&&) = delete;
+			~BufferUploader();
+
+			BufferUploader& operator=(const BufferUploader&) = delete;
+			BufferUploader& operator=(BufferUploader&&) = delete;
+
+			Buffer upload(const std::vector<uint8_t>& data, vk::BufferUsageFlags usage);
+
+			void flush();
+
+			// Non-blocking check whether every flushed copy has finished on the GPU
+			bool isUploadComplete() const;
+
+			bool isDeviceLocal() const;
+
+		private:
+			void waitForUpload();
+
+			core::Device& m_device;
+			const core::Queue& m_queue;
+			std::unique_ptr<core::CommandPool> m_command_pool;
+			BufferPool m_staging_pool;
+			vk::DeviceSize m_staging_block_size{ 0 };
+			core::CommandBuffer* m_command_buffer{ nullptr };
+			bool m_device_local{ true };
+			vk::DeviceSize m_pending_size{ 0 };
+			uint64_t m_upload_value{ 0 };
+		};
+	}
+}
@@ -22,6 +22,7 @@
 #include "rendering/subpass.h"
 #include "rendering/render_frame.h"
 #include "core/sampler.h"
+#include "core/image.h"
 
 namespace frame {
     namespace core {
@@ -47,7 +48,8 @@ namespace frame {
             m_last_framebuffer_extent(std::exchange(other.m_last_framebuffer_extent, {})),
             m_last_render_area_extent(std::exchange(other.m_last_render_area_extent, {})),
             m_update_after_bind(std::exchange(other.m_update_after_bind, {})),
-            m_descriptor_set_layout_binding_state(std::exchange(other.m_descriptor_set_layout_binding_state, {}))
+            m_descriptor_set_layout_binding_state(std::exchange(other.m_descriptor_set_layout_binding_state, {})),
+            m_bound_descriptor_sets(std::exchange(other.m_bound_descriptor_sets, {}))
         {
         }
 
@@ -65,6 +67,9 @@ namespace frame {
             {
                 assert(primary_cmd_buf && "A primary command buffer pointer must be provided when calling begin from a secondary one");
                 auto const& render_pass_binding = primary_cmd_buf->getCurrentRenderPass();
+                if (!render_pass_binding.render_pass) {
+                    return begin(flags, primary_cmd_buf->m_pipeline_state.getRenderingFormatState());
+                }
                 return begin(flags, render_pass_binding.render_pass, render_pass_binding.framebuffer, primary_cmd_buf->getCurrentSubpassIndex());
             }
             return begin(flags, nullptr, nullptr, 0);
@@ -78,6 +83,7 @@ namespace frame {
             m_pipeline_state.reset();
             m_resource_binding_state.reset();
             m_descriptor_set_layout_binding_state.clear();
+            m_bound_descriptor_sets.clear();
             m_stored_push_constants.clear();
 
             vk::CommandBufferBeginInfo begin_info(flags);
@@ -95,12 +101,54 @@ namespace frame {
                 inheritance.subpass = subpass_index;
 
                 begin_info.pInheritanceInfo = &inheritance;
+
+                m_pipeline_state.setSubpassIndex(subpass_index);
+
+                auto blend_state = m_pipeline_state.getColorBlendState();
+                blend_state.attachments.resize(m_current_render_pass.render_pass->getColorOutputCount(subpass_index));
+                m_pipeline_state.setColorBlendState(blend_state);
             }
 
             getHandle().begin(begin_info);
             return vk::Result::eSuccess;
         }
 
+        vk::Result CommandBuffer::begin(vk::CommandBufferUsageFlags flags, const rendering::RenderingFormatState& rendering_format_state)
+        {
+            assert(m_level == vk::CommandBufferLevel::eSecondary && "Rendering formats can only be inherited by a secondary command buffer");
+
+            m_pipeline_state.reset();
+            m_resource_binding_state.reset();
+            m_descriptor_set_layout_binding_state.clear();
+            m_bound_descriptor_sets.clear();
+            m_stored_push_constants.clear();
+
+            m_current_render_pass = {};
+
+            vk::Format stencil_format = common::isDepthStencilFormat(rendering_format_state.depth_format) ?
+                rendering_format_state.depth_format : vk::Format::eUndefined;
+
+            vk::CommandBufferInheritanceRenderingInfo rendering_inheritance({}, 0,
+                rendering_format_state.color_formats,
+                rendering_format_state.depth_format,
+                stencil_format,
+                rendering_format_state.sample_count);
+
+            vk::CommandBufferInheritanceInfo inheritance;
+            inheritance.pNext = &rendering_inheritance;
+
+            vk::CommandBufferBeginInfo begin_info(flags, &inheritance);
+
+            m_pipeline_state.setRenderingFormatState(rendering_format_state);
+
+            auto blend_state = m_pipeline_state.getColorBlendState();
+            blend_state.attachments.resize(rendering_format_state.color_formats.size());
+            m_pipeline_state.setColorBlendState(blend_state);
+
+            getHandle().begin(begin_info);
+            return vk::Result::eSuccess;
+        }
+
         void CommandBuffer::beginQuery(const QueryPool& query_pool, uint32_t query, vk::QueryControlFlags flags) {
             getHandle().beginQuery(query_pool.getHandle(), query, flags);
         }
@@ -114,6 +162,7 @@ namespace frame {
             m_pipeline_state.reset();
             m_resource_binding_state.reset();
             m_descriptor_set_layout_binding_state.clear();
+            m_bound_descriptor_sets.clear();
 
             auto& render_pass = getRenderPass(render_target, load_store_infos, subpasses);
             auto& framebuffer = getDevice().getResourceCache().requestFramebuffer(render_target, render_pass);
@@ -154,6 +203,107 @@ namespace frame {
             m_pipeline_state.setColorBlendState(blend_state);
         }
 
+        void CommandBuffer::beginRendering(const rendering::RenderTarget& render_target,
+            const std::vector<rendering::LoadStoreInfo>& load_store_infos,
+            const std::vector<vk::ClearValue>& clear_values,
+            const rendering::Subpass& subpass,
+            vk::SubpassContents contents)
+        {
+            m_pipeline_state.reset();
+            m_resource_binding_state.reset();
+            m_descriptor_set_layout_binding_state.clear();
+            m_bound_descriptor_sets.clear();
+
+            m_current_render_pass = {};
+
+            const auto& attachments = render_target.getAttachments();
+            const auto& views = render_target.getViews();
+
+            auto get_load_store = [&load_store_infos](uint32_t index) {
+                return index < load_store_infos.size() ? load_store_infos[index] : rendering::LoadStoreInfo{};
+            };
+
+            rendering::RenderingFormatState rendering_format_state{};
+            std::vector<vk::RenderingAttachmentInfo> color_attachments;
+
+            const auto& color_resolve_attachments = subpass.getColorResolveAttachments();
+
+            for (uint32_t output_attachment : subpass.getOutputAttachments()) {
+                if (common::isDepthFormat(attachments[output_attachment].format)) {
+                    continue;
+                }
+
+                auto load_store = get_load_store(output_attachment);
+
+                vk::RenderingAttachmentInfo attachment_info{};
+                attachment_info.imageView = views[output_attachment].getHandle();
+                attachment_info.imageLayout = vk::ImageLayout::eColorAttachmentOptimal;
+                attachment_info.loadOp = load_store.m_load_op;
+                attachment_info.storeOp = load_store.m_store_op;
+                attachment_info.clearValue = clear_values[output_attachment];
+
+                if (color_attachments.size() < color_resolve_attachments.size()) {
+                    attachment_info.resolveMode = vk::ResolveModeFlagBits::eAverage;
+                    attachment_info.resolveImageView = views[color_resolve_attachments[color_attachments.size()]].getHandle();
+                    attachment_info.resolveImageLayout = vk::ImageLayout::eColorAttachmentOptimal;
+                }
+
+                color_attachments.push_back(attachment_info);
+                rendering_format_state.color_formats.push_back(attachments[output_attachment].format);
+                rendering_format_state.sample_count = attachments[output_attachment].samples;
+            }
+
+            vk::RenderingAttachmentInfo depth_attachment{};
+            bool has_depth = false;
+
+            if (!subpass.getDisableDepthStencilAttachment()) {
+                auto it = std::find_if(attachments.begin(), attachments.end(),
+                    [](const rendering::Attachment& attachment) { return common::isDepthFormat(attachment.format); });
+
+                if (it != attachments.end()) {
+                    auto depth_index = static_cast<uint32_t>(std::distance(attachments.begin(), it));
+                    auto load_store = get_load_store(depth_index);
+
+                    depth_attachment.imageView = views[depth_index].getHandle();
+                    depth_attachment.imageLayout = vk::ImageLayout::eDepthStencilAttachmentOptimal;
+                    depth_attachment.loadOp = load_store.m_load_op;
+                    depth_attachment.storeOp = load_store.m_store_op;
+                    depth_attachment.clearValue = clear_values[depth_index];
+
+                    if (subpass.getDepthStencilResolveMode() != vk::ResolveModeFlagBits::eNone) {
+                        depth_attachment.resolveMode = subpass.getDepthStencilResolveMode();
+                        depth_attachment.resolveImageView = views[subpass.getDepthStencilResolveAttachment()].getHandle();
+                        depth_attachment.resolveImageLayout = vk::ImageLayout::eDepthStencilAttachmentOptimal;
+                    }
+
+                    rendering_format_state.depth_format = it->format;
+                    rendering_format_state.sample_count = it->samples;
+                    has_depth = true;
+                }
+            }
+
+            vk::RenderingInfo rendering_info({}, { {}, render_target.getExtent() }, 1, 0, color_attachments);
+
+            if (contents == vk::SubpassContents::eSecondaryCommandBuffers) {
+                rendering_info.flags = vk::RenderingFlagBits::eContentsSecondaryCommandBuffers;
+            }
+
+            if (has_depth) {
+                rendering_info.pDepthAttachment = &depth_attachment;
+                if (common::isDepthStencilFormat(rendering_format_state.depth_format)) {
+                    rendering_info.pStencilAttachment = &depth_attachment;
+                }
+            }
+
+            getHandle().beginRendering(rendering_info);
+
+            m_pipeline_state.setRenderingFormatState(rendering_format_state);
+
+            auto blend_state = m_pipeline_state.getColorBlendState();
+            blend_state.attachments.resize(rendering_format_state.color_formats.size());
+            m_pipeline_state.setColorBlendState(blend_state);
+        }
+
         void CommandBuffer::bindBuffer(const common::Buffer& buffer, vk::DeviceSize offset, vk::DeviceSize range, uint32_t set, uint32_t binding, uint32_t array_element)
         {
             m_resource_binding_state.bindBuffer(buffer, offset, range, set, binding, array_element);
@@ -161,6 +311,7 @@ namespace frame {
 
         void CommandBuffer::bindImage(const ImageViewCPP& image_view, const Sampler& sampler, uint32_t set, uint32_t binding, uint32_t array_element)
         {
+            assert((image_view.getImage().getUsage() & vk::ImageUsageFlagBits::eSampled) && "Sampled images must be created with the sampled usage");
             m_resource_binding_state.bindImage(image_view, sampler, set, binding, array_element);
         }
 
@@ -203,12 +354,12 @@ namespace frame {
             getHandle().bindVertexBuffers(first_binding, buffer_handles, offsets);
         }
 
-        void CommandBuffer::blitImage(const ImageCPP& src_img, const ImageCPP& dst_img, const std::vector<vk::ImageBlit>& regions)
+        void CommandBuffer::blitImage(const ImageCPP& src_img, const ImageCPP& dst_img, const std::vector<vk::ImageBlit>& regions, vk::Filter filter)
         {
             getHandle().blitImage(
                 src_img.getHandle(), vk::ImageLayout::eTransferSrcOptimal,
                 dst_img.getHandle(), vk::ImageLayout::eTransferDstOptimal,
-                regions, vk::Filter::eNearest);
+                regions, filter);
         }
 
         void CommandBuffer::bufferMemoryBarrier(const common::Buffer& buffer,
@@ -231,9 +382,10 @@ namespace frame {
             getHandle().clearAttachments(attachment, rect);
         }
 
-        void CommandBuffer::copyBuffer(const common::Buffer& src_buffer, const common::Buffer& dst_buffer, vk::DeviceSize size)
+        void CommandBuffer::copyBuffer(const common::Buffer& src_buffer, const common::Buffer& dst_buffer, vk::DeviceSize size,
+            vk::DeviceSize src_offset, vk::DeviceSize dst_offset)
         {
-            vk::BufferCopy copy_region({}, {}, size);
+            vk::BufferCopy copy_region(src_offset, dst_offset, size);
             getHandle().copyBuffer(src_buffer.getHandle(), dst_buffer.getHandle(), copy_region);
         }
 
@@ -290,6 +442,13 @@ namespace frame {
             getHandle().drawIndexedIndirect(buffer.getHandle(), offset, draw_count, stride);
         }
 
+        void CommandBuffer::drawIndexedIndirectCount(const common::Buffer& buffer, vk::DeviceSize offset, const common::Buffer& count_buffer,
+            vk::DeviceSize count_offset, uint32_t max_draw_count, uint32_t stride)
+        {
+            flush(vk::PipelineBindPoint::eGraphics);
+            getHandle().drawIndexedIndirectCountKHR(buffer.getHandle(), offset, count_buffer.getHandle(), count_offset, max_draw_count, stride);
+        }
+
         vk::Result CommandBuffer::end()
         {
             getHandle().end();
@@ -306,6 +465,11 @@ namespace frame {
             getHandle().endRenderPass();
         }
 
+        void CommandBuffer::endRendering()
+        {
+            getHandle().endRendering();
+        }
+
         void CommandBuffer::executeCommands(CommandBuffer& secondary_command_buffer)
         {
             getHandle().executeCommands(secondary_command_buffer.getHandle());
@@ -374,7 +538,7 @@ namespace frame {
             getHandle().pipelineBarrier(src_stage_mask, dst_stage_mask, {}, {}, {}, image_memory_barrier);
         }
 
-        void CommandBuffer::nextSubpass()
+        void CommandBuffer::nextSubpass(vk::SubpassContents contents)
         {
             m_pipeline_state.setSubpassIndex(m_pipeline_state.getSubpassIndex() + 1);
 
@@ -384,9 +548,10 @@ namespace frame {
 
             m_resource_binding_state.reset();
             m_descriptor_set_layout_binding_state.clear();
+            m_bound_descriptor_sets.clear();
             m_stored_push_constants.clear();
 
-            getHandle().nextSubpass(vk::SubpassContents::eInline);
+            getHandle().nextSubpass(contents);
         }
 
         void CommandBuffer::pushConstants(const std::vector<uint8_t>& values)
@@ -547,12 +712,17 @@ namespace frame {
                         update_descriptor_sets.emplace(descriptor_set_id);
                     }
                 }
+                else
+                {
+                    update_descriptor_sets.emplace(descriptor_set_id);
+                }
             }
 
             for (auto set_it = m_descriptor_set_layout_binding_state.begin(); set_it != m_descriptor_set_layout_binding_state.end();)
             {
                 if (!pipeline_layout.hasDescriptorSetLayout(set_it->first))
                 {
+                    m_bound_descriptor_sets.erase(set_it->first);
                     set_it = m_descriptor_set_layout_binding_state.erase(set_it);
                 }
                 else
@@ -570,8 +740,16 @@ namespace frame {
                     uint32_t descriptor_set_id = resource_set_it.first;
                     auto& resource_set = resource_set_it.second;
 
-                    if (!resource_set.isDirty() && (update_descriptor_sets.find(descriptor_set_id) == update_descriptor_sets.end()))
+                    bool update_layout = update_descriptor_sets.find(descriptor_set_id) != update_descriptor_sets.end();
+                    if (!resource_set.isDirty() && !update_layout)
+                    {
+                        continue;
+                    }
+
+                    if (!update_layout && resource_set.isOffsetDirtyOnly() &&
+                        rebindDynamicOffsets(pipeline_bind_point, descriptor_set_id, resource_set))
                     {
+                        m_resource_binding_state.clearDirty(descriptor_set_id);
                         continue;
                     }
 
@@ -655,8 +833,52 @@ namespace frame {
 
                     getHandle().bindDescriptorSets(
                         pipeline_bind_point, pipeline_layout.getHandle(), descriptor_set_id, descriptor_set_handle, dynamic_offsets);
+
+                    m_bound_descriptor_sets[descriptor_set_id] = descriptor_set_handle;
+                }
+            }
+        }
+
+        bool CommandBuffer::rebindDynamicOffsets(vk::PipelineBindPoint pipeline_bind_point, uint32_t descriptor_set_id, const ResourceSet& resource_set)
+        {
+            auto bound_set_it = m_bound_descriptor_sets.find(descriptor_set_id);
+            if (bound_set_it == m_bound_descriptor_sets.end())
+            {
+                return false;
+            }
+
+            const auto& pipeline_layout = m_pipeline_state.getPipelineLayout();
+            auto& descriptor_set_layout = pipeline_layout.getDescriptorSetLayout(descriptor_set_id);
+            std::vector<uint32_t> dynamic_offsets;
+
+            // Only offsets of dynamic buffers may have changed, so the bound descriptor set stays valid
+            for (auto& binding_it : resource_set.getResourceBindings())
+            {
+                auto binding_info = descriptor_set_layout.getLayoutBinding(binding_it.first);
+                if (!binding_info)
+                {
+                    continue;
+                }
+
+                for (auto& element_it : binding_it.second)
+                {
+                    auto& resource_info = element_it.second;
+
+                    if (resource_info.m_buffer != nullptr && common::isDynamicBufferDescriptorType(binding_info->descriptorType))
+                    {
+                        dynamic_offsets.push_back(common::toU32(resource_info.m_offset));
+                    }
+                    else if (resource_info.m_dirty)
+                    {
+                        return false;
+                    }
                 }
             }
+
+            getHandle().bindDescriptorSets(
+                pipeline_bind_point, pipeline_layout.getHandle(), descriptor_set_id, bound_set_it->second, dynamic_offsets);
+
+            return true;
         }
 
         void CommandBuffer::flushPipelineState(vk::PipelineBindPoint pipeline_bind_point)
@@ -670,7 +892,9 @@ namespace frame {
 
             if (pipeline_bind_point == vk::PipelineBindPoint::eGraphics)
             {
-                m_pipeline_state.setRenderPass(*m_current_render_pass.render_pass);
+                if (m_current_render_pass.render_pass) {
+                    m_pipeline_state.setRenderPass(*m_current_render_pass.render_pass);
+                }
                 auto& pipeline = getDevice().getResourceCache().requestGraphicsPipeline(m_pipeline_state);
                 getHandle().bindPipeline(pipeline_bind_point, pipeline.getHandle());
             }
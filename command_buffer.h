@@ -60,6 +60,7 @@ namespace frame {
 
             vk::Result begin(vk::CommandBufferUsageFlags flags, CommandBuffer* primary_cmd_buf = nullptr);
             vk::Result begin(vk::CommandBufferUsageFlags flags, const RenderPassCPP* render_pass, const FramebufferCPP* framebuffer, uint32_t subpass_index);
+            vk::Result begin(vk::CommandBufferUsageFlags flags, const rendering::RenderingFormatState& rendering_format_state);
             void beginQuery(const QueryPool& query_pool, uint32_t query, vk::QueryControlFlags flags);
             void beginRenderPass(const rendering::RenderTarget& render_target,
                 const std::vector<rendering::LoadStoreInfo>& load_store_infos,
@@ -71,6 +72,11 @@ namespace frame {
                 const FramebufferCPP& framebuffer,
                 const std::vector<vk::ClearValue>& clear_values,
                 vk::SubpassContents contents = vk::SubpassContents::eInline);
+            void beginRendering(const rendering::RenderTarget& render_target,
+                const std::vector<rendering::LoadStoreInfo>& load_store_infos,
+                const std::vector<vk::ClearValue>& clear_values,
+                const rendering::Subpass& subpass,
+                vk::SubpassContents contents = vk::SubpassContents::eInline);
             void bindBuffer(const common::Buffer& buffer, vk::DeviceSize offset, vk::DeviceSize range, uint32_t set, uint32_t binding, uint32_t array_element);
             void bindImage(const ImageViewCPP& image_view, const Sampler& sampler, uint32_t set, uint32_t binding, uint32_t array_element);
             void bindImage(const ImageViewCPP& image_view, uint32_t set, uint32_t binding, uint32_t array_element);
@@ -81,13 +87,14 @@ namespace frame {
             void bindVertexBuffers(uint32_t first_binding,
                 const std::vector<std::reference_wrapper<const common::Buffer>>& buffers,
                 const std::vector<vk::DeviceSize>& offsets);
-            void blitImage(const ImageCPP& src_img, const ImageCPP& dst_img, const std::vector<vk::ImageBlit>& regions);
+            void blitImage(const ImageCPP& src_img, const ImageCPP& dst_img, const std::vector<vk::ImageBlit>& regions, vk::Filter filter = vk::Filter::eNearest);
             void bufferMemoryBarrier(const common::Buffer& buffer,
                 vk::DeviceSize offset,
                 vk::DeviceSize size,
                 const common::BufferMemoryBarrier& memory_barrier);
             void clear(vk::ClearAttachment attachment, vk::ClearRect rect);
-            void copyBuffer(const common::Buffer& src_buffer, const common::Buffer& dst_buffer, vk::DeviceSize size);
+            void copyBuffer(const common::Buffer& src_buffer, const common::Buffer& dst_buffer, vk::DeviceSize size,
+                vk::DeviceSize src_offset = 0, vk::DeviceSize dst_offset = 0);
             void copyBufferToImage(const common::Buffer& buffer, const ImageCPP& image, const std::vector<vk::BufferImageCopy>& regions);
             void copyImage(const ImageCPP& src_img, const ImageCPP& dst_img, const std::vector<vk::ImageCopy>& regions);
             void copyImageToBuffer(const ImageCPP& image,
@@ -99,16 +106,20 @@ namespace frame {
             void draw(uint32_t vertex_count, uint32_t instance_count, uint32_t first_vertex, uint32_t first_instance);
             void drawIndexed(uint32_t index_count, uint32_t instance_count, uint32_t first_index, int32_t vertex_offset, uint32_t first_instance);
             void drawIndexedIndirect(const common::Buffer& buffer, vk::DeviceSize offset, uint32_t draw_count, uint32_t stride);
+            // Requires VK_KHR_draw_indirect_count, draws the count read from count_buffer but at most max_draw_count
+            void drawIndexedIndirectCount(const common::Buffer& buffer, vk::DeviceSize offset, const common::Buffer& count_buffer,
+                vk::DeviceSize count_offset, uint32_t max_draw_count, uint32_t stride);
             vk::Result end();
             void endQuery(const QueryPool& query_pool, uint32_t query);
             void endRenderPass();
+            void endRendering();
             void executeCommands(CommandBuffer& secondary_command_buffer);
             void executeCommands(std::vector<CommandBuffer*>& secondary_command_buffers);
             RenderPassCPP& getRenderPass(const rendering::RenderTarget& render_target,
                 const std::vector<rendering::LoadStoreInfo>& load_store_infos,
                 const std::vector<std::unique_ptr<rendering::Subpass>>& subpasses);
             void imageMemoryBarrier(const ImageViewCPP& image_view, const common::ImageMemoryBarrier& memory_barrier) const;
-            void nextSubpass();
+            void nextSubpass(vk::SubpassContents contents = vk::SubpassContents::eInline);
             void pushConstants(const std::vector<uint8_t>& values);
 
             template <typename T>
@@ -155,6 +166,7 @@ namespace frame {
         private:
             void flush(vk::PipelineBindPoint pipeline_bind_point);
             void flushDescriptorState(vk::PipelineBindPoint pipeline_bind_point);
+            bool rebindDynamicOffsets(vk::PipelineBindPoint pipeline_bind_point, uint32_t descriptor_set_id, const ResourceSet& resource_set);
             void flushPipelineState(vk::PipelineBindPoint pipeline_bind_point);
             void flushPushConstants();
             const RenderPassBinding& getCurrentRenderPass() const;
@@ -173,6 +185,7 @@ namespace frame {
             vk::Extent2D m_last_render_area_extent = {};
             bool m_update_after_bind = false;
             std::unordered_map<uint32_t, DescriptorSetLayoutCPP const*> m_descriptor_set_layout_binding_state;
+            std::unordered_map<uint32_t, vk::DescriptorSet> m_bound_descriptor_sets;
         };
 
         template <class T>
@@ -43,19 +43,67 @@ namespace frame {
 				m_lighting_variant.addDefinitions({ "MAX_LIGHT_COUNT " + std::to_string(MAX_DEFERRED_LIGHT_COUNT) });
 				m_lighting_variant.addDefinitions(light_type_definitions);
 
+				if (m_light_clusters) {
+					m_light_clusters->addDefinitions(m_lighting_variant);
+				}
+
+				m_compact_lighting_variant = m_lighting_variant;
+				m_compact_lighting_variant.addDefine("COMPACT_GBUFFER");
+
+				// Only the variant of the frames' targets is built up front
+				auto& frames = getRenderContext().getRenderFrames();
+				bool compact = !frames.empty() && frames.front()->getRenderTarget().isCompactGBuffer();
+				auto& variant = compact ? m_compact_lighting_variant : m_lighting_variant;
+
 				auto& resource_cache = getRenderContext().getDevice().getResourceCache();
-				resource_cache.requestShaderModule(vk::ShaderStageFlagBits::eVertex, getVertexShader(), m_lighting_variant);
-				resource_cache.requestShaderModule(vk::ShaderStageFlagBits::eFragment, getFragmentShader(), m_lighting_variant);
+				resource_cache.requestShaderModule(vk::ShaderStageFlagBits::eVertex, getVertexShader(), variant);
+				resource_cache.requestShaderModule(vk::ShaderStageFlagBits::eFragment, getFragmentShader(), variant);
+			}
+
+			void DeferredSubpass::prepareFrame(core::CommandBuffer& command_buffer) {
+				if (m_light_clusters && !m_light_clusters->isAsyncCompute()) {
+					m_light_clusters->update(command_buffer, m_scene.getComponents<scene::Light>(), m_camera);
+				}
+			}
+
+			void DeferredSubpass::dispatchCompute(core::CommandBuffer& command_buffer) {
+				if (m_light_clusters && m_light_clusters->isAsyncCompute()) {
+					m_light_clusters->update(command_buffer, m_scene.getComponents<scene::Light>(), m_camera);
+				}
+			}
+
+			vk::PipelineStageFlags DeferredSubpass::getComputeWaitStage() const {
+				if (m_light_clusters && m_light_clusters->isAsyncCompute()) {
+					return vk::PipelineStageFlagBits::eFragmentShader;
+				}
+				return {};
+			}
+
+			void DeferredSubpass::setClusteredLighting(core::ShaderSource&& cluster_shader, bool async_compute) {
+				m_light_clusters = std::make_unique<LightClusters>(getRenderContext(), std::move(cluster_shader), async_compute);
 			}
 
 			void DeferredSubpass::draw(core::CommandBuffer& command_buffer) {
 
-				allocateLights<DeferredLights>(m_scene.getComponents<scene::Light>(), MAX_DEFERRED_LIGHT_COUNT);
+				auto scene_lights = m_scene.getComponents<scene::Light>();
+				if (m_light_clusters) {
+					scene_lights = LightClusters::getDirectionalLights(scene_lights);
+				}
+
+				allocateLights<DeferredLights>(scene_lights, MAX_DEFERRED_LIGHT_COUNT);
 				command_buffer.bindLighting(getLightingState(), 0, 4);
 
+				if (m_light_clusters) {
+					m_light_clusters->bind(command_buffer, 0, 10);
+				}
+
+				auto& render_target = getRenderContext().getActiveFrame().getRenderTarget();
+				const bool compact = render_target.isCompactGBuffer();
+				auto& variant = compact ? m_compact_lighting_variant : m_lighting_variant;
+
 				auto& resource_cache = command_buffer.getDevice().getResourceCache();
-				auto& vert_shader_module = resource_cache.requestShaderModule(vk::ShaderStageFlagBits::eVertex, getVertexShader(), m_lighting_variant);
-				auto& frag_shader_module = resource_cache.requestShaderModule(vk::ShaderStageFlagBits::eFragment, getFragmentShader(), m_lighting_variant);
+				auto& vert_shader_module = resource_cache.requestShaderModule(vk::ShaderStageFlagBits::eVertex, getVertexShader(), variant);
+				auto& frag_shader_module = resource_cache.requestShaderModule(vk::ShaderStageFlagBits::eFragment, getFragmentShader(), variant);
 
 				std::vector<core::ShaderModuleCPP*> shader_modules{ &vert_shader_module, &frag_shader_module };
 
@@ -65,7 +113,6 @@ namespace frame {
 				assert(pipeline_layout.getResources(core::ShaderResourceType::Input, vk::ShaderStageFlagBits::eVertex).empty());
 				command_buffer.setVertexInputState({});
 
-				auto& render_target = getRenderContext().getActiveFrame().getRenderTarget();
 				auto& target_views = render_target.getViews();
 				assert(3 < target_views.size());
 				
@@ -74,12 +121,18 @@ namespace frame {
 				command_buffer.bindInput(render_target.getAlbedoView(), 0, 1, 0);
 				
 				command_buffer.bindInput(render_target.getNormalView(), 0, 2, 0);
+
+				if (compact) {
+					// emissive and roughness, bound to the emissive slot of the full layout
+					command_buffer.bindInput(render_target.getMaterialView(), 0, 5, 0);
+				}
+				else {
+					command_buffer.bindInput(render_target.getMaterialView(), 0, 3, 0);
 				
-				command_buffer.bindInput(render_target.getMaterialView(), 0, 3, 0);
-				
-				command_buffer.bindInput(render_target.getPositionView(), 0, 4, 0);
+					command_buffer.bindInput(render_target.getPositionView(), 0, 4, 0);
 				
-				command_buffer.bindInput(render_target.getEmissiveView(), 0, 5, 0);
+					command_buffer.bindInput(render_target.getEmissiveView(), 0, 5, 0);
+				}
 
 				RasterizationState rasterization_state;
 				rasterization_state.cull_mode = vk::CullModeFlagBits::eFront;
@@ -18,6 +18,7 @@
 #pragma once
 
 #include "common/buffer_pool.h"
+#include "rendering/light_clusters.h"
 #include "rendering/subpass.h"
 #include "global_common.h"
 
@@ -52,12 +53,26 @@ namespace frame {
 
 				virtual void prepare() override;
 
+				virtual void prepareFrame(core::CommandBuffer& command_buffer) override;
+
 				void draw(core::CommandBuffer& command_buffer) override;
 
+				// Point and spot lights are read from a froxel grid instead of the fixed light arrays, has to be set before prepare().
+				// With async_compute the grid is built on the compute queue and overlaps the geometry work
+				void setClusteredLighting(core::ShaderSource&& cluster_shader, bool async_compute = false);
+
+				virtual void dispatchCompute(core::CommandBuffer& command_buffer) override;
+
+				virtual vk::PipelineStageFlags getComputeWaitStage() const override;
+
 			private:
 				scene::Camera& m_camera;
 				scene::Scene& m_scene;
 				core::ShaderVariant m_lighting_variant;
+				// Lighting shaders with COMPACT_GBUFFER, used for targets with the compact G-buffer layout.
+				// Position is reconstructed from depth with m_inv_view_proj
+				core::ShaderVariant m_compact_lighting_variant;
+				std::unique_ptr<LightClusters> m_light_clusters;
 			};
 		}
 	}
@@ -0,0 +1,155 @@
+/* Copyright (c) 2025, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "rendering/subpass/depth_prepass_subpass.h"
+
+#include <algorithm>
+
+#include "scene/components/material/material.h"
+#include "scene/components/mesh/sub_mesh.h"
+#include "scene/node.h"
+
+namespace frame {
+	namespace rendering {
+		namespace subpass {
+			DepthPrepassSubpass::DepthPrepassSubpass(RenderContext& render_context, core::ShaderSource&& vertex_source, core::ShaderSource&& fragment_source,
+				GeometrySubpass& geometry_subpass) :
+				Subpass{ render_context, std::move(vertex_source), std::move(fragment_source) },
+				m_geometry_subpass{ geometry_subpass }
+			{
+				setOutputAttachments({});
+				m_geometry_subpass.setDepthPrepass(true);
+
+				m_shader_variant.addDefine("INVARIANT_POSITION");
+			}
+
+			void DepthPrepassSubpass::prepare() {
+				auto& device = getRenderContext().getDevice();
+
+				for (auto* shader_module : { &device.getResourceCache().requestShaderModule(vk::ShaderStageFlagBits::eVertex, getVertexShader(), m_shader_variant),
+					&device.getResourceCache().requestShaderModule(vk::ShaderStageFlagBits::eFragment, getFragmentShader(), m_shader_variant) }) {
+					auto& resources = shader_module->getResources();
+					bool has_global_uniform = std::any_of(resources.begin(), resources.end(), [](const core::ShaderResource& resource) { return resource.name == "GlobalUniform"; });
+
+					if (has_global_uniform) {
+						shader_module->setResourceMode("GlobalUniform", core::ShaderResourceMode::Dynamic);
+					}
+				}
+			}
+
+			void DepthPrepassSubpass::draw(core::CommandBuffer& command_buffer) {
+				const RenderQueue& render_queue = m_geometry_subpass.getRenderQueue();
+				size_t opaque_end = render_queue.getLayerBegin(RenderLayer::Transparent);
+
+				// Alpha-masked draws would write the depth of their cut-out texels, they are left to the geometry subpass
+				m_draw_order.clear();
+				for (uint32_t i = 0; i < opaque_end; i++) {
+					if (render_queue[i].sub_mesh->getMaterial()->m_alpha_mode != scene::AlphaMode::Mask) {
+						m_draw_order.push_back(i);
+					}
+				}
+				std::sort(m_draw_order.begin(), m_draw_order.end(), [&render_queue](uint32_t lhs, uint32_t rhs) {
+					return render_queue[lhs].depth < render_queue[rhs].depth;
+				});
+
+				command_buffer.setDepthStencilState(DepthStencilState{});
+
+				MultisampleState multisample_state{};
+				multisample_state.rasterization_samples = getSampleCount();
+				command_buffer.setMultisampleState(multisample_state);
+
+				auto& pipeline_layout = preparePipelineLayout(command_buffer);
+				command_buffer.bindPipelineLayout(pipeline_layout);
+
+				for (uint32_t index : m_draw_order) {
+					const DrawItem& item = render_queue[index];
+					auto& sub_mesh = *item.sub_mesh;
+
+					// Culling has to match the geometry subpass, otherwise hidden faces could win the depth test
+					const auto& scale = item.node->getTransform().getScale();
+					RasterizationState rasterization_state = m_base_rasterization_state;
+					rasterization_state.front_face = scale.x * scale.y * scale.z < 0 ? vk::FrontFace::eClockwise : vk::FrontFace::eCounterClockwise;
+					if (sub_mesh.getMaterial()->m_double_sided) {
+						rasterization_state.cull_mode = vk::CullModeFlagBits::eNone;
+					}
+					command_buffer.setRasterizationState(rasterization_state);
+
+					if (!bindPosition(command_buffer, pipeline_layout, sub_mesh)) {
+						continue;
+					}
+
+					m_geometry_subpass.bindObjectUniform(command_buffer, index);
+
+					if (sub_mesh.m_vertex_indices != 0) {
+						command_buffer.bindIndexBuffer(sub_mesh.getIndexBuffer(), sub_mesh.m_index_offset, sub_mesh.m_index_type);
+						scene::IndexLod index_lod = sub_mesh.getLod(item.lod);
+						command_buffer.drawIndexed(index_lod.index_count, 1, sub_mesh.m_first_index + index_lod.first_index, sub_mesh.m_vertex_offset, 0);
+					}
+					else {
+						command_buffer.draw(sub_mesh.m_vertices_count, 1, static_cast<uint32_t>(sub_mesh.m_vertex_offset), 0);
+					}
+				}
+			}
+
+			core::PipelineLayoutCPP& DepthPrepassSubpass::preparePipelineLayout(core::CommandBuffer& command_buffer) {
+				auto& resource_cache = command_buffer.getDevice().getResourceCache();
+
+				std::vector<core::ShaderModuleCPP*> shader_modules{
+					&resource_cache.requestShaderModule(vk::ShaderStageFlagBits::eVertex, getVertexShader(), m_shader_variant),
+					&resource_cache.requestShaderModule(vk::ShaderStageFlagBits::eFragment, getFragmentShader(), m_shader_variant) };
+
+				return resource_cache.requestPipelineLayout(shader_modules);
+			}
+
+			bool DepthPrepassSubpass::bindPosition(core::CommandBuffer& command_buffer, core::PipelineLayoutCPP& pipeline_layout, scene::SubMesh& sub_mesh) {
+				scene::VertexAttribute attribute;
+				if (!sub_mesh.getAttribute("position", attribute)) {
+					return false;
+				}
+
+				const common::Buffer* buffer = sub_mesh.m_vertex_arena;
+				if (buffer == nullptr) {
+					auto buffer_it = sub_mesh.m_vertex_buffers.find("position");
+					if (buffer_it == sub_mesh.m_vertex_buffers.end()) {
+						return false;
+					}
+					buffer = &buffer_it->second;
+				}
+
+				for (auto& input_resource : pipeline_layout.getResources(core::ShaderResourceType::Input, vk::ShaderStageFlagBits::eVertex)) {
+					if (input_resource.name != "position") {
+						continue;
+					}
+
+					VertexInputState vertex_input_state;
+					vertex_input_state.attributes.push_back({ input_resource.location, input_resource.location, attribute.format, attribute.offset });
+					vertex_input_state.bindings.push_back({ input_resource.location, attribute.stride, vk::VertexInputRate::eVertex });
+					command_buffer.setVertexInputState(vertex_input_state);
+
+					std::vector<std::reference_wrapper<const common::Buffer>> buffers;
+					buffers.emplace_back(std::ref(*buffer));
+					command_buffer.bindVertexBuffers(input_resource.location, std::move(buffers), { 0 });
+
+					return true;
+				}
+
+				return false;
+			}
+		}
+	}
+}
@@ -0,0 +1,59 @@
+/* Copyright (c) 2025, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include "rendering/subpass.h"
+#include "rendering/subpass/geometry_subpass.h"
+
+namespace frame {
+	namespace rendering {
+		namespace subpass {
+			/*
+			 * Writes the depth of the opaque draws of a GeometrySubpass, front to back, with position-only vertex input.
+			 * The geometry subpass then shades them with an EQUAL depth test and no depth writes. Both vertex shaders
+			 * are built with INVARIANT_POSITION and have to compute gl_Position with the same expression,
+			 * camera_view_proj * model * vec4(position, 1.0) from the per-object GlobalUniform, for the depth to match.
+			 * Alpha-masked draws are skipped, the fragment shader has no alpha test, and keep their depth writes
+			 * in the geometry subpass. It reuses the culled and sorted draw list and the per-object uniforms
+			 * of the geometry subpass, so it has to precede it in the same render pipeline.
+			 */
+			class DepthPrepassSubpass : public Subpass {
+			public:
+				DepthPrepassSubpass(RenderContext& render_context, core::ShaderSource&& vertex_shader, core::ShaderSource&& fragment_shader,
+					GeometrySubpass& geometry_subpass);
+
+				virtual ~DepthPrepassSubpass() = default;
+
+				virtual void prepare() override;
+
+				virtual void draw(core::CommandBuffer& command_buffer) override;
+
+			private:
+				core::PipelineLayoutCPP& preparePipelineLayout(core::CommandBuffer& command_buffer);
+
+				bool bindPosition(core::CommandBuffer& command_buffer, core::PipelineLayoutCPP& pipeline_layout, scene::SubMesh& sub_mesh);
+
+				GeometrySubpass& m_geometry_subpass;
+				core::ShaderVariant m_shader_variant;
+				RasterizationState m_base_rasterization_state{};
+				std::vector<uint32_t> m_draw_order;
+			};
+		}
+	}
+}
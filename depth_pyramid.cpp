@@ -0,0 +1,360 @@
+/* Copyright (c) 2025, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "rendering/depth_pyramid.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <iterator>
+#include <utility>
+
+#include "common/common.h"
+#include "core/command_buffer.h"
+#include "rendering/render_context.h"
+
+namespace frame {
+	namespace rendering {
+		namespace {
+			uint32_t previousPowerOfTwo(uint32_t value) {
+				uint32_t result = 1;
+				while (result <= value / 2) {
+					result *= 2;
+				}
+				return result;
+			}
+		}
+
+		DepthPyramid::DepthPyramid(RenderContext& render_context, core::ShaderSource&& reduce_shader) :
+			m_render_context{ render_context },
+			m_reduce_shader{ std::move(reduce_shader) }
+		{
+			vk::SamplerCreateInfo sampler_info;
+			sampler_info.magFilter = vk::Filter::eNearest;
+			sampler_info.minFilter = vk::Filter::eNearest;
+			sampler_info.mipmapMode = vk::SamplerMipmapMode::eNearest;
+			sampler_info.addressModeU = vk::SamplerAddressMode::eClampToEdge;
+			sampler_info.addressModeV = vk::SamplerAddressMode::eClampToEdge;
+			sampler_info.addressModeW = vk::SamplerAddressMode::eClampToEdge;
+			sampler_info.maxLod = VK_LOD_CLAMP_NONE;
+
+			m_sampler = std::make_unique<core::Sampler>(render_context.getDevice(), sampler_info);
+			m_sampler->setDebugName("Depth pyramid sampler");
+		}
+
+		std::unique_ptr<DepthPyramid::Pyramid> DepthPyramid::createPyramid(const vk::Extent2D& depth_extent) const {
+			auto& device = m_render_context.getDevice();
+
+			auto pyramid = std::make_unique<Pyramid>();
+			pyramid->depth_extent = depth_extent;
+			pyramid->extent = vk::Extent2D{ previousPowerOfTwo(depth_extent.width), previousPowerOfTwo(depth_extent.height) };
+
+			pyramid->level_count = 1;
+			while ((std::max(pyramid->extent.width, pyramid->extent.height) >> pyramid->level_count) > 0) {
+				pyramid->level_count++;
+			}
+
+			pyramid->image = std::make_unique<core::ImageCPP>(
+				device,
+				vk::Extent3D{ pyramid->extent.width, pyramid->extent.height, 1 },
+				vk::Format::eR32Sfloat,
+				vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eStorage | vk::ImageUsageFlagBits::eTransferSrc,
+				VMA_MEMORY_USAGE_GPU_ONLY,
+				vk::SampleCountFlagBits::e1,
+				pyramid->level_count);
+			pyramid->image->setDebugName("Depth pyramid");
+
+			pyramid->view = std::make_unique<core::ImageViewCPP>(*pyramid->image, vk::ImageViewType::e2D);
+			for (uint32_t level = 0; level < pyramid->level_count; level++) {
+				pyramid->level_views.push_back(std::make_unique<core::ImageViewCPP>(*pyramid->image, vk::ImageViewType::e2D, vk::Format::eUndefined, level, 1));
+			}
+
+			// The readback uses the finest level that still fits READBACK_MAX_SIZE
+			while (std::max(pyramid->extent.width, pyramid->extent.height) >> pyramid->readback_level > READBACK_MAX_SIZE) {
+				pyramid->readback_level++;
+			}
+			pyramid->readback_extent = vk::Extent2D{ std::max(pyramid->extent.width >> pyramid->readback_level, 1u), std::max(pyramid->extent.height >> pyramid->readback_level, 1u) };
+
+			return pyramid;
+		}
+
+		DepthPyramid::Pyramid& DepthPyramid::requestPyramid(const vk::Extent2D& depth_extent) {
+			auto it = std::find_if(m_pyramids.begin(), m_pyramids.end(), [&depth_extent](const std::unique_ptr<Pyramid>& pyramid) {
+				return pyramid->depth_extent == depth_extent;
+			});
+
+			if (it == m_pyramids.end()) {
+				if (m_pyramids.size() >= MAX_CACHED_EXTENTS) {
+					auto oldest = std::min_element(m_pyramids.begin(), m_pyramids.end(), [](const std::unique_ptr<Pyramid>& lhs, const std::unique_ptr<Pyramid>& rhs) {
+						return lhs->last_used < rhs->last_used;
+					});
+					releasePyramid(std::move(*oldest));
+					m_pyramids.erase(oldest);
+				}
+
+				m_pyramids.push_back(createPyramid(depth_extent));
+				it = std::prev(m_pyramids.end());
+			}
+
+			(*it)->last_used = m_frame_count;
+			return **it;
+		}
+
+		void DepthPyramid::releasePyramid(std::unique_ptr<Pyramid>&& pyramid) {
+			// Earlier frames may still reduce into the image or copy into the readback buffers
+			if (m_render_context.getDevice().hasTimelineSemaphores()) {
+				std::shared_ptr<Pyramid> released{ std::move(pyramid) };
+				m_render_context.deferDestruction([released]() mutable {
+					released.reset();
+				});
+			}
+			else {
+				m_render_context.getDevice().getHandle().waitIdle();
+				pyramid.reset();
+			}
+		}
+
+		void DepthPyramid::collectReadback() {
+			const size_t frame_index = m_render_context.getActiveFrameIndex();
+
+			// The frame owning this slot has been waited on, its copies are complete. Older ones are superseded
+			Readback* latest = nullptr;
+			const Pyramid* latest_pyramid = nullptr;
+			for (auto& pyramid : m_pyramids) {
+				if (frame_index >= pyramid->readbacks.size()) {
+					continue;
+				}
+
+				auto& readback = pyramid->readbacks[frame_index];
+				if (readback.pending && (!latest || readback.frame > latest->frame)) {
+					latest = &readback;
+					latest_pyramid = pyramid.get();
+				}
+				readback.pending = false;
+			}
+
+			if (!latest) {
+				return;
+			}
+
+			std::swap(m_previous_readback_depth, m_readback_depth);
+
+			m_readback_depth.extent = latest_pyramid->readback_extent;
+			m_readback_depth.depth.resize(static_cast<size_t>(m_readback_depth.extent.width) * m_readback_depth.extent.height);
+			std::memcpy(m_readback_depth.depth.data(), latest->buffer->map(), m_readback_depth.depth.size() * sizeof(float));
+			latest->buffer->unmap();
+
+			m_readback_depth.view_proj = latest->view_proj;
+		}
+
+		void DepthPyramid::build(core::CommandBuffer& command_buffer, RenderTarget& render_target, const glm::mat4& view_proj) {
+			auto& depth_view = render_target.getDepthView();
+
+			assert(common::isDepthOnlyFormat(depth_view.getFormat()) && "[DepthPyramid] ASSERT: Depth attachment needs a depth-only format to be sampled");
+
+			m_frame_count++;
+			m_active = &requestPyramid(render_target.getExtent());
+
+			if (m_readback_enabled) {
+				collectReadback();
+			}
+
+			common::ImageMemoryBarrier depth_barrier{};
+			depth_barrier.m_old_layout = render_target.getLayout(0);
+			depth_barrier.m_new_layout = vk::ImageLayout::eShaderReadOnlyOptimal;
+			depth_barrier.m_src_access_mask = vk::AccessFlagBits::eDepthStencilAttachmentWrite;
+			depth_barrier.m_dst_access_mask = vk::AccessFlagBits::eShaderRead;
+			depth_barrier.m_src_stage_mask = vk::PipelineStageFlagBits::eEarlyFragmentTests | vk::PipelineStageFlagBits::eLateFragmentTests;
+			depth_barrier.m_dst_stage_mask = vk::PipelineStageFlagBits::eComputeShader;
+			command_buffer.imageMemoryBarrier(depth_view, depth_barrier);
+			render_target.setLayout(0, depth_barrier.m_new_layout);
+
+			// Every level is rewritten, the previous contents are discarded
+			common::ImageMemoryBarrier pyramid_barrier{};
+			pyramid_barrier.m_old_layout = vk::ImageLayout::eUndefined;
+			pyramid_barrier.m_new_layout = vk::ImageLayout::eGeneral;
+			pyramid_barrier.m_dst_access_mask = vk::AccessFlagBits::eShaderWrite;
+			pyramid_barrier.m_src_stage_mask = vk::PipelineStageFlagBits::eComputeShader | vk::PipelineStageFlagBits::eTransfer;
+			pyramid_barrier.m_dst_stage_mask = vk::PipelineStageFlagBits::eComputeShader;
+			command_buffer.imageMemoryBarrier(*m_active->view, pyramid_barrier);
+
+			auto& resource_cache = m_render_context.getDevice().getResourceCache();
+			auto& reduce_module = resource_cache.requestShaderModule(vk::ShaderStageFlagBits::eCompute, m_reduce_shader);
+			auto& pipeline_layout = resource_cache.requestPipelineLayout({ &reduce_module });
+
+			command_buffer.bindPipelineLayout(pipeline_layout);
+
+			vk::Extent2D src_extent = m_active->depth_extent;
+
+			for (uint32_t level = 0; level < m_active->level_count; level++) {
+				vk::Extent2D dst_extent{ std::max(m_active->extent.width >> level, 1u), std::max(m_active->extent.height >> level, 1u) };
+
+				command_buffer.bindImage(level == 0 ? depth_view : *m_active->level_views[level - 1], *m_sampler, 0, 0, 0);
+				command_buffer.bindImage(*m_active->level_views[level], 0, 1, 0);
+				command_buffer.pushConstants(glm::uvec4(src_extent.width, src_extent.height, dst_extent.width, dst_extent.height));
+
+				command_buffer.dispatch((dst_extent.width + REDUCE_WORKGROUP_SIZE - 1) / REDUCE_WORKGROUP_SIZE,
+					(dst_extent.height + REDUCE_WORKGROUP_SIZE - 1) / REDUCE_WORKGROUP_SIZE, 1);
+
+				common::ImageMemoryBarrier level_barrier{};
+				level_barrier.m_old_layout = vk::ImageLayout::eGeneral;
+				level_barrier.m_new_layout = vk::ImageLayout::eShaderReadOnlyOptimal;
+				level_barrier.m_src_access_mask = vk::AccessFlagBits::eShaderWrite;
+				level_barrier.m_dst_access_mask = vk::AccessFlagBits::eShaderRead;
+				level_barrier.m_src_stage_mask = vk::PipelineStageFlagBits::eComputeShader;
+				level_barrier.m_dst_stage_mask = vk::PipelineStageFlagBits::eComputeShader;
+				command_buffer.imageMemoryBarrier(*m_active->level_views[level], level_barrier);
+
+				src_extent = dst_extent;
+			}
+
+			if (m_readback_enabled) {
+				recordReadback(command_buffer, view_proj);
+			}
+
+			m_built = true;
+		}
+
+		void DepthPyramid::recordReadback(core::CommandBuffer& command_buffer, const glm::mat4& view_proj) {
+			auto& pyramid = *m_active;
+
+			// The frame count can grow with the swapchain image count, existing slots keep their buffers
+			while (pyramid.readbacks.size() < m_render_context.getRenderFrames().size()) {
+				pyramid.readbacks.emplace_back();
+				pyramid.readbacks.back().buffer = std::make_unique<common::Buffer>(m_render_context.getDevice(),
+					static_cast<vk::DeviceSize>(pyramid.readback_extent.width) * pyramid.readback_extent.height * sizeof(float),
+					vk::BufferUsageFlagBits::eTransferDst, VMA_MEMORY_USAGE_GPU_TO_CPU, VMA_ALLOCATION_CREATE_MAPPED_BIT);
+			}
+
+			auto& readback = pyramid.readbacks[m_render_context.getActiveFrameIndex()];
+			auto& level_view = *pyramid.level_views[pyramid.readback_level];
+
+			common::ImageMemoryBarrier copy_barrier{};
+			copy_barrier.m_old_layout = vk::ImageLayout::eShaderReadOnlyOptimal;
+			copy_barrier.m_new_layout = vk::ImageLayout::eTransferSrcOptimal;
+			copy_barrier.m_src_access_mask = vk::AccessFlagBits::eShaderWrite;
+			copy_barrier.m_dst_access_mask = vk::AccessFlagBits::eTransferRead;
+			copy_barrier.m_src_stage_mask = vk::PipelineStageFlagBits::eComputeShader;
+			copy_barrier.m_dst_stage_mask = vk::PipelineStageFlagBits::eTransfer;
+			command_buffer.imageMemoryBarrier(level_view, copy_barrier);
+
+			vk::BufferImageCopy copy_region{};
+			copy_region.imageSubresource = vk::ImageSubresourceLayers{ vk::ImageAspectFlagBits::eColor, pyramid.readback_level, 0, 1 };
+			copy_region.imageExtent = vk::Extent3D{ pyramid.readback_extent.width, pyramid.readback_extent.height, 1 };
+			command_buffer.copyImageToBuffer(*pyramid.image, vk::ImageLayout::eTransferSrcOptimal, *readback.buffer, { copy_region });
+
+			common::ImageMemoryBarrier sample_barrier{};
+			sample_barrier.m_old_layout = vk::ImageLayout::eTransferSrcOptimal;
+			sample_barrier.m_new_layout = vk::ImageLayout::eShaderReadOnlyOptimal;
+			sample_barrier.m_src_stage_mask = vk::PipelineStageFlagBits::eTransfer;
+			sample_barrier.m_dst_stage_mask = vk::PipelineStageFlagBits::eComputeShader;
+			command_buffer.imageMemoryBarrier(level_view, sample_barrier);
+
+			common::BufferMemoryBarrier host_barrier{};
+			host_barrier.m_src_access_mask = vk::AccessFlagBits::eTransferWrite;
+			host_barrier.m_dst_access_mask = vk::AccessFlagBits::eHostRead;
+			host_barrier.m_src_stage_mask = vk::PipelineStageFlagBits::eTransfer;
+			host_barrier.m_dst_stage_mask = vk::PipelineStageFlagBits::eHost;
+			command_buffer.bufferMemoryBarrier(*readback.buffer, 0, VK_WHOLE_SIZE, host_barrier);
+
+			readback.view_proj = view_proj;
+			readback.frame = m_frame_count;
+			readback.pending = true;
+		}
+
+		bool DepthPyramid::isOccluded(const glm::vec3& center, const glm::vec3& extent) const {
+			// Hidden in both frames is taken as still hidden, anything that was visible in either is drawn
+			return isOccluded(m_readback_depth, center, extent) && isOccluded(m_previous_readback_depth, center, extent);
+		}
+
+		bool DepthPyramid::isOccluded(const ReadbackDepth& readback_depth, const glm::vec3& center, const glm::vec3& extent) const {
+			if (readback_depth.depth.empty()) {
+				return false;
+			}
+
+			glm::vec2 uv_min{ 1.0f };
+			glm::vec2 uv_max{ 0.0f };
+			float nearest_depth = 0.0f;
+
+			for (uint32_t corner = 0; corner < 8; corner++) {
+				glm::vec3 offset{ corner & 1 ? extent.x : -extent.x, corner & 2 ? extent.y : -extent.y, corner & 4 ? extent.z : -extent.z };
+				glm::vec4 clip = readback_depth.view_proj * glm::vec4(center + offset, 1.0f);
+
+				// Boxes crossing the near plane are never treated as occluded
+				if (clip.w <= 0.0f) {
+					return false;
+				}
+
+				glm::vec3 ndc = glm::vec3(clip) / clip.w;
+				uv_min = glm::min(uv_min, glm::vec2(ndc) * 0.5f + 0.5f);
+				uv_max = glm::max(uv_max, glm::vec2(ndc) * 0.5f + 0.5f);
+				nearest_depth = std::max(nearest_depth, ndc.z);
+			}
+
+			uv_min = glm::clamp(uv_min, glm::vec2(0.0f), glm::vec2(1.0f));
+			uv_max = glm::clamp(uv_max, glm::vec2(0.0f), glm::vec2(1.0f));
+
+			const vk::Extent2D& readback_extent = readback_depth.extent;
+			uint32_t x_begin = std::min(static_cast<uint32_t>(uv_min.x * readback_extent.width), readback_extent.width - 1);
+			uint32_t x_end = std::min(static_cast<uint32_t>(uv_max.x * readback_extent.width), readback_extent.width - 1);
+			uint32_t y_begin = std::min(static_cast<uint32_t>(uv_min.y * readback_extent.height), readback_extent.height - 1);
+			uint32_t y_end = std::min(static_cast<uint32_t>(uv_max.y * readback_extent.height), readback_extent.height - 1);
+
+			// Reversed depth: the box is hidden when its nearest point lies behind the farthest occluder it covers
+			float farthest_depth = 1.0f;
+			for (uint32_t y = y_begin; y <= y_end; y++) {
+				for (uint32_t x = x_begin; x <= x_end; x++) {
+					farthest_depth = std::min(farthest_depth, readback_depth.depth[y * readback_extent.width + x]);
+				}
+			}
+
+			return nearest_depth < farthest_depth;
+		}
+
+		void DepthPyramid::setReadback(bool enable) {
+			m_readback_enabled = enable;
+
+			if (!enable) {
+				m_readback_depth.depth.clear();
+				m_previous_readback_depth.depth.clear();
+			}
+		}
+
+		bool DepthPyramid::isBuilt() const {
+			return m_built;
+		}
+
+		const core::ImageViewCPP& DepthPyramid::getView() const {
+			assert(m_active && "[DepthPyramid] ASSERT: Depth pyramid has not been built");
+			return *m_active->view;
+		}
+
+		const core::Sampler& DepthPyramid::getSampler() const {
+			return *m_sampler;
+		}
+
+		const vk::Extent2D& DepthPyramid::getExtent() const {
+			assert(m_active && "[DepthPyramid] ASSERT: Depth pyramid has not been built");
+			return m_active->extent;
+		}
+
+		uint32_t DepthPyramid::getLevelCount() const {
+			return m_active ? m_active->level_count : 0;
+		}
+	}
+}
@@ -0,0 +1,134 @@
+/* Copyright (c) 2025, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "common/buffer.h"
+#include "core/image.h"
+#include "core/image_view.h"
+#include "core/sampler.h"
+#include "core/shader_module.h"
+#include "global_common.h"
+
+namespace frame {
+	namespace core {
+		class CommandBuffer;
+	}
+
+	namespace rendering {
+		class RenderContext;
+		class RenderTarget;
+
+		/*
+		 * Hierarchical-Z pyramid built from a depth attachment, used for occlusion culling.
+		 * Level 0 is the largest power of two that fits the depth extent and every further level halves it.
+		 * Depth is reversed, so each texel keeps the minimum (farthest) depth of its footprint.
+		 * Reduce shader bindings (set 0): 0 source sampler, 1 destination r32f storage image.
+		 * The push constant holds the source and destination sizes; the shader has to read every source
+		 * texel covered by the destination texel to keep the reduction conservative.
+		 * With readback enabled a coarse level is copied to the host and is used by isOccluded()
+		 * once its frame slot comes around again. Readbacks are frames in flight old, so a box only counts
+		 * as occluded when the two latest readbacks, each with its own view_proj, both hide it.
+		 * Images and readback buffers are kept per depth extent, like the dynamic resolution targets, so a scale
+		 * change does not recreate them under frames still in flight. Beyond MAX_CACHED_EXTENTS the least
+		 * recently used set is released once the GPU is done with it.
+		 */
+		class DepthPyramid {
+		public:
+			static constexpr uint32_t REDUCE_WORKGROUP_SIZE = 8;
+			static constexpr uint32_t READBACK_MAX_SIZE = 64;
+			static constexpr size_t MAX_CACHED_EXTENTS = 8;
+
+			DepthPyramid(RenderContext& render_context, core::ShaderSource&& reduce_shader);
+
+			void build(core::CommandBuffer& command_buffer, RenderTarget& render_target, const glm::mat4& view_proj);
+
+			bool isOccluded(const glm::vec3& center, const glm::vec3& extent) const;
+
+			void setReadback(bool enable);
+
+			bool isBuilt() const;
+			const core::ImageViewCPP& getView() const;
+			const core::Sampler& getSampler() const;
+			const vk::Extent2D& getExtent() const;
+			uint32_t getLevelCount() const;
+
+		private:
+			struct Readback {
+				std::unique_ptr<common::Buffer> buffer;
+				glm::mat4 view_proj{ 1.0f };
+				uint64_t frame{ 0 };
+				bool pending{ false };
+			};
+
+			struct ReadbackDepth {
+				std::vector<float> depth;
+				vk::Extent2D extent{};
+				glm::mat4 view_proj{ 1.0f };
+			};
+
+			struct Pyramid {
+				vk::Extent2D depth_extent{};
+				vk::Extent2D extent{};
+				uint32_t level_count{ 0 };
+
+				std::unique_ptr<core::ImageCPP> image;
+				std::unique_ptr<core::ImageViewCPP> view;
+				std::vector<std::unique_ptr<core::ImageViewCPP>> level_views;
+
+				uint32_t readback_level{ 0 };
+				vk::Extent2D readback_extent{};
+				std::vector<Readback> readbacks;
+
+				uint64_t last_used{ 0 };
+			};
+
+			// Returns the pyramid for depth_extent, creating it and evicting the least recently used one as needed
+			Pyramid& requestPyramid(const vk::Extent2D& depth_extent);
+
+			std::unique_ptr<Pyramid> createPyramid(const vk::Extent2D& depth_extent) const;
+
+			void releasePyramid(std::unique_ptr<Pyramid>&& pyramid);
+
+			// Takes the newest completed readback of the active frame slot across all pyramids
+			void collectReadback();
+
+			void recordReadback(core::CommandBuffer& command_buffer, const glm::mat4& view_proj);
+
+			bool isOccluded(const ReadbackDepth& readback_depth, const glm::vec3& center, const glm::vec3& extent) const;
+
+			RenderContext& m_render_context;
+			core::ShaderSource m_reduce_shader;
+
+			bool m_built{ false };
+			uint64_t m_frame_count{ 0 };
+
+			std::vector<std::unique_ptr<Pyramid>> m_pyramids;
+			Pyramid* m_active{ nullptr };
+			std::unique_ptr<core::Sampler> m_sampler;
+
+			bool m_readback_enabled{ false };
+			// Latest completed readback and the one before it
+			ReadbackDepth m_readback_depth;
+			ReadbackDepth m_previous_readback_depth;
+		};
+	}
+}
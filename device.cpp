@@ -22,6 +22,7 @@
 #include "core/physical_device.h"
 #include "core/queue.h"
 #include "core/fence_pool.h"
+#include "core/timeline_semaphore.h"
 #include <vulkan/vulkan.hpp>
 
 namespace frame {
@@ -262,7 +263,7 @@ namespace frame {
 
             for (uint32_t queue_family_index = 0U; queue_family_index < queue_family_properties.size(); ++queue_family_index) {
                 vk::QueueFamilyProperties const& queue_family_property = queue_family_properties[queue_family_index];
-                vk::Bool32 present_supported = physical_device.getHandle().getSurfaceSupportKHR(queue_family_index, m_surface);
+                vk::Bool32 present_supported = m_surface ? physical_device.getHandle().getSurfaceSupportKHR(queue_family_index, m_surface) : VK_FALSE;
 
                 for (uint32_t queue_index = 0U; queue_index < queue_family_property.queueCount; ++queue_index) {
                     m_queues[queue_family_index].emplace_back(*this, queue_family_index, queue_family_property, present_supported, queue_index);
@@ -277,6 +278,12 @@ namespace frame {
         }
 
         Device::~Device() {
+            if (!m_deferred_destructions.empty()) {
+                getHandle().waitIdle();
+                collectGarbage();
+            }
+
+            m_timeline_semaphores.clear();
             m_resource_cache.clear();
             m_command_pool.reset();
             m_fence_pool.reset();
@@ -326,13 +333,13 @@ namespace frame {
 
         Queue const& Device::getQueue(uint32_t queue_family_index, uint32_t queue_index) const { return m_queues[queue_family_index][queue_index]; }
 
-        Queue const& Device::getQueueByFlags(vk::QueueFlags required_queue_flags, uint32_t queue_index) const {
+        Queue const& Device::getQueueByFlags(vk::QueueFlags required_queue_flags, uint32_t queue_index, vk::QueueFlags excluded_queue_flags) const {
             for (size_t queue_family_index = 0U; queue_family_index < m_queues.size(); ++queue_family_index) {
                 Queue const& first_queue = m_queues[queue_family_index][0];
                 vk::QueueFlags queue_flags = first_queue.getProperties().queueFlags;
                 uint32_t queue_count = first_queue.getProperties().queueCount;
 
-                if (((queue_flags & required_queue_flags) == required_queue_flags) && queue_index < queue_count) {
+                if (((queue_flags & required_queue_flags) == required_queue_flags) && !(queue_flags & excluded_queue_flags) && queue_index < queue_count) {
                     return m_queues[queue_family_index][queue_index];
                 }
             }
@@ -477,6 +484,44 @@ namespace frame {
             }
         }
 
+        void Device::enableTimelineSemaphores() {
+            if (hasTimelineSemaphores()) {
+                return;
+            }
+
+            m_timeline_semaphores.resize(m_queues.size());
+            for (size_t family_index = 0; family_index < m_queues.size(); ++family_index) {
+                for (size_t queue_index = 0; queue_index < m_queues[family_index].size(); ++queue_index) {
+                    m_timeline_semaphores[family_index].push_back(std::make_unique<TimelineSemaphore>(*this));
+                }
+            }
+        }
+
+        bool Device::hasTimelineSemaphores() const {
+            return !m_timeline_semaphores.empty();
+        }
+
+        TimelineSemaphore& Device::getTimelineSemaphore(const Queue& queue) const {
+            assert(hasTimelineSemaphores() && "[Device] ASSERT: Timeline semaphores are not enabled");
+            return *m_timeline_semaphores[queue.getFamilyIndex()][queue.getIndex()];
+        }
+
+        void Device::deferDestruction(const Queue& queue, uint64_t value, std::function<void()>&& destroy) {
+            m_deferred_destructions.push_back({ &getTimelineSemaphore(queue), value, std::move(destroy) });
+        }
+
+        void Device::collectGarbage() {
+            for (auto it = m_deferred_destructions.begin(); it != m_deferred_destructions.end();) {
+                if (it->timeline->isComplete(it->value)) {
+                    it->destroy();
+                    it = m_deferred_destructions.erase(it);
+                }
+                else {
+                    ++it;
+                }
+            }
+        }
+
         CommandPool& Device::getCommandPool() {
             return *m_command_pool;
         }
@@ -17,6 +17,8 @@
 
 #pragma once
 
+#include <functional>
+
 #include "core/resource_cache.h"
 #include "core/command_pool.h"
 #include <vulkan/vulkan.hpp>
@@ -29,6 +31,7 @@ namespace frame {
         class CommandPool;
         class Queue;
         class FencePool;
+        class TimelineSemaphore;
         class ResourceCache;
 
         class Device : public VulkanResource<vk::Device> {
@@ -48,13 +51,22 @@ namespace frame {
             PhysicalDevice const& getPhysicalDevice() const;
             DebugUtils const& getDebugUtils() const;
             Queue const& getQueue(uint32_t queue_family_index, uint32_t queue_index) const;
-            Queue const& getQueueByFlags(vk::QueueFlags queue_flags, uint32_t queue_index) const;
+            Queue const& getQueueByFlags(vk::QueueFlags queue_flags, uint32_t queue_index, vk::QueueFlags excluded_queue_flags = {}) const;
             Queue const& getQueueByPresent(uint32_t queue_index) const;
             Queue const& getSuitableGraphicsQueue() const;
             CommandPool& getCommandPool();
             FencePool& getFencePool();
             ResourceCache& getResourceCache();
             uint32_t getQueueFamilyIndex(vk::QueueFlagBits queue_flag) const;
+
+            // Creates one timeline semaphore per queue, requires the timelineSemaphore feature
+            void enableTimelineSemaphores();
+            bool hasTimelineSemaphores() const;
+            TimelineSemaphore& getTimelineSemaphore(const Queue& queue) const;
+
+            // Runs destroy once the queue's timeline reaches value, see collectGarbage()
+            void deferDestruction(const Queue& queue, uint64_t value, std::function<void()>&& destroy);
+            void collectGarbage();
             
             bool isExtensionSupported(std::string const& extension) const;
             bool isEnabled(std::string const& extension) const;
@@ -78,6 +90,12 @@ namespace frame {
                 vk::Semaphore signal_semaphore = vk::Semaphore()) const;
 
         private:
+            struct DeferredDestruction {
+                const TimelineSemaphore* timeline;
+                uint64_t value;
+                std::function<void()> destroy;
+            };
+
             PhysicalDevice const& m_physical_device;
             vk::SurfaceKHR m_surface{ nullptr };
             std::unique_ptr<DebugUtils> m_debug_utils;
@@ -85,6 +103,8 @@ namespace frame {
             std::vector<std::vector<Queue>> m_queues;
             std::unique_ptr<CommandPool> m_command_pool;
             std::unique_ptr<FencePool> m_fence_pool;
+            std::vector<std::vector<std::unique_ptr<TimelineSemaphore>>> m_timeline_semaphores;
+            std::vector<DeferredDestruction> m_deferred_destructions;
             ResourceCache m_resource_cache;
         };
     }
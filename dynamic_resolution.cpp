@@ -0,0 +1,147 @@
+/* Copyright (c) 2025, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "rendering/dynamic_resolution.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "core/command_buffer.h"
+#include "core/physical_device.h"
+#include "rendering/render_context.h"
+
+namespace frame {
+	namespace rendering {
+		DynamicResolution::DynamicResolution(RenderContext& render_context, float frame_budget,
+			RenderTarget::CreateFunc create_render_target_func, const std::vector<float>& scales) :
+			m_render_context{ render_context },
+			m_create_render_target_func{ std::move(create_render_target_func) },
+			m_scales{ scales },
+			m_frame_budget{ frame_budget }
+		{
+			if (m_scales.empty()) {
+				throw std::runtime_error("[DynamicResolution] ERROR: No scales given");
+			}
+
+			std::sort(m_scales.begin(), m_scales.end());
+			m_scale_index = m_scales.size() - 1;
+
+			auto format = m_render_context.getFormat();
+			auto properties = m_render_context.getDevice().getPhysicalDevice().getFormatProperties(format);
+			const auto blit_features = vk::FormatFeatureFlagBits::eBlitSrc | vk::FormatFeatureFlagBits::eBlitDst;
+			if ((properties.optimalTilingFeatures & blit_features) != blit_features) {
+				throw std::runtime_error("[DynamicResolution] ERROR: Surface format does not support blits");
+			}
+			if (!(properties.optimalTilingFeatures & vk::FormatFeatureFlagBits::eSampledImageFilterLinear)) {
+				m_filter = vk::Filter::eNearest;
+			}
+		}
+
+		void DynamicResolution::update(float frame_time) {
+			m_smoothed_frame_time = m_smoothed_frame_time > 0.0f ? m_smoothed_frame_time + (frame_time - m_smoothed_frame_time) * 0.1f : frame_time;
+
+			if (++m_frames_since_change < SETTLE_FRAMES) {
+				return;
+			}
+
+			size_t scale_index = m_scale_index;
+			if (m_smoothed_frame_time > m_frame_budget && scale_index > 0) {
+				--scale_index;
+			}
+			else if (scale_index + 1 < m_scales.size()) {
+				float area_ratio = (m_scales[scale_index + 1] * m_scales[scale_index + 1]) / (m_scales[scale_index] * m_scales[scale_index]);
+				if (m_smoothed_frame_time * area_ratio < m_frame_budget * HEADROOM) {
+					++scale_index;
+				}
+			}
+
+			if (scale_index != m_scale_index) {
+				// Carry the estimate over to the new scale instead of waiting for it to converge again
+				m_smoothed_frame_time *= (m_scales[scale_index] * m_scales[scale_index]) / (m_scales[m_scale_index] * m_scales[m_scale_index]);
+				m_scale_index = scale_index;
+				m_frames_since_change = 0;
+			}
+		}
+
+		RenderTarget& DynamicResolution::getRenderTarget() {
+			const auto& surface_extent = m_render_context.getSurfaceExtent();
+			const size_t frame_count = m_render_context.getRenderFrames().size();
+
+			if (surface_extent != m_surface_extent || m_render_targets.size() != frame_count) {
+				if (!m_render_targets.empty()) {
+					m_render_context.getDevice().getHandle().waitIdle();
+				}
+				m_render_targets.clear();
+				m_render_targets.resize(frame_count);
+				for (auto& frame_targets : m_render_targets) {
+					frame_targets.resize(m_scales.size());
+				}
+				m_surface_extent = surface_extent;
+			}
+
+			auto& render_target = m_render_targets[m_render_context.getActiveFrameIndex()][m_scale_index];
+			if (!render_target) {
+				auto extent = getScaledExtent();
+				core::ImageCPP color_image{
+					m_render_context.getDevice(),
+					vk::Extent3D{ extent.width, extent.height, 1 },
+					m_render_context.getFormat(),
+					vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eTransferSrc,
+					VMA_MEMORY_USAGE_GPU_ONLY
+				};
+				render_target = m_create_render_target_func(std::move(color_image));
+			}
+
+			return *render_target;
+		}
+
+		void DynamicResolution::upscale(core::CommandBuffer& command_buffer, const RenderTarget& source, const core::ImageViewCPP& destination) const {
+			const auto& source_view = source.getViews().size() > 1 ? source.getImageView() : source.getViews()[0];
+			const auto& source_extent = source.getExtent();
+			const auto& destination_extent = destination.getImage().getExtent();
+
+			vk::ImageBlit region{};
+			region.srcSubresource = source_view.getSubresourceLayers();
+			region.srcOffsets[1] = vk::Offset3D{ static_cast<int32_t>(source_extent.width), static_cast<int32_t>(source_extent.height), 1 };
+			region.dstSubresource = destination.getSubresourceLayers();
+			region.dstOffsets[1] = vk::Offset3D{ static_cast<int32_t>(destination_extent.width), static_cast<int32_t>(destination_extent.height), 1 };
+
+			command_buffer.blitImage(source_view.getImage(), destination.getImage(), { region }, m_filter);
+		}
+
+		void DynamicResolution::setFrameBudget(float frame_budget) {
+			m_frame_budget = frame_budget;
+		}
+
+		float DynamicResolution::getFrameBudget() const {
+			return m_frame_budget;
+		}
+
+		float DynamicResolution::getScale() const {
+			return m_scales[m_scale_index];
+		}
+
+		vk::Extent2D DynamicResolution::getScaledExtent() const {
+			const float scale = getScale();
+			const auto& surface_extent = m_render_context.getSurfaceExtent();
+			return {
+				std::max(1u, static_cast<uint32_t>(std::lround(surface_extent.width * scale))),
+				std::max(1u, static_cast<uint32_t>(std::lround(surface_extent.height * scale)))
+			};
+		}
+	}
+}
@@ -0,0 +1,83 @@
+/* Copyright (c) 2025, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "core/image_view.h"
+#include "rendering/render_target.h"
+
+namespace frame {
+	namespace core {
+		class CommandBuffer;
+	}
+
+	namespace rendering {
+		class RenderContext;
+
+		/*
+		 * Dynamic resolution scaling driven by the measured GPU frame time.
+		 * The scene is rendered into an offscreen target at one of a fixed set of scales of the surface extent and
+		 * blitted to the swapchain image with upscale(). update() steps the scale down when the smoothed frame time
+		 * exceeds the budget and up when the time predicted for the next scale, assuming cost proportional to the
+		 * pixel count, stays below HEADROOM of the budget. Measurements lag by the frames in flight, so every change
+		 * is followed by SETTLE_FRAMES frames without another one.
+		 * Targets are created on first use per frame and scale and kept, so a scale change does not recreate
+		 * resources or framebuffers; they are only dropped when the surface extent changes.
+		 */
+		class DynamicResolution {
+		public:
+			static constexpr float HEADROOM = 0.85f;
+			static constexpr uint32_t SETTLE_FRAMES = 8;
+
+			DynamicResolution(RenderContext& render_context, float frame_budget,
+				RenderTarget::CreateFunc create_render_target_func = RenderTarget::CREATE_FUNC,
+				const std::vector<float>& scales = { 0.5f, 0.625f, 0.75f, 0.875f, 1.0f });
+
+			// GPU time of a completed frame in seconds
+			void update(float frame_time);
+
+			// Offscreen target of the active frame at the current scale, attachment 1 is the color that gets upscaled
+			RenderTarget& getRenderTarget();
+
+			// The source color has to be in transfer source layout and the destination in transfer destination layout
+			void upscale(core::CommandBuffer& command_buffer, const RenderTarget& source, const core::ImageViewCPP& destination) const;
+
+			void setFrameBudget(float frame_budget);
+			float getFrameBudget() const;
+			float getScale() const;
+			vk::Extent2D getScaledExtent() const;
+
+		private:
+			RenderContext& m_render_context;
+			RenderTarget::CreateFunc m_create_render_target_func;
+			std::vector<float> m_scales;
+			size_t m_scale_index;
+			float m_frame_budget;
+			float m_smoothed_frame_time{ 0.0f };
+			uint32_t m_frames_since_change{ 0 };
+			vk::Filter m_filter{ vk::Filter::eLinear };
+
+			vk::Extent2D m_surface_extent{};
+			// Indexed by frame, then by scale
+			std::vector<std::vector<std::unique_ptr<RenderTarget>>> m_render_targets;
+		};
+	}
+}
@@ -18,6 +18,9 @@
 
 #include "rendering/subpass/forward_subpass.h"
 
+#include <algorithm>
+#include <cstring>
+
 #include "common/common.h"
 #include "rendering/subpass.h"
 #include "rendering/render_context.h"
@@ -51,6 +54,10 @@ namespace frame {
 
                 auto& device = getRenderContext().getDevice();
 
+                // Instances index the lists of their batch, the shader steps through them with the bound stride
+                vk::DeviceSize alignment = std::max<vk::DeviceSize>(device.getPhysicalDevice().getProperties().limits.minStorageBufferOffsetAlignment, 1);
+                m_object_light_stride = (sizeof(ObjectLightList) + alignment - 1) / alignment * alignment;
+
                 for (auto& mesh : m_meshes) {
 
                     for (auto& sub_mesh : mesh->getSubmeshes()) {
@@ -60,19 +67,206 @@ namespace frame {
                         variant.addDefinitions({ "MAX_LIGHT_COUNT " + std::to_string(MAX_FORWARD_LIGHT_COUNT) });
                         variant.addDefinitions(light_type_definitions);
 
+                        if (m_light_clusters) {
+                            m_light_clusters->addDefinitions(variant);
+                        }
+                        else if (m_object_light_count > 0) {
+                            variant.addDefinitions({ "OBJECT_LIGHT_LISTS", "MAX_OBJECT_LIGHT_COUNT " + std::to_string(MAX_OBJECT_LIGHT_COUNT),
+                                "OBJECT_LIGHT_LIST_STRIDE " + std::to_string(m_object_light_stride) });
+                        }
+
                         auto& vert_module = device.getResourceCache().requestShaderModule(vk::ShaderStageFlagBits::eVertex, getVertexShader(), variant);
                         auto& frag_module = device.getResourceCache().requestShaderModule(vk::ShaderStageFlagBits::eFragment, getFragmentShader(), variant);
                     }
                 }
+
+                GeometrySubpass::prepare();
+            }
+
+            void ForwardSubpass::prepareFrame(core::CommandBuffer& command_buffer) {
+                GeometrySubpass::prepareFrame(command_buffer);
+
+                if (m_light_clusters) {
+                    m_light_clusters->update(command_buffer, m_scene.getComponents<scene::Light>(), m_camera);
+                }
+                else if (m_object_light_count > 0) {
+                    updateObjectLightLists();
+                }
+            }
+
+            void ForwardSubpass::updateObjectLightLists() {
+                auto& render_frame = getRenderContext().getActiveFrame();
+
+                m_punctual_lights.clear();
+                for (auto& scene_light : m_scene.getComponents<scene::Light>()) {
+                    if (scene_light->getLightType() == scene::LightType::Point || scene_light->getLightType() == scene::LightType::Spot) {
+                        m_punctual_lights.push_back(makeLight(*scene_light));
+                    }
+                }
+
+                // An empty storage range cannot be bound, keep one unused entry
+                m_punctual_light_buffer = render_frame.allocateBuffer(vk::BufferUsageFlagBits::eStorageBuffer, std::max<size_t>(m_punctual_lights.size(), 1) * sizeof(Light), m_thread_index);
+                if (!m_punctual_lights.empty()) {
+                    m_punctual_light_buffer.getBuffer().update(m_punctual_lights, m_punctual_light_buffer.getOffset());
+                }
+
+                // Draws of one sub-mesh are contiguous, an instanced batch never spans more of them than the longest run
+                size_t max_batch_size = 1;
+                for (size_t i = 1, run = 1; i < m_render_queue.size(); i++) {
+                    run = m_render_queue[i].sub_mesh == m_render_queue[i - 1].sub_mesh ? run + 1 : 1;
+                    max_batch_size = std::max(max_batch_size, run);
+                }
+
+                // The bound range is the same for every draw so only the dynamic offset changes.
+                // One list per queued draw and an empty one for the camera-only slot, padded to keep the range in bounds
+                m_object_light_range = max_batch_size * m_object_light_stride;
+                m_object_light_data.assign((m_render_queue.size() + max_batch_size) * m_object_light_stride, 0);
+
+                scene::Node* list_node = nullptr;
+                ObjectLightList light_list{};
+
+                for (size_t i = 0; i < m_render_queue.size(); i++) {
+                    scene::Node* node = m_render_queue[i].node;
+
+                    if (node != list_node) {
+                        list_node = node;
+                        rankLights(*node, light_list);
+                    }
+
+                    std::memcpy(m_object_light_data.data() + i * m_object_light_stride, &light_list, sizeof(ObjectLightList));
+                }
+
+                m_object_light_lists = render_frame.allocateBuffer(vk::BufferUsageFlagBits::eStorageBuffer, m_object_light_data.size(), m_thread_index);
+                m_object_light_lists.update(m_object_light_data);
+
+                if (!m_gpu_scene || m_gpu_scene->getInstanceNodes().empty()) {
+                    return;
+                }
+
+                // GPU-driven draws bind the camera-only slot, their lists are indexed by instance id instead
+                auto& instance_nodes = m_gpu_scene->getInstanceNodes();
+                m_instance_light_data.assign(instance_nodes.size() * m_object_light_stride, 0);
+
+                list_node = nullptr;
+                for (size_t i = 0; i < instance_nodes.size(); i++) {
+                    if (instance_nodes[i] != list_node) {
+                        list_node = instance_nodes[i];
+                        rankLights(*list_node, light_list);
+                    }
+
+                    std::memcpy(m_instance_light_data.data() + i * m_object_light_stride, &light_list, sizeof(ObjectLightList));
+                }
+
+                m_instance_light_lists = render_frame.allocateBuffer(vk::BufferUsageFlagBits::eStorageBuffer, m_instance_light_data.size(), m_thread_index);
+                m_instance_light_lists.update(m_instance_light_data);
+            }
+
+            void ForwardSubpass::rankLights(const scene::Node& node, ObjectLightList& light_list) {
+                glm::mat4 world_matrix = node.getTransform().getWorldMatrix();
+                glm::vec3 center{ world_matrix[3] };
+                glm::vec3 extent{ 0.0f };
+
+                if (node.hasComponent<scene::Mesh>()) {
+                    const scene::AABB& bounds = node.getComponent<scene::Mesh>().getBounds();
+
+                    if (glm::all(glm::lessThanEqual(bounds.getMin(), bounds.getMax()))) {
+                        glm::mat3 rotation_scale{ world_matrix };
+                        glm::vec3 local_extent = bounds.getScale() * 0.5f;
+
+                        center = glm::vec3(world_matrix * glm::vec4(bounds.getCenter(), 1.0f));
+                        extent = glm::abs(rotation_scale[0]) * local_extent.x +
+                            glm::abs(rotation_scale[1]) * local_extent.y +
+                            glm::abs(rotation_scale[2]) * local_extent.z;
+                    }
+                }
+
+                m_ranked_lights.clear();
+                for (uint32_t light_index = 0; light_index < m_punctual_lights.size(); light_index++) {
+                    const Light& light = m_punctual_lights[light_index];
+
+                    glm::vec3 offset = glm::max(glm::abs(glm::vec3(light.position) - center) - extent, glm::vec3(0.0f));
+                    float distance_squared = glm::dot(offset, offset);
+                    float range = light.direction.w;
+
+                    // A light without a range reaches infinitely far
+                    if (range > 0.0f && distance_squared > range * range) {
+                        continue;
+                    }
+
+                    m_ranked_lights.push_back({ light.color.w / (1.0f + distance_squared), light_index });
+                }
+
+                size_t light_count = std::min<size_t>(m_ranked_lights.size(), m_object_light_count);
+                std::partial_sort(m_ranked_lights.begin(), m_ranked_lights.begin() + light_count, m_ranked_lights.end(),
+                    [](const RankedLight& lhs, const RankedLight& rhs) { return lhs.score > rhs.score; });
+
+                light_list.light_count = static_cast<uint32_t>(light_count);
+                for (size_t j = 0; j < light_count; j++) {
+                    light_list.light_indices[j] = m_ranked_lights[j].index;
+                }
             }
 
             void ForwardSubpass::draw(core::CommandBuffer& command_buffer) {
 
-                allocateLights<ForwardLights>(m_scene.getComponents<scene::Light>(), MAX_FORWARD_LIGHT_COUNT);
-                command_buffer.bindLighting(getLightingState(), 0, 4);
+                auto scene_lights = m_scene.getComponents<scene::Light>();
+                if (m_light_clusters || m_object_light_count > 0) {
+                    scene_lights = LightClusters::getDirectionalLights(scene_lights);
+                }
+
+                allocateLights<ForwardLights>(scene_lights, MAX_FORWARD_LIGHT_COUNT);
 
                 GeometrySubpass::draw(command_buffer);
             }
+
+            void ForwardSubpass::setClusteredLighting(core::ShaderSource&& cluster_shader) {
+                m_light_clusters = std::make_unique<LightClusters>(getRenderContext(), std::move(cluster_shader));
+            }
+
+            void ForwardSubpass::setObjectLightLists(uint32_t light_count) {
+                m_object_light_count = std::min<uint32_t>(light_count, MAX_OBJECT_LIGHT_COUNT);
+            }
+
+            void ForwardSubpass::bindObjectUniform(core::CommandBuffer& command_buffer, size_t object_index) {
+                GeometrySubpass::bindObjectUniform(command_buffer, object_index);
+
+                if (!m_light_clusters && m_object_light_count > 0) {
+                    command_buffer.bindBuffer(m_object_light_lists.getBuffer(), m_object_light_lists.getOffset() + object_index * m_object_light_stride,
+                        m_object_light_range, 0, 13, 0);
+                }
+            }
+
+            core::PipelineLayoutCPP& ForwardSubpass::preparePipelineLayout(const std::vector<core::ShaderModuleCPP*>& shader_modules) {
+                // Light lists move with every draw, like the object uniform
+                if (!m_light_clusters && m_object_light_count > 0) {
+                    for (auto& shader_module : shader_modules) {
+                        for (auto& resource : shader_module->getResources()) {
+                            if (resource.set == 0 && resource.binding == 13 && resource.type == core::ShaderResourceType::BufferStorage) {
+                                shader_module->setResourceMode(resource.name, core::ShaderResourceMode::Dynamic);
+                            }
+                        }
+                    }
+                }
+
+                return GeometrySubpass::preparePipelineLayout(shader_modules);
+            }
+
+            void ForwardSubpass::bindGpuSceneResources(core::CommandBuffer& command_buffer, core::PipelineLayoutCPP& pipeline_layout) {
+                if (!m_light_clusters && m_object_light_count > 0 && !m_instance_light_lists.isEmpty()) {
+                    bindStorageBuffer(command_buffer, pipeline_layout, "instance_light_lists", m_instance_light_lists.getBuffer(),
+                        m_instance_light_lists.getOffset(), m_instance_light_lists.getSize());
+                }
+            }
+
+            void ForwardSubpass::bindSubpassResources(core::CommandBuffer& command_buffer) {
+                command_buffer.bindLighting(getLightingState(), 0, 4);
+
+                if (m_light_clusters) {
+                    m_light_clusters->bind(command_buffer, 0, 10);
+                }
+                else if (m_object_light_count > 0) {
+                    command_buffer.bindBuffer(m_punctual_light_buffer.getBuffer(), m_punctual_light_buffer.getOffset(), m_punctual_light_buffer.getSize(), 0, 11, 0);
+                }
+            }
         }
     }
 }
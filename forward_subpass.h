@@ -19,10 +19,12 @@
 #pragma once
 
 #include "common/buffer_pool.h"
+#include "rendering/light_clusters.h"
 #include "rendering/subpass/geometry_subpass.h"
 #include "rendering/render_context.h"
 
 #define MAX_FORWARD_LIGHT_COUNT 8
+#define MAX_OBJECT_LIGHT_COUNT 8
 
 namespace frame {
     namespace scene {
@@ -41,6 +43,12 @@ namespace frame {
             Light spot_lights[MAX_FORWARD_LIGHT_COUNT];
         };
 
+        // Indices into the per-frame point and spot light buffer, most relevant light first
+        struct alignas(16) ObjectLightList {
+            uint32_t light_count;
+            uint32_t light_indices[MAX_OBJECT_LIGHT_COUNT];
+        };
+
         namespace subpass {
             class ForwardSubpass : public GeometrySubpass {
             public:
@@ -54,7 +62,49 @@ namespace frame {
 
                 virtual void prepare() override;
 
+                virtual void prepareFrame(core::CommandBuffer& command_buffer) override;
+
                 virtual void draw(core::CommandBuffer& command_buffer) override;
+
+                // Point and spot lights are read from a froxel grid instead of the fixed light arrays, has to be set before prepare()
+                void setClusteredLighting(core::ShaderSource&& cluster_shader);
+
+                // Every draw shades only the point and spot lights whose range reaches its bounds, at most light_count of them.
+                // 0 disables the lists. Has to be set before prepare(), clustered lighting takes precedence.
+                // GPU_DRIVEN shaders read the list of instance visible_instances[gl_InstanceIndex] from instance_light_lists
+                void setObjectLightLists(uint32_t light_count);
+
+                virtual void bindObjectUniform(core::CommandBuffer& command_buffer, size_t object_index) override;
+
+            protected:
+                virtual void bindSubpassResources(core::CommandBuffer& command_buffer) override;
+
+                virtual void bindGpuSceneResources(core::CommandBuffer& command_buffer, core::PipelineLayoutCPP& pipeline_layout) override;
+
+                virtual core::PipelineLayoutCPP& preparePipelineLayout(const std::vector<core::ShaderModuleCPP*>& shader_modules) override;
+
+                std::unique_ptr<LightClusters> m_light_clusters;
+
+            private:
+                struct RankedLight {
+                    float score;
+                    uint32_t index;
+                };
+
+                void updateObjectLightLists();
+
+                void rankLights(const scene::Node& node, ObjectLightList& light_list);
+
+                uint32_t m_object_light_count{ 0 };
+                std::vector<Light> m_punctual_lights;
+                std::vector<RankedLight> m_ranked_lights;
+                std::vector<uint8_t> m_object_light_data;
+                common::BufferAllocation m_punctual_light_buffer;
+                common::BufferAllocation m_object_light_lists;
+                std::vector<uint8_t> m_instance_light_data;
+                common::BufferAllocation m_instance_light_lists;
+                vk::DeviceSize m_object_light_stride{ 0 };
+                vk::DeviceSize m_object_light_range{ 0 };
             };
         }
     }
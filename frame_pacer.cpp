@@ -0,0 +1,125 @@
+/* Copyright (c) 2025, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "rendering/frame_pacer.h"
+
+#include <thread>
+
+#include "rendering/render_context.h"
+
+namespace frame {
+	namespace rendering {
+		namespace {
+			float smooth(float average, float sample) {
+				return average > 0.0f ? average + (sample - average) * 0.1f : sample;
+			}
+		}
+
+		FramePacer::FramePacer(RenderContext& render_context, bool use_present_wait) :
+			m_render_context{ render_context },
+			m_use_present_wait{ use_present_wait }
+		{
+		}
+
+		void FramePacer::wait() {
+			bool blocked = false;
+			bool completed = false;
+
+			while (m_pending_frames.size() > 1) {
+				auto& frame = m_pending_frames.front();
+				blocked = waitForFrame(frame);
+				m_latency = std::chrono::duration<float>(Clock::now() - frame.sample_time).count();
+				completed = true;
+				m_pending_frames.pop_front();
+			}
+
+			if (completed) {
+				m_render_context.addFrameCounter(stats::StatIndex::frame_latency, m_latency);
+			}
+
+			// The queued frame only just started on the GPU if the previous one was still running
+			float slack = m_gpu_frame_time - m_cpu_frame_time - SAFETY_MARGIN;
+			if (blocked && slack > 0.0f) {
+				sleepUntil(Clock::now() + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float>(slack)));
+			}
+
+			m_sample_time = Clock::now();
+		}
+
+		void FramePacer::frameSubmitted(vk::SwapchainKHR swapchain, uint64_t present_id) {
+			m_cpu_frame_time = smooth(m_cpu_frame_time, std::chrono::duration<float>(Clock::now() - m_sample_time).count());
+
+			uint64_t frame_value = m_render_context.getDevice().hasTimelineSemaphores() ? m_render_context.getFrameValue() : 0;
+			m_pending_frames.push_back({ m_sample_time, swapchain, present_id, frame_value, m_render_context.getActiveFrameIndex() });
+		}
+
+		void FramePacer::update(float gpu_frame_time) {
+			m_gpu_frame_time = smooth(m_gpu_frame_time, gpu_frame_time);
+		}
+
+		bool FramePacer::usesPresentWait() const {
+			return m_use_present_wait;
+		}
+
+		float FramePacer::getLatency() const {
+			return m_latency;
+		}
+
+		bool FramePacer::waitForFrame(const PendingFrame& frame) {
+			auto device = m_render_context.getDevice().getHandle();
+
+			// Ids of a replaced swapchain can no longer be waited on
+			if (frame.present_id > 0 && m_render_context.hasSwapchain() && frame.swapchain == m_render_context.getSwapchain().getHandle()) {
+				try {
+					if (device.waitForPresentKHR(frame.swapchain, frame.present_id, 0) != vk::Result::eTimeout) {
+						return false;
+					}
+					device.waitForPresentKHR(frame.swapchain, frame.present_id, PRESENT_WAIT_TIMEOUT);
+					return true;
+				}
+				catch (vk::SystemError&) {
+				}
+			}
+
+			if (frame.frame_value > 0) {
+				if (m_render_context.isFrameComplete(frame.frame_value)) {
+					return false;
+				}
+				m_render_context.waitForFrameValue(frame.frame_value);
+				return true;
+			}
+
+			auto& fence_pool = m_render_context.getRenderFrames()[frame.frame_index]->getFencePool();
+			if (fence_pool.wait(0) == vk::Result::eSuccess) {
+				return false;
+			}
+			fence_pool.wait();
+			return true;
+		}
+
+		void FramePacer::sleepUntil(Clock::time_point deadline) {
+			auto spin_time = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float>(SPIN_TIME));
+			if (deadline - Clock::now() > spin_time) {
+				std::this_thread::sleep_until(deadline - spin_time);
+			}
+
+			while (Clock::now() < deadline) {
+				std::this_thread::yield();
+			}
+		}
+	}
+}
@@ -0,0 +1,85 @@
+/* Copyright (c) 2025, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include <chrono>
+#include <deque>
+
+#include <vulkan/vulkan.hpp>
+
+namespace frame {
+	namespace rendering {
+		class RenderContext;
+
+		/*
+		 * Low-latency frame pacing. wait() blocks until all but the last submitted frame reached the display, through
+		 * present-wait when available and GPU completion otherwise. When it had to block it then sleeps for the predicted
+		 * GPU time of the last frame minus the measured CPU time of a frame, so input sampled right after wait() returns
+		 * is simulated, recorded and submitted just as the GPU runs dry. One frame stays queued instead of the whole ring.
+		 * The time from input sampling to presentation, or GPU completion without present-wait, is reported as
+		 * StatIndex::frame_latency.
+		 */
+		class FramePacer {
+		public:
+			// Head start before the predicted deadline that absorbs wake-up jitter
+			static constexpr float SAFETY_MARGIN = 0.001f;
+			// The sleep ends in a spin, OS sleeps overshoot by up to a scheduler tick
+			static constexpr float SPIN_TIME = 0.002f;
+			static constexpr uint64_t PRESENT_WAIT_TIMEOUT = 100000000;
+
+			FramePacer(RenderContext& render_context, bool use_present_wait);
+
+			void wait();
+
+			// Called by the RenderContext once the active frame was submitted, present_id is 0 when it was not presented with one
+			void frameSubmitted(vk::SwapchainKHR swapchain, uint64_t present_id);
+
+			// GPU time of a completed frame in seconds
+			void update(float gpu_frame_time);
+
+			bool usesPresentWait() const;
+
+			// Input to photon time of the last completed frame in seconds
+			float getLatency() const;
+
+		private:
+			using Clock = std::chrono::steady_clock;
+
+			struct PendingFrame {
+				Clock::time_point sample_time;
+				vk::SwapchainKHR swapchain;
+				uint64_t present_id;
+				uint64_t frame_value;
+				uint32_t frame_index;
+			};
+
+			// Returns whether the frame was still in flight
+			bool waitForFrame(const PendingFrame& frame);
+			static void sleepUntil(Clock::time_point deadline);
+
+			RenderContext& m_render_context;
+			bool m_use_present_wait;
+			std::deque<PendingFrame> m_pending_frames;
+			Clock::time_point m_sample_time{ Clock::now() };
+			float m_gpu_frame_time{ 0.0f };
+			float m_cpu_frame_time{ 0.0f };
+			float m_latency{ 0.0f };
+		};
+	}
+}
@@ -16,8 +16,14 @@
  */
 
 #include "scene/frustum.h"
+#include <cassert>
 #include <cmath>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#include <emmintrin.h>
+	#define FRUSTUM_USE_SSE 1
+#endif
+
 namespace frame {
 	namespace scene {
 		void Frustum::update(const glm::mat4& matrix) {
@@ -66,6 +72,63 @@ namespace frame {
 			return true;
 		}
 
+		bool Frustum::checkBox(const glm::vec3& center, const glm::vec3& extent) const {
+			for (size_t i = 0; i < m_planes.size(); i++) {
+				const glm::vec3 normal{ m_planes[i] };
+				if (glm::dot(normal, center) + glm::dot(glm::abs(normal), extent) + m_planes[i].w < 0.0f) {
+					return false;
+				}
+			}
+			return true;
+		}
+
+		void Frustum::checkBoxes(const std::vector<glm::vec3>& centers, const std::vector<glm::vec3>& extents, std::vector<uint8_t>& visibility) const {
+			assert(centers.size() == extents.size());
+
+			const size_t count = centers.size();
+			visibility.resize(count);
+
+			size_t i = 0;
+
+#if defined(FRUSTUM_USE_SSE)
+			const __m128 sign_mask = _mm_set1_ps(-0.0f);
+
+			for (; i + 4 <= count; i += 4) {
+				const __m128 cx = _mm_set_ps(centers[i + 3].x, centers[i + 2].x, centers[i + 1].x, centers[i].x);
+				const __m128 cy = _mm_set_ps(centers[i + 3].y, centers[i + 2].y, centers[i + 1].y, centers[i].y);
+				const __m128 cz = _mm_set_ps(centers[i + 3].z, centers[i + 2].z, centers[i + 1].z, centers[i].z);
+				const __m128 ex = _mm_set_ps(extents[i + 3].x, extents[i + 2].x, extents[i + 1].x, extents[i].x);
+				const __m128 ey = _mm_set_ps(extents[i + 3].y, extents[i + 2].y, extents[i + 1].y, extents[i].y);
+				const __m128 ez = _mm_set_ps(extents[i + 3].z, extents[i + 2].z, extents[i + 1].z, extents[i].z);
+
+				__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+
+				for (const auto& plane : m_planes) {
+					const __m128 px = _mm_set1_ps(plane.x);
+					const __m128 py = _mm_set1_ps(plane.y);
+					const __m128 pz = _mm_set1_ps(plane.z);
+
+					__m128 distance = _mm_add_ps(_mm_mul_ps(px, cx), _mm_add_ps(_mm_mul_ps(py, cy), _mm_mul_ps(pz, cz)));
+					__m128 radius = _mm_add_ps(_mm_mul_ps(_mm_andnot_ps(sign_mask, px), ex),
+						_mm_add_ps(_mm_mul_ps(_mm_andnot_ps(sign_mask, py), ey), _mm_mul_ps(_mm_andnot_ps(sign_mask, pz), ez)));
+
+					distance = _mm_add_ps(_mm_add_ps(distance, radius), _mm_set1_ps(plane.w));
+					inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, _mm_setzero_ps()));
+				}
+
+				const int mask = _mm_movemask_ps(inside);
+				visibility[i + 0] = static_cast<uint8_t>((mask >> 0) & 1);
+				visibility[i + 1] = static_cast<uint8_t>((mask >> 1) & 1);
+				visibility[i + 2] = static_cast<uint8_t>((mask >> 2) & 1);
+				visibility[i + 3] = static_cast<uint8_t>((mask >> 3) & 1);
+			}
+#endif
+
+			for (; i < count; i++) {
+				visibility[i] = checkBox(centers[i], extents[i]) ? 1 : 0;
+			}
+		}
+
 		const std::array<glm::vec4, 6>& Frustum::getPlanes() const {
 			return m_planes;
 		}
@@ -18,6 +18,8 @@
 #pragma once
 
 #include <array>
+#include <cstdint>
+#include <vector>
 
 #include "global_common.h"
 
@@ -38,6 +40,10 @@ namespace frame {
 			
 			bool checkSphere(glm::vec3 pos, float radius);
 
+			bool checkBox(const glm::vec3& center, const glm::vec3& extent) const;
+
+			void checkBoxes(const std::vector<glm::vec3>& centers, const std::vector<glm::vec3>& extents, std::vector<uint8_t>& visibility) const;
+
 			const std::array<glm::vec4, 6>& getPlanes() const;
 
 		private:
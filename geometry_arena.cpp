@@ -0,0 +1,149 @@
+/* Copyright (c) 2025, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "scene/components/mesh/geometry_arena.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include <fmt/format.h>
+
+#include "common/buffer_uploader.h"
+#include "scene/components/mesh/sub_mesh.h"
+
+namespace frame {
+    namespace scene {
+        GeometryArena::GeometryArena(const std::string& name) :
+            Component{ name }
+        {}
+
+        std::type_index GeometryArena::getType() {
+            return typeid(GeometryArena);
+        }
+
+        void GeometryArena::addVertices(SubMesh& sub_mesh, std::vector<VertexStream>& streams, std::uint32_t vertex_count) {
+            std::sort(streams.begin(), streams.end(), [](const VertexStream& lhs, const VertexStream& rhs) { return lhs.name < rhs.name; });
+
+            std::string signature;
+            std::uint32_t stride = 0;
+            std::vector<std::uint32_t> offsets;
+
+            for (auto& stream : streams) {
+                signature += stream.name + ":" + std::to_string(static_cast<uint32_t>(stream.format)) + ";";
+                offsets.push_back(stride);
+
+                // Keep every attribute 4-byte aligned inside the interleaved vertex
+                stride += (stream.element_size + 3) & ~3u;
+            }
+
+            auto layout_it = std::find_if(m_vertex_layouts.begin(), m_vertex_layouts.end(),
+                [&signature](const VertexLayout& layout) { return layout.signature == signature; });
+
+            if (layout_it == m_vertex_layouts.end()) {
+                m_vertex_layouts.push_back({ signature, stride });
+                layout_it = std::prev(m_vertex_layouts.end());
+            }
+
+            auto& layout = *layout_it;
+            size_t base_vertex = layout.data.size() / layout.stride;
+            layout.data.resize(layout.data.size() + static_cast<size_t>(vertex_count) * layout.stride);
+
+            for (size_t i = 0; i < streams.size(); i++) {
+                auto& stream = streams[i];
+                uint8_t* dst = layout.data.data() + base_vertex * layout.stride + offsets[i];
+
+                for (std::uint32_t v = 0; v < vertex_count; v++) {
+                    size_t src_offset = static_cast<size_t>(v) * stream.stride;
+                    if (src_offset + stream.element_size > stream.data.size()) {
+                        break;
+                    }
+
+                    std::memcpy(dst + static_cast<size_t>(v) * layout.stride, stream.data.data() + src_offset, stream.element_size);
+                }
+
+                VertexAttribute attribute;
+                attribute.format = stream.format;
+                attribute.stride = layout.stride;
+                attribute.offset = offsets[i];
+
+                sub_mesh.setAttribute(stream.name, attribute);
+            }
+
+            sub_mesh.m_vertex_offset = static_cast<std::int32_t>(base_vertex);
+            m_vertex_users.emplace_back(&sub_mesh, static_cast<size_t>(std::distance(m_vertex_layouts.begin(), layout_it)));
+        }
+
+        void GeometryArena::addIndices(SubMesh& sub_mesh, const std::vector<uint8_t>& index_data, vk::IndexType index_type) {
+            auto& index_stream = getIndexStream(index_type);
+            size_t index_size = index_type == vk::IndexType::eUint32 ? sizeof(uint32_t) : sizeof(uint16_t);
+
+            sub_mesh.m_first_index = static_cast<std::uint32_t>(index_stream.data.size() / index_size);
+            sub_mesh.m_index_type = index_type;
+            sub_mesh.m_index_offset = 0;
+
+            index_stream.data.insert(index_stream.data.end(), index_data.begin(), index_data.end());
+            m_index_users.emplace_back(&sub_mesh, index_type);
+        }
+
+        void GeometryArena::upload(common::BufferUploader& uploader, vk::BufferUsageFlags additional_buffer_usage_flags) {
+            for (size_t i = 0; i < m_vertex_layouts.size(); i++) {
+                auto& layout = m_vertex_layouts[i];
+                if (layout.data.empty()) {
+                    continue;
+                }
+
+                layout.buffer = std::make_unique<common::Buffer>(
+                    uploader.upload(layout.data, vk::BufferUsageFlagBits::eVertexBuffer | additional_buffer_usage_flags));
+                layout.buffer->setDebugName(fmt::format("geometry arena: vertex layout #{} ({} bytes/vertex)", i, layout.stride));
+
+                layout.data.clear();
+                layout.data.shrink_to_fit();
+            }
+
+            for (auto index_type : { vk::IndexType::eUint16, vk::IndexType::eUint32 }) {
+                auto& index_stream = getIndexStream(index_type);
+                if (index_stream.data.empty()) {
+                    continue;
+                }
+
+                index_stream.buffer = std::make_unique<common::Buffer>(
+                    uploader.upload(index_stream.data, vk::BufferUsageFlagBits::eIndexBuffer | additional_buffer_usage_flags));
+                index_stream.buffer->setDebugName(fmt::format("geometry arena: {} index buffer", vk::to_string(index_type)));
+
+                index_stream.data.clear();
+                index_stream.data.shrink_to_fit();
+            }
+
+            for (auto& [sub_mesh, layout_index] : m_vertex_users) {
+                sub_mesh->m_vertex_arena = m_vertex_layouts[layout_index].buffer.get();
+            }
+
+            for (auto& [sub_mesh, index_type] : m_index_users) {
+                sub_mesh->m_index_arena = getIndexStream(index_type).buffer.get();
+            }
+        }
+
+        size_t GeometryArena::getVertexLayoutCount() const {
+            return m_vertex_layouts.size();
+        }
+
+        GeometryArena::IndexStream& GeometryArena::getIndexStream(vk::IndexType index_type) {
+            return index_type == vk::IndexType::eUint32 ? m_index_stream_u32 : m_index_stream_u16;
+        }
+    }
+}
@@ -0,0 +1,85 @@
+/* Copyright (c) 2025, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <typeinfo>
+#include <vector>
+
+#include <vulkan/vulkan.hpp>
+#include "common/buffer.h"
+#include "scene/component.h"
+
+namespace frame {
+    namespace common {
+        class BufferUploader;
+    }
+
+    namespace scene {
+        class SubMesh;
+
+        // Packs the geometry of many submeshes into a few shared buffers.
+        // Submeshes with the same attribute set share one interleaved vertex buffer and
+        // are drawn with their own vertex offset and first index.
+        class GeometryArena : public Component {
+        public:
+            struct VertexStream {
+                std::string name;
+                vk::Format format = vk::Format::eUndefined;
+                std::uint32_t element_size = 0;
+                std::uint32_t stride = 0;
+                std::vector<uint8_t> data;
+            };
+
+            GeometryArena(const std::string& name = "geometry_arena");
+            virtual ~GeometryArena() = default;
+
+            virtual std::type_index getType() override;
+
+            void addVertices(SubMesh& sub_mesh, std::vector<VertexStream>& streams, std::uint32_t vertex_count);
+            void addIndices(SubMesh& sub_mesh, const std::vector<uint8_t>& index_data, vk::IndexType index_type);
+
+            void upload(common::BufferUploader& uploader, vk::BufferUsageFlags additional_buffer_usage_flags = {});
+
+            size_t getVertexLayoutCount() const;
+
+        private:
+            struct VertexLayout {
+                std::string signature;
+                std::uint32_t stride = 0;
+                std::vector<uint8_t> data;
+                std::unique_ptr<common::Buffer> buffer;
+            };
+
+            struct IndexStream {
+                std::vector<uint8_t> data;
+                std::unique_ptr<common::Buffer> buffer;
+            };
+
+            IndexStream& getIndexStream(vk::IndexType index_type);
+
+            std::vector<VertexLayout> m_vertex_layouts;
+            IndexStream m_index_stream_u16;
+            IndexStream m_index_stream_u32;
+            std::vector<std::pair<SubMesh*, size_t>> m_vertex_users;
+            std::vector<std::pair<SubMesh*, vk::IndexType>> m_index_users;
+        };
+    }
+}
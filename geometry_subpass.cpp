@@ -16,6 +16,14 @@
  */
 
 #include "rendering/subpass/geometry_subpass.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <future>
+#include <limits>
+
 #include "common/common.h"
 #include "rendering/render_context.h"
 #include "scene/components/camera/camera.h"
@@ -30,76 +38,440 @@
 namespace frame {
 	namespace rendering {
 		namespace subpass {
+			namespace {
+				vk::FrontFace getFrontFace(scene::Node& node) {
+					const auto& scale = node.getTransform().getScale();
+					bool flipped = scale.x * scale.y * scale.z < 0;
+					return flipped ? vk::FrontFace::eClockwise : vk::FrontFace::eCounterClockwise;
+				}
+
+				bool isInstanceInput(const std::string& name) {
+					return name == "instance_model" || name == "instance_normal_matrix" || name == "instance_batch_index";
+				}
+
+				void setObjectUniformDynamic(core::ShaderModuleCPP& shader_module) {
+					auto& resources = shader_module.getResources();
+					auto it = std::find_if(resources.begin(), resources.end(), [](const core::ShaderResource& resource) { return resource.name == "GlobalUniform"; });
+
+					if (it != resources.end() && it->mode != core::ShaderResourceMode::Dynamic) {
+						shader_module.setResourceMode("GlobalUniform", core::ShaderResourceMode::Dynamic);
+					}
+				}
+			}
+
 			GeometrySubpass::GeometrySubpass(RenderContext& render_context, core::ShaderSource&& vertex_source, core::ShaderSource&& fragment_source, scene::Scene& scene_, scene::Camera& camera) :
 				Subpass{ render_context, std::move(vertex_source), std::move(fragment_source) },
 				m_meshes{ scene_.getComponents<scene::Mesh>() },
 				m_camera{ camera },
 				m_scene{ scene_ }
 			{
+				// Start from the layout of the frames' targets so the first frame does not prepare again
+				auto& frames = render_context.getRenderFrames();
+				if (!frames.empty() && frames.front()->getRenderTarget().isCompactGBuffer()) {
+					setGBufferLayout(true);
+				}
 			}
 
 			void GeometrySubpass::prepare() {
-				auto& device = getRenderContext().getDevice();
+				// Opaque draws are EQUAL tested against the pre-pass depth, both have to compute it bit-identically
+				if (m_depth_prepass) {
+					for (auto& mesh : m_meshes) {
+						for (auto& sub_mesh : mesh->getSubmeshes()) {
+							sub_mesh->getMutShaderVariant().addDefine("INVARIANT_POSITION");
+						}
+					}
+				}
+
+				if (m_order_independent_transparency) {
+					for (auto& mesh : m_meshes) {
+						for (auto& sub_mesh : mesh->getSubmeshes()) {
+							if (sub_mesh->getMaterial()->m_alpha_mode == scene::AlphaMode::Blend) {
+								sub_mesh->getMutShaderVariant().addDefine("OIT_ACCUMULATION");
+							}
+						}
+					}
+				}
+
+				updateDrawStates();
+
+				if (m_gpu_scene) {
+					m_gpu_scene->setOcclusionCulling(m_depth_pyramid != nullptr);
+					m_gpu_scene->prepare();
+				}
+
+				preparePipelineLayouts();
+
+				if (m_depth_pyramid) {
+					// Meshes outside the GPU scene are tested on the CPU against a read back pyramid level
+					bool cpu_tested = false;
+					for (size_t mesh_index = 0; mesh_index < m_meshes.size(); mesh_index++) {
+						cpu_tested = cpu_tested || !m_gpu_scene || !m_gpu_scene->hasMesh(mesh_index);
+					}
+
+					m_depth_pyramid->setReadback(cpu_tested);
+				}
+			}
+
+			void GeometrySubpass::updateDrawStates() {
+				std::unordered_map<size_t, uint32_t> variant_ids;
+				std::unordered_map<const scene::Material*, uint32_t> material_ids;
+				std::unordered_map<uint32_t, uint32_t> batch_counts;
+				uint32_t material_count = 0;
+
+				m_state_ids.clear();
+				m_state_ids.reserve(m_meshes.size());
+				m_batch_ids.clear();
+				m_batch_ids.reserve(m_meshes.size());
+				m_instanced_variants.clear();
+
+				for (auto& mesh : m_meshes) {
+					auto& mesh_state_ids = m_state_ids.emplace_back();
+					auto& mesh_batch_ids = m_batch_ids.emplace_back();
+
+					for (auto& sub_mesh : mesh->getSubmeshes()) {
+						uint32_t variant_id = variant_ids.emplace(sub_mesh->getShaderVariant().getId(), static_cast<uint32_t>(variant_ids.size())).first->second;
+						auto material_it = material_ids.emplace(sub_mesh->getMaterial(), material_count).first;
+						if (material_it->second == material_count) {
+							material_count++;
+						}
+
+						// Batch ids are only unique within a state, a state that runs out of them continues as a new state run
+						uint32_t state_id = RenderQueue::makeStateId(variant_id, material_it->second);
+						if (batch_counts[state_id] > RenderQueue::MAX_BATCH_ID) {
+							material_it->second = material_count++;
+							state_id = RenderQueue::makeStateId(variant_id, material_it->second);
+						}
+
+						mesh_state_ids.push_back(state_id);
+						mesh_batch_ids.push_back(batch_counts[state_id]++);
+
+						core::ShaderVariant instanced_variant = sub_mesh->getShaderVariant();
+						instanced_variant.addDefine("INSTANCING");
+						m_instanced_variants.emplace(sub_mesh, std::move(instanced_variant));
+					}
+				}
+			}
+
+			void GeometrySubpass::preparePipelineLayouts() {
+				auto& resource_cache = getRenderContext().getDevice().getResourceCache();
+
+				m_pipeline_layouts.clear();
+
+				auto add_variant = [this, &resource_cache](const core::ShaderVariant& shader_variant) {
+					if (m_pipeline_layouts.find(shader_variant.getId()) != m_pipeline_layouts.end()) {
+						return;
+					}
+
+					std::vector<core::ShaderModuleCPP*> shader_modules{
+						&resource_cache.requestShaderModule(vk::ShaderStageFlagBits::eVertex, getVertexShader(), shader_variant),
+						&resource_cache.requestShaderModule(vk::ShaderStageFlagBits::eFragment, getFragmentShader(), shader_variant) };
+
+					m_pipeline_layouts.emplace(shader_variant.getId(), &preparePipelineLayout(shader_modules));
+				};
+
+				if (m_gpu_scene) {
+					for (auto& draw : m_gpu_scene->getDraws()) {
+						add_variant(draw.shader_variant);
+					}
+				}
+
 				for (auto& mesh : m_meshes) {
 					for (auto& sub_mesh : mesh->getSubmeshes()) {
-						auto& variant = sub_mesh->getShaderVariant();
-						auto& vert_module = device.getResourceCache().requestShaderModule(vk::ShaderStageFlagBits::eVertex, getVertexShader(), variant);
-						auto& frag_module = device.getResourceCache().requestShaderModule(vk::ShaderStageFlagBits::eFragment, getFragmentShader(), variant);
+						add_variant(sub_mesh->getShaderVariant());
+
+						if (m_instancing && mesh->getNodes().size() > 1) {
+							add_variant(m_instanced_variants.at(sub_mesh));
+						}
 					}
 				}
 			}
 
-			void GeometrySubpass::getSortedNodes(
-				std::multimap<float, std::pair<scene::Node*, scene::SubMesh*>>& opaque_nodes,
-				std::multimap<float, std::pair<scene::Node*, scene::SubMesh*>>& transparent_nodes)
-			{
+			core::PipelineLayoutCPP& GeometrySubpass::getPipelineLayout(const core::ShaderVariant& shader_variant) const {
+				auto it = m_pipeline_layouts.find(shader_variant.getId());
+				assert(it != m_pipeline_layouts.end() && "[GeometrySubpass] ASSERT: Shader variant was not prepared");
+				return *it->second;
+			}
+
+			void GeometrySubpass::getSortedNodes(RenderQueue& render_queue) {
+				if (m_state_ids.size() != m_meshes.size()) {
+					updateDrawStates();
+					preparePipelineLayouts();
+				}
+
 				auto camera_transform = m_camera.getNode()->getTransform().getWorldMatrix();
+				glm::vec3 camera_position = glm::vec3(camera_transform[3]);
+
+				glm::mat4 projection = vulkanStyleProjection(m_camera.getProjection());
+				m_view_proj = m_camera.getPreRotation() * projection * m_camera.getView();
+				m_frustum.update(m_view_proj);
+
+				// LODs are chosen from the bounding sphere diameter relative to the viewport height
+				float projection_scale = std::abs(projection[1][1]);
+				bool perspective = projection[3][3] == 0.0f;
+
+				m_visible_nodes.clear();
+				m_cull_candidates.clear();
+				m_cull_centers.clear();
+				m_cull_extents.clear();
+
+				for (size_t mesh_index = 0; mesh_index < m_meshes.size(); mesh_index++) {
+					if (m_gpu_scene && m_gpu_scene->hasMesh(mesh_index)) {
+						continue;
+					}
+
+					auto& mesh = m_meshes[mesh_index];
+					const scene::AABB& mesh_bounds = mesh->getBounds();
+					bool has_bounds = glm::all(glm::lessThanEqual(mesh_bounds.getMin(), mesh_bounds.getMax()));
+
+					glm::vec3 local_center = mesh_bounds.getCenter();
+					glm::vec3 local_extent = mesh_bounds.getScale() * 0.5f;
 
-				for (auto& mesh : m_meshes) {
 					for (auto& node : mesh->getNodes()) {
 
 						auto node_transform = node->getTransform().getWorldMatrix();
 
-						const scene::AABB& mesh_bounds = mesh->getBounds();
+						if (!has_bounds) {
+							float distance = glm::length(camera_position - glm::vec3(node_transform[3]));
+							m_visible_nodes.push_back({ node, mesh_index, distance, std::numeric_limits<float>::max() });
+							continue;
+						}
 
-						scene::AABB world_bounds{ mesh_bounds.getMin(), mesh_bounds.getMax() };
-						world_bounds.transform(node_transform);
+						glm::mat3 rotation_scale{ node_transform };
 
-						float distance = glm::length(glm::vec3(camera_transform[3]) - world_bounds.getCenter());
+						m_cull_candidates.emplace_back(node, mesh_index);
+						m_cull_centers.push_back(glm::vec3(node_transform * glm::vec4(local_center, 1.0f)));
+						m_cull_extents.push_back(glm::abs(rotation_scale[0]) * local_extent.x +
+							glm::abs(rotation_scale[1]) * local_extent.y +
+							glm::abs(rotation_scale[2]) * local_extent.z);
+					}
+				}
 
-						for (auto& sub_mesh : mesh->getSubmeshes())
-						{
-							if (sub_mesh->getMaterial()->m_alpha_mode == scene::AlphaMode::Blend) {
-								transparent_nodes.emplace(distance, std::make_pair(node, sub_mesh));
-							}
-							else {
-								opaque_nodes.emplace(distance, std::make_pair(node, sub_mesh));
-							}
+				if (m_frustum_culling) {
+					m_frustum.checkBoxes(m_cull_centers, m_cull_extents, m_cull_visibility);
+				}
+				else {
+					m_cull_visibility.assign(m_cull_candidates.size(), 1);
+				}
+
+				size_t culled_draws = 0;
+				size_t occluded_draws = 0;
+
+				for (size_t i = 0; i < m_cull_candidates.size(); i++) {
+					auto& [node, mesh_index] = m_cull_candidates[i];
+
+					if (!m_cull_visibility[i]) {
+						culled_draws += m_meshes[mesh_index]->getSubmeshes().size();
+						continue;
+					}
+
+					if (m_depth_pyramid && m_depth_pyramid->isOccluded(m_cull_centers[i], m_cull_extents[i])) {
+						occluded_draws += m_meshes[mesh_index]->getSubmeshes().size();
+						continue;
+					}
+
+					float distance = glm::length(camera_position - m_cull_centers[i]);
+					float radius = glm::length(m_cull_extents[i]);
+					float screen_size = perspective ?
+						(distance > radius ? radius * projection_scale / distance : std::numeric_limits<float>::max()) :
+						radius * projection_scale;
+
+					m_visible_nodes.push_back({ node, mesh_index, distance, screen_size });
+				}
+
+				float max_distance = 0.0f;
+				for (auto& visible_node : m_visible_nodes) {
+					max_distance = std::max(max_distance, visible_node.distance);
+				}
+
+				render_queue.clear();
+
+				size_t base_triangles = 0;
+				size_t lod_triangles = 0;
+
+				for (auto& visible_node : m_visible_nodes) {
+					auto& sub_meshes = m_meshes[visible_node.mesh_index]->getSubmeshes();
+					auto& state_ids = m_state_ids[visible_node.mesh_index];
+					auto& batch_ids = m_batch_ids[visible_node.mesh_index];
+					uint32_t depth = RenderQueue::quantizeDepth(visible_node.distance, max_distance);
+					bool instanced = m_instancing && m_meshes[visible_node.mesh_index]->getNodes().size() > 1;
+
+					for (size_t i = 0; i < sub_meshes.size(); i++) {
+						RenderLayer layer = sub_meshes[i]->getMaterial()->m_alpha_mode == scene::AlphaMode::Blend ? RenderLayer::Transparent : RenderLayer::Opaque;
+						bool batched = layer == RenderLayer::Opaque ? instanced : m_order_independent_transparency;
+						uint64_t key = batched ?
+							RenderQueue::makeInstancedKey(state_ids[i], batch_ids[i], depth, layer) :
+							RenderQueue::makeKey(layer, state_ids[i], depth);
+						uint32_t lod = selectLod(*sub_meshes[i], visible_node.screen_size);
+						render_queue.push(key, *visible_node.node, *sub_meshes[i], depth, lod);
+
+						uint32_t base_count = sub_meshes[i]->m_vertex_indices != 0 ? sub_meshes[i]->m_vertex_indices : sub_meshes[i]->m_vertices_count;
+						base_triangles += base_count / 3;
+						lod_triangles += (sub_meshes[i]->m_vertex_indices != 0 ? sub_meshes[i]->getLod(lod).index_count : base_count) / 3;
+					}
+				}
+
+				render_queue.sort();
+
+				getRenderContext().addFrameCounter(stats::StatIndex::scene_visible_draws, static_cast<double>(render_queue.size()));
+				getRenderContext().addFrameCounter(stats::StatIndex::scene_culled_draws, static_cast<double>(culled_draws));
+				getRenderContext().addFrameCounter(stats::StatIndex::scene_occluded_draws, static_cast<double>(occluded_draws));
+				getRenderContext().addFrameCounter(stats::StatIndex::scene_base_triangles, static_cast<double>(base_triangles));
+				getRenderContext().addFrameCounter(stats::StatIndex::scene_lod_triangles, static_cast<double>(lod_triangles));
+			}
+
+			uint32_t GeometrySubpass::selectLod(const scene::SubMesh& sub_mesh, float screen_size) const {
+				uint32_t lod = 0;
+				while (lod < m_lod_thresholds.size() && screen_size < m_lod_thresholds[lod]) {
+					lod++;
+				}
+
+				return std::min(lod, sub_mesh.getLodCount() - 1);
+			}
+
+			void GeometrySubpass::prepareRenderTarget(const RenderTarget& render_target) {
+				if (render_target.isCompactGBuffer() == m_compact_gbuffer) {
+					return;
+				}
+
+				// Earlier frames may still read the GPU scene buffers prepare() replaces
+				getRenderContext().getDevice().getHandle().waitIdle();
+
+				setGBufferLayout(render_target.isCompactGBuffer());
+				prepare();
+			}
+
+			void GeometrySubpass::setGBufferLayout(bool compact) {
+				for (auto& mesh : m_meshes) {
+					for (auto& sub_mesh : mesh->getSubmeshes()) {
+						if (compact) {
+							sub_mesh->getMutShaderVariant().addDefine("COMPACT_GBUFFER");
+						}
+						else {
+							sub_mesh->getMutShaderVariant().addUndefine("COMPACT_GBUFFER");
 						}
 					}
 				}
+
+				m_compact_gbuffer = compact;
+			}
+
+			void GeometrySubpass::prepareFrame(core::CommandBuffer& command_buffer) {
+				// The draw list is built before the render pass so earlier subpasses, like a depth pre-pass, can reuse it
+				getSortedNodes(m_render_queue);
+
+				updateObjectUniforms();
+
+				if (m_gpu_scene) {
+					m_gpu_scene->cull(command_buffer, m_frustum, m_frustum_culling);
+				}
+			}
+
+			void GeometrySubpass::finishFrame(core::CommandBuffer& command_buffer, RenderTarget& render_target) {
+				// With late draws the pyramid has been built between the rendering scopes
+				if (!m_depth_pyramid || hasLateDraws()) {
+					return;
+				}
+
+				core::ScopedDebugLabel occlusion_debug_label{ command_buffer, "Occlusion culling" };
+
+				m_depth_pyramid->build(command_buffer, render_target, m_view_proj);
+
+				// Without a late scope the instances phase 2 finds visible are drawn by the next frame's phase 1
+				if (m_gpu_scene && !m_gpu_scene->getDraws().empty()) {
+					m_gpu_scene->testOcclusion(command_buffer, m_frustum, m_view_proj, *m_depth_pyramid);
+				}
+			}
+
+			bool GeometrySubpass::hasLateDraws() const {
+				return isLateDrawsSupported() && m_gpu_scene && m_depth_pyramid && !m_gpu_scene->getDraws().empty();
+			}
+
+			void GeometrySubpass::prepareLateDraws(core::CommandBuffer& command_buffer, RenderTarget& render_target) {
+				core::ScopedDebugLabel occlusion_debug_label{ command_buffer, "Occlusion culling" };
+
+				m_depth_pyramid->build(command_buffer, render_target, m_view_proj);
+				m_gpu_scene->testOcclusion(command_buffer, m_frustum, m_view_proj, *m_depth_pyramid);
+
+				// The late draws test against and extend the depth the pyramid was reduced from
+				common::ImageMemoryBarrier depth_barrier{};
+				depth_barrier.m_old_layout = render_target.getLayout(0);
+				depth_barrier.m_new_layout = vk::ImageLayout::eDepthStencilAttachmentOptimal;
+				depth_barrier.m_dst_access_mask = vk::AccessFlagBits::eDepthStencilAttachmentRead | vk::AccessFlagBits::eDepthStencilAttachmentWrite;
+				depth_barrier.m_src_stage_mask = vk::PipelineStageFlagBits::eComputeShader;
+				depth_barrier.m_dst_stage_mask = vk::PipelineStageFlagBits::eEarlyFragmentTests | vk::PipelineStageFlagBits::eLateFragmentTests;
+				command_buffer.imageMemoryBarrier(render_target.getDepthView(), depth_barrier);
+				render_target.setLayout(0, depth_barrier.m_new_layout);
+			}
+
+			void GeometrySubpass::drawLate(core::CommandBuffer& command_buffer) {
+				bindSubpassResources(command_buffer);
+
+				drawGpuScene(command_buffer, true);
+
+				// Transparent draws blend over the late opaque surfaces, so they are held back from draw() until here
+				size_t transparent_begin = m_render_queue.getLayerBegin(RenderLayer::Transparent);
+				recordDraws(command_buffer, transparent_begin, m_render_queue.size(), transparent_begin, m_thread_index);
 			}
 
 			void GeometrySubpass::draw(core::CommandBuffer& command_buffer) {
+				size_t transparent_begin = m_render_queue.getLayerBegin(RenderLayer::Transparent);
+				size_t draw_end = hasLateDraws() ? transparent_begin : m_render_queue.size();
 
-				std::multimap<float, std::pair<scene::Node*, scene::SubMesh*>> opaque_nodes;
-				std::multimap<float, std::pair<scene::Node*, scene::SubMesh*>> transparent_nodes;
+				size_t thread_count = std::max(getRenderContext().getActiveFrame().getThreadCount(), static_cast<size_t>(m_thread_index) + 1);
+				if (m_instance_data.size() < thread_count) {
+					m_instance_data.resize(thread_count);
+				}
 
-				getSortedNodes(opaque_nodes, transparent_nodes);
+				if (getSubpassContents() == vk::SubpassContents::eSecondaryCommandBuffers) {
+					recordParallel(command_buffer, draw_end, transparent_begin);
+					return;
+				}
 
-				{
-					core::ScopedDebugLabel opaque_debug_label{ command_buffer, "Opaque objects" };
+				bindSubpassResources(command_buffer);
+
+				if (m_gpu_scene) {
+					drawGpuScene(command_buffer, false);
+				}
 
-					for (auto node_it = opaque_nodes.begin(); node_it != opaque_nodes.end(); node_it++) {
+				recordDraws(command_buffer, 0, draw_end, transparent_begin, m_thread_index);
+			}
 
-						updateUniform(command_buffer, *node_it->second.first, m_thread_index);
+			void GeometrySubpass::recordDraws(core::CommandBuffer& command_buffer, size_t begin, size_t end, size_t transparent_begin, size_t thread_index) {
+				size_t opaque_end = std::min(end, transparent_begin);
 
-						const auto& scale = node_it->second.first->getTransform().getScale();
-						bool flipped = scale.x * scale.y * scale.z < 0;
-						vk::FrontFace front_face = flipped ? vk::FrontFace::eClockwise : vk::FrontFace::eCounterClockwise;
+				if (begin < opaque_end) {
+					core::ScopedDebugLabel opaque_debug_label{ command_buffer, "Opaque objects" };
 
-						drawSubmesh(command_buffer, *node_it->second.second, front_face);
+					if (!m_depth_prepass) {
+						recordBatches(command_buffer, begin, opaque_end, thread_index);
 					}
+					else {
+						// Opaque depth is already laid down by the pre-pass, only the visible surface is shaded.
+						// Alpha-masked draws are not in the pre-pass, they test and write depth here
+						for (size_t run_begin = begin; run_begin < opaque_end;) {
+							bool masked = m_render_queue[run_begin].sub_mesh->getMaterial()->m_alpha_mode == scene::AlphaMode::Mask;
+
+							size_t run_end = run_begin + 1;
+							while (run_end < opaque_end && (m_render_queue[run_end].sub_mesh->getMaterial()->m_alpha_mode == scene::AlphaMode::Mask) == masked) {
+								run_end++;
+							}
+
+							DepthStencilState depth_stencil_state = getDepthStencilState();
+							if (!masked) {
+								depth_stencil_state.depth_write_enable = false;
+								depth_stencil_state.depth_compare_op = vk::CompareOp::eEqual;
+							}
+							command_buffer.setDepthStencilState(depth_stencil_state);
+
+							recordBatches(command_buffer, run_begin, run_end, thread_index);
+							run_begin = run_end;
+						}
+					}
+				}
+
+				// Order-independent transparency is recorded by drawTransparentAccumulation() in a later subpass
+				if (end <= transparent_begin || m_order_independent_transparency) {
+					return;
 				}
 
 				ColorBlendAttachmentState color_blend_attachment{};
@@ -121,34 +493,241 @@ namespace frame {
 				{
 					core::ScopedDebugLabel transparent_debug_label{ command_buffer, "Transparent objects" };
 
-					for (auto node_it = transparent_nodes.rbegin(); node_it != transparent_nodes.rend(); node_it++) {
-						updateUniform(command_buffer, *node_it->second.first, m_thread_index);
-						drawSubmesh(command_buffer, *node_it->second.second);
+					for (size_t i = std::max(begin, transparent_begin); i < end; i++) {
+						bindObjectUniform(command_buffer, i);
+						drawSubmesh(command_buffer, *m_render_queue[i].sub_mesh, vk::FrontFace::eCounterClockwise, m_render_queue[i].lod);
 					}
 				}
 			}
 
-			void GeometrySubpass::updateUniform(core::CommandBuffer& command_buffer, scene::Node& node, size_t thread_index) {
+			void GeometrySubpass::recordBatches(core::CommandBuffer& command_buffer, size_t begin, size_t end, size_t thread_index) {
+				for (size_t i = begin; i < end;) {
+					const DrawItem& item = m_render_queue[i];
+					vk::FrontFace front_face = getFrontFace(*item.node);
+
+					size_t batch_end = i + 1;
+					if (m_instancing) {
+						while (batch_end < end &&
+							m_render_queue[batch_end].sub_mesh == item.sub_mesh &&
+							m_render_queue[batch_end].lod == item.lod &&
+							getFrontFace(*m_render_queue[batch_end].node) == front_face) {
+							batch_end++;
+						}
+					}
+
+					if (batch_end - i > 1) {
+						drawInstances(command_buffer, i, batch_end, front_face, thread_index);
+					}
+					else {
+						bindObjectUniform(command_buffer, i);
+						drawSubmesh(command_buffer, *item.sub_mesh, front_face, item.lod);
+					}
 
-				GlobalUniform global_uniform;
+					i = batch_end;
+				}
+			}
 
-				global_uniform.camera_view_proj = m_camera.getPreRotation() * vulkanStyleProjection(m_camera.getProjection()) * m_camera.getView();
+			void GeometrySubpass::drawTransparentAccumulation(core::CommandBuffer& command_buffer) {
+				size_t transparent_begin = m_render_queue.getLayerBegin(RenderLayer::Transparent);
+				if (transparent_begin >= m_render_queue.size()) {
+					return;
+				}
+
+				if (m_instance_data.size() <= m_thread_index) {
+					m_instance_data.resize(static_cast<size_t>(m_thread_index) + 1);
+				}
+
+				core::ScopedDebugLabel transparent_debug_label{ command_buffer, "OIT accumulation" };
+
+				bindSubpassResources(command_buffer);
+
+				// Weighted color and alpha are summed, the second target keeps 1 - prod(1 - alpha) so it can clear to zero
+				ColorBlendAttachmentState accumulation_blend{};
+				accumulation_blend.blend_enable = true;
+				accumulation_blend.src_color_blend_factor = vk::BlendFactor::eOne;
+				accumulation_blend.dst_color_blend_factor = vk::BlendFactor::eOne;
+				accumulation_blend.src_alpha_blend_factor = vk::BlendFactor::eOne;
+				accumulation_blend.dst_alpha_blend_factor = vk::BlendFactor::eOne;
+
+				ColorBlendAttachmentState revealage_blend{};
+				revealage_blend.blend_enable = true;
+				revealage_blend.src_color_blend_factor = vk::BlendFactor::eOne;
+				revealage_blend.dst_color_blend_factor = vk::BlendFactor::eOneMinusSrcColor;
+				revealage_blend.src_alpha_blend_factor = vk::BlendFactor::eOne;
+				revealage_blend.dst_alpha_blend_factor = vk::BlendFactor::eOneMinusSrcAlpha;
+
+				ColorBlendState color_blend_state{};
+				color_blend_state.attachments = { accumulation_blend, revealage_blend };
+				command_buffer.setColorBlendState(color_blend_state);
 
+				DepthStencilState depth_stencil_state{};
+				depth_stencil_state.depth_write_enable = false;
+				command_buffer.setDepthStencilState(depth_stencil_state);
+
+				recordBatches(command_buffer, transparent_begin, m_render_queue.size(), m_thread_index);
+			}
+
+			void GeometrySubpass::recordParallel(core::CommandBuffer& command_buffer, size_t draw_count, size_t transparent_begin) {
 				auto& render_frame = getRenderContext().getActiveFrame();
+				const auto& queue = getRenderContext().getDevice().getQueueByFlags(vk::QueueFlagBits::eGraphics, 0);
+				const auto& extent = render_frame.getRenderTarget().getExtent();
+
+				size_t max_chunk_count = std::min(static_cast<size_t>(m_recording_thread_count), render_frame.getThreadCount());
+				size_t chunk_count = std::clamp<size_t>((draw_count + MIN_DRAWS_PER_CHUNK - 1) / MIN_DRAWS_PER_CHUNK, 1, max_chunk_count);
+				size_t chunk_size = (draw_count + chunk_count - 1) / chunk_count;
+
+				// Command buffers are requested and begun here, pools are only touched by one thread at a time
+				m_secondary_command_buffers.clear();
+				for (size_t i = 0; i < chunk_count; i++) {
+					auto& secondary_command_buffer = render_frame.requestCommandBuffer(queue, core::CommandBuffer::ResetMode::ResetPool, vk::CommandBufferLevel::eSecondary, i);
+					secondary_command_buffer.begin(vk::CommandBufferUsageFlagBits::eOneTimeSubmit | vk::CommandBufferUsageFlagBits::eRenderPassContinue, &command_buffer);
+					secondary_command_buffer.setViewport(0, { { 0.0f, 0.0f, static_cast<float>(extent.width), static_cast<float>(extent.height), 0.0f, 1.0f } });
+					secondary_command_buffer.setScissor(0, { { { 0, 0 }, extent } });
+
+					m_secondary_command_buffers.push_back(&secondary_command_buffer);
+				}
+
+				std::vector<std::future<void>> chunk_futures;
+				chunk_futures.reserve(chunk_count);
+
+				for (size_t i = 0; i < chunk_count; i++) {
+					chunk_futures.push_back(m_thread_pool->submit_task([this, i, chunk_size, draw_count, transparent_begin]() {
+						auto& secondary_command_buffer = *m_secondary_command_buffers[i];
+
+						bindSubpassResources(secondary_command_buffer);
+
+						if (i == 0 && m_gpu_scene) {
+							drawGpuScene(secondary_command_buffer, false);
+						}
+
+						recordDraws(secondary_command_buffer, std::min(i * chunk_size, draw_count), std::min((i + 1) * chunk_size, draw_count), transparent_begin, i);
+
+						secondary_command_buffer.end();
+					}));
+				}
+
+				for (auto& chunk_future : chunk_futures) {
+					chunk_future.get();
+				}
+
+				command_buffer.executeCommands(m_secondary_command_buffers);
+			}
+
+			vk::SubpassContents GeometrySubpass::getSubpassContents() const {
+				return m_recording_thread_count > 1 ? vk::SubpassContents::eSecondaryCommandBuffers : vk::SubpassContents::eInline;
+			}
 
-				auto& transform = node.getTransform();
+			void GeometrySubpass::bindSubpassResources(core::CommandBuffer& command_buffer) {
+			}
+
+			void GeometrySubpass::updateObjectUniforms() {
+				auto& render_frame = getRenderContext().getActiveFrame();
+				auto& limits = getRenderContext().getDevice().getPhysicalDevice().getProperties().limits;
 
-				auto allocation = render_frame.allocateBuffer(vk::BufferUsageFlagBits::eUniformBuffer, sizeof(GlobalUniform), thread_index);
+				vk::DeviceSize alignment = std::max<vk::DeviceSize>(limits.minUniformBufferOffsetAlignment, 1);
+				m_object_uniform_stride = (sizeof(GlobalUniform) + alignment - 1) / alignment * alignment;
 
-				global_uniform.model = transform.getWorldMatrix();
+				// One slot per queued draw, followed by a camera-only slot
+				size_t object_count = m_render_queue.size() + 1;
+				m_object_uniform_data.resize(object_count * m_object_uniform_stride);
 
+				GlobalUniform global_uniform{};
+				global_uniform.camera_view_proj = m_camera.getPreRotation() * vulkanStyleProjection(m_camera.getProjection()) * m_camera.getView();
 				global_uniform.camera_position = glm::vec3(glm::inverse(m_camera.getView())[3]);
 
-				global_uniform.normal_matrix = glm::transpose(glm::inverse(glm::mat3(global_uniform.model)));
+				for (size_t i = 0; i < m_render_queue.size(); i++) {
+					global_uniform.model = m_render_queue[i].node->getTransform().getWorldMatrix();
+					global_uniform.normal_matrix = glm::transpose(glm::inverse(glm::mat3(global_uniform.model)));
+
+					std::memcpy(m_object_uniform_data.data() + i * m_object_uniform_stride, &global_uniform, sizeof(GlobalUniform));
+				}
+
+				global_uniform.model = glm::mat4(1.0f);
+				global_uniform.normal_matrix = glm::mat4(1.0f);
+				std::memcpy(m_object_uniform_data.data() + m_render_queue.size() * m_object_uniform_stride, &global_uniform, sizeof(GlobalUniform));
 
-				allocation.update(global_uniform);
+				m_object_uniforms = render_frame.allocateBuffer(vk::BufferUsageFlagBits::eUniformBuffer, m_object_uniform_data.size(), m_thread_index);
+				m_object_uniforms.update(m_object_uniform_data);
+			}
+
+			void GeometrySubpass::bindObjectUniform(core::CommandBuffer& command_buffer, size_t object_index) {
+				command_buffer.bindBuffer(m_object_uniforms.getBuffer(), m_object_uniforms.getOffset() + object_index * m_object_uniform_stride, sizeof(GlobalUniform), 0, 0, 0);
+			}
 
-				command_buffer.bindBuffer(allocation.getBuffer(), allocation.getOffset(), allocation.getSize(), 0, 0, 0);
+			void GeometrySubpass::bindCameraUniform(core::CommandBuffer& command_buffer) {
+				bindObjectUniform(command_buffer, m_render_queue.size());
+			}
+
+			void GeometrySubpass::drawGpuScene(core::CommandBuffer& command_buffer, bool late) {
+				core::ScopedDebugLabel gpu_debug_label{ command_buffer, "GPU-driven objects" };
+
+				// GPU-driven draws are not part of the depth pre-pass and keep the regular depth test
+				command_buffer.setDepthStencilState(DepthStencilState{});
+
+				// GPU_DRIVEN shaders only read the camera part of the global uniform
+				bindCameraUniform(command_buffer);
+
+				const auto& indirect_buffer = late ? m_gpu_scene->getLateIndirectBuffer() : m_gpu_scene->getIndirectBuffer();
+				const auto& visible_instance_buffer = late ? m_gpu_scene->getLateVisibleInstanceBuffer() : m_gpu_scene->getVisibleInstanceBuffer();
+				const bool multi_draw = getRenderContext().getDevice().getPhysicalDevice().getRequestedFeatures().multiDrawIndirect;
+				const uint32_t stride = sizeof(vk::DrawIndexedIndirectCommand);
+
+				auto& draws = m_gpu_scene->getDraws();
+				auto& batches = m_gpu_scene->getBatches();
+				for (size_t i = 0; i < batches.size(); i++) {
+					// Draws of a batch share everything bound here, only their commands differ
+					auto& batch = batches[i];
+					auto& sub_mesh = *draws[batch.first_draw].sub_mesh;
+					auto* pipeline_layout = bindSubmesh(command_buffer, sub_mesh, draws[batch.first_draw].shader_variant, vk::FrontFace::eCounterClockwise, nullptr);
+
+					bindStorageBuffer(command_buffer, *pipeline_layout, "instances", m_gpu_scene->getInstanceBuffer());
+					bindStorageBuffer(command_buffer, *pipeline_layout, "visible_instances", visible_instance_buffer);
+					bindGpuSceneResources(command_buffer, *pipeline_layout);
+
+					command_buffer.bindIndexBuffer(sub_mesh.getIndexBuffer(), sub_mesh.m_index_offset, sub_mesh.m_index_type);
+
+					vk::DeviceSize offset = batch.first_draw * sizeof(vk::DrawIndexedIndirectCommand);
+					if (m_gpu_scene->hasDrawCount()) {
+						const auto& count_buffer = late ? m_gpu_scene->getLateDrawCountBuffer() : m_gpu_scene->getDrawCountBuffer();
+						command_buffer.drawIndexedIndirectCount(indirect_buffer, offset, count_buffer, i * sizeof(uint32_t), batch.draw_count, stride);
+					}
+					else if (multi_draw) {
+						command_buffer.drawIndexedIndirect(indirect_buffer, offset, batch.draw_count, stride);
+					}
+					else {
+						for (uint32_t j = 0; j < batch.draw_count; j++) {
+							command_buffer.drawIndexedIndirect(indirect_buffer, offset + j * stride, 1, stride);
+						}
+					}
+				}
+			}
+
+			void GeometrySubpass::drawInstances(core::CommandBuffer& command_buffer, size_t begin, size_t end, vk::FrontFace front_face, size_t thread_index) {
+				const DrawItem& first_item = m_render_queue[begin];
+				auto& instance_data = m_instance_data[thread_index];
+
+				instance_data.clear();
+				for (size_t i = begin; i < end; i++) {
+					glm::mat4 model = m_render_queue[i].node->getTransform().getWorldMatrix();
+					instance_data.push_back({ model, glm::transpose(glm::inverse(glm::mat3(model))), static_cast<uint32_t>(i - begin) });
+				}
+
+				auto& render_frame = getRenderContext().getActiveFrame();
+				auto allocation = render_frame.allocateBuffer(vk::BufferUsageFlagBits::eVertexBuffer, instance_data.size() * sizeof(InstanceData), thread_index);
+				allocation.getBuffer().update(instance_data, allocation.getOffset());
+
+				bindObjectUniform(command_buffer, begin);
+
+				if (drawSubmeshInstanced(command_buffer, *first_item.sub_mesh, m_instanced_variants.at(first_item.sub_mesh),
+					allocation, static_cast<uint32_t>(instance_data.size()), front_face, first_item.lod)) {
+					return;
+				}
+
+				// The shader has no per-instance inputs, draw the batch one node at a time
+				for (size_t i = begin; i < end; i++) {
+					bindObjectUniform(command_buffer, i);
+					drawSubmesh(command_buffer, *m_render_queue[i].sub_mesh, front_face, m_render_queue[i].lod);
+				}
 			}
 
 			std::string ShaderStageFlagsToString(const vk::ShaderStageFlags& flags) {
@@ -192,9 +771,24 @@ namespace frame {
 				return result;
 			}
 
-			void GeometrySubpass::drawSubmesh(core::CommandBuffer& command_buffer, scene::SubMesh& sub_mesh, vk::FrontFace front_face) {
+			void GeometrySubpass::drawSubmesh(core::CommandBuffer& command_buffer, scene::SubMesh& sub_mesh, vk::FrontFace front_face, uint32_t lod) {
+				bindSubmesh(command_buffer, sub_mesh, sub_mesh.getShaderVariant(), front_face, nullptr);
 
-				auto& device = command_buffer.getDevice();
+				drawSubmeshCommand(command_buffer, sub_mesh, 1, lod);
+			}
+
+			bool GeometrySubpass::drawSubmeshInstanced(core::CommandBuffer& command_buffer, scene::SubMesh& sub_mesh, const core::ShaderVariant& shader_variant,
+				common::BufferAllocation& instance_allocation, uint32_t instance_count, vk::FrontFace front_face, uint32_t lod) {
+				if (!bindSubmesh(command_buffer, sub_mesh, shader_variant, front_face, &instance_allocation)) {
+					return false;
+				}
+
+				drawSubmeshCommand(command_buffer, sub_mesh, instance_count, lod);
+				return true;
+			}
+
+			core::PipelineLayoutCPP* GeometrySubpass::bindSubmesh(core::CommandBuffer& command_buffer, scene::SubMesh& sub_mesh, const core::ShaderVariant& shader_variant,
+				vk::FrontFace front_face, common::BufferAllocation* instance_allocation) {
 
 				core::ScopedDebugLabel submesh_debug_label{ command_buffer, sub_mesh.getName().c_str() };
 
@@ -204,12 +798,8 @@ namespace frame {
 				multisample_state.rasterization_samples = getSampleCount();
 				command_buffer.setMultisampleState(multisample_state);
 
-				auto& vert_shader_module = device.getResourceCache().requestShaderModule(vk::ShaderStageFlagBits::eVertex, getVertexShader(), sub_mesh.getShaderVariant());
-				auto& frag_shader_module = device.getResourceCache().requestShaderModule(vk::ShaderStageFlagBits::eFragment, getFragmentShader(), sub_mesh.getShaderVariant());
-
-				std::vector<core::ShaderModuleCPP*> shader_modules{ &vert_shader_module, &frag_shader_module };
-
-				auto& pipeline_layout = preparePipelineLayout(command_buffer, shader_modules);
+				// Recording threads share the layouts read-only, they were resolved in prepare()
+				auto& pipeline_layout = getPipelineLayout(shader_variant);
 
 				command_buffer.bindPipelineLayout(pipeline_layout);
 
@@ -241,22 +831,80 @@ namespace frame {
 
 				VertexInputState vertex_input_state;
 				std::set<uint32_t> added_bindings;
+
+				// Per-instance matrices share one binding, numbered by the first instance input location
+				uint32_t instance_binding = std::numeric_limits<uint32_t>::max();
+				if (instance_allocation != nullptr) {
+					for (auto& input_resource : vertex_input_resources) {
+						if (isInstanceInput(input_resource.name)) {
+							instance_binding = std::min(instance_binding, input_resource.location);
+						}
+					}
+				}
+
+				bool instanced = instance_binding != std::numeric_limits<uint32_t>::max();
+				if (instance_allocation != nullptr && !instanced) {
+					return nullptr;
+				}
+
+				// Interleaved arena geometry uses a single binding, numbered by the first vertex attribute location
+				uint32_t arena_binding = std::numeric_limits<uint32_t>::max();
+				uint32_t arena_stride = 0;
+				if (sub_mesh.m_vertex_arena != nullptr) {
+					for (auto& input_resource : vertex_input_resources) {
+						scene::VertexAttribute attribute;
+						if (!isInstanceInput(input_resource.name) && sub_mesh.getAttribute(input_resource.name, attribute)) {
+							arena_binding = std::min(arena_binding, input_resource.location);
+							arena_stride = attribute.stride;
+						}
+					}
+				}
 				
 				for (auto& input_resource : vertex_input_resources) {
 					scene::VertexAttribute attribute;
 
+					if (instanced && input_resource.name == "instance_batch_index") {
+						vk::VertexInputAttributeDescription instance_attribute{};
+						instance_attribute.binding = instance_binding;
+						instance_attribute.format = vk::Format::eR32Uint;
+						instance_attribute.location = input_resource.location;
+						instance_attribute.offset = offsetof(InstanceData, batch_index);
+
+						vertex_input_state.attributes.push_back(instance_attribute);
+						continue;
+					}
+
+					if (instanced && isInstanceInput(input_resource.name)) {
+						uint32_t base_offset = input_resource.name == "instance_model" ? offsetof(InstanceData, model) : offsetof(InstanceData, normal_matrix);
+
+						for (uint32_t column = 0; column < std::max(input_resource.columns, 1u); column++) {
+							vk::VertexInputAttributeDescription instance_attribute{};
+							instance_attribute.binding = instance_binding;
+							instance_attribute.format = vk::Format::eR32G32B32A32Sfloat;
+							instance_attribute.location = input_resource.location + column;
+							instance_attribute.offset = base_offset + column * sizeof(glm::vec4);
+
+							vertex_input_state.attributes.push_back(instance_attribute);
+						}
+						continue;
+					}
+
 					if (!sub_mesh.getAttribute(input_resource.name, attribute)) {
 						continue;
 					}
 
 					vk::VertexInputAttributeDescription vertex_attribute{};
-					vertex_attribute.binding = input_resource.location;
+					vertex_attribute.binding = sub_mesh.m_vertex_arena ? arena_binding : input_resource.location;
 					vertex_attribute.format = attribute.format;
 					vertex_attribute.location = input_resource.location;
 					vertex_attribute.offset = attribute.offset;
 
 					vertex_input_state.attributes.push_back(vertex_attribute);
 
+					if (sub_mesh.m_vertex_arena) {
+						continue;
+					}
+
 					vk::VertexInputBindingDescription vertex_binding{};
 					vertex_binding.binding = input_resource.location;
 					vertex_binding.stride = attribute.stride;
@@ -264,7 +912,31 @@ namespace frame {
 					vertex_input_state.bindings.push_back(vertex_binding);
 				}
 
+				if (sub_mesh.m_vertex_arena && arena_stride != 0) {
+					vk::VertexInputBindingDescription arena_binding_description{};
+					arena_binding_description.binding = arena_binding;
+					arena_binding_description.stride = arena_stride;
+
+					vertex_input_state.bindings.push_back(arena_binding_description);
+				}
+
+				if (instanced) {
+					vk::VertexInputBindingDescription instance_binding_description{};
+					instance_binding_description.binding = instance_binding;
+					instance_binding_description.stride = sizeof(InstanceData);
+					instance_binding_description.inputRate = vk::VertexInputRate::eInstance;
+
+					vertex_input_state.bindings.push_back(instance_binding_description);
+				}
+
 				command_buffer.setVertexInputState(vertex_input_state);
+
+				if (sub_mesh.m_vertex_arena && arena_stride != 0) {
+					std::vector<std::reference_wrapper<const common::Buffer>> buffers;
+					buffers.emplace_back(std::ref(*sub_mesh.m_vertex_arena));
+
+					command_buffer.bindVertexBuffers(arena_binding, std::move(buffers), { 0 });
+				}
 				
 				for (auto& input_resource : vertex_input_resources) {
 					const auto& buffer_iter = sub_mesh.m_vertex_buffers.find(input_resource.name);
@@ -277,7 +949,30 @@ namespace frame {
 					}
 				}
 
-				drawSubmeshCommand(command_buffer, sub_mesh);
+				if (instanced) {
+					std::vector<std::reference_wrapper<const common::Buffer>> buffers;
+					buffers.emplace_back(std::ref(instance_allocation->getBuffer()));
+
+					command_buffer.bindVertexBuffers(instance_binding, std::move(buffers), { instance_allocation->getOffset() });
+				}
+
+				return &pipeline_layout;
+			}
+
+			void GeometrySubpass::bindGpuSceneResources(core::CommandBuffer& command_buffer, core::PipelineLayoutCPP& pipeline_layout) {
+			}
+
+			void GeometrySubpass::bindStorageBuffer(core::CommandBuffer& command_buffer, core::PipelineLayoutCPP& pipeline_layout, const std::string& name,
+				const common::Buffer& buffer, vk::DeviceSize offset, vk::DeviceSize range) {
+				for (const auto& [set_index, resources] : pipeline_layout.getShaderSets()) {
+					if (!pipeline_layout.hasDescriptorSetLayout(set_index)) {
+						continue;
+					}
+
+					if (auto layout_binding = pipeline_layout.getDescriptorSetLayout(set_index).getLayoutBinding(name)) {
+						command_buffer.bindBuffer(buffer, offset, range == VK_WHOLE_SIZE ? buffer.getSize() - offset : range, set_index, layout_binding->binding, 0);
+					}
+				}
 			}
 
 			void GeometrySubpass::preparePipelineState(core::CommandBuffer& command_buffer, vk::FrontFace front_face, bool double_sided_material) {
@@ -296,15 +991,17 @@ namespace frame {
 				command_buffer.setMultisampleState(multisample_state);
 			}
 
-			core::PipelineLayoutCPP& GeometrySubpass::preparePipelineLayout(core::CommandBuffer& command_buffer, const std::vector<core::ShaderModuleCPP*>& shader_modules) {
+			core::PipelineLayoutCPP& GeometrySubpass::preparePipelineLayout(const std::vector<core::ShaderModuleCPP*>& shader_modules) {
 
 				for (auto& shader_module : shader_modules) {
 					for (auto& resource_mode : getResourceModeMap()) {
 						shader_module->setResourceMode(resource_mode.first, resource_mode.second);
 					}
+
+					setObjectUniformDynamic(*shader_module);
 				}
 
-				return command_buffer.getDevice().getResourceCache().requestPipelineLayout(shader_modules);
+				return getRenderContext().getDevice().getResourceCache().requestPipelineLayout(shader_modules);
 			}
 
 			void GeometrySubpass::preparePushConstants(core::CommandBuffer& command_buffer, scene::SubMesh& sub_mesh) {
@@ -322,21 +1019,65 @@ namespace frame {
 				}
 			}
 
-			void GeometrySubpass::drawSubmeshCommand(core::CommandBuffer& command_buffer, scene::SubMesh& sub_mesh) {
+			void GeometrySubpass::drawSubmeshCommand(core::CommandBuffer& command_buffer, scene::SubMesh& sub_mesh, uint32_t instance_count, uint32_t lod) {
 
 				if (sub_mesh.m_vertex_indices != 0) {
-					command_buffer.bindIndexBuffer(*sub_mesh.m_index_buffer, sub_mesh.m_index_offset, sub_mesh.m_index_type);
+					command_buffer.bindIndexBuffer(sub_mesh.getIndexBuffer(), sub_mesh.m_index_offset, sub_mesh.m_index_type);
 
-					command_buffer.drawIndexed(sub_mesh.m_vertex_indices, 1, 0, 0, 0);
+					scene::IndexLod index_lod = sub_mesh.getLod(lod);
+					command_buffer.drawIndexed(index_lod.index_count, instance_count, sub_mesh.m_first_index + index_lod.first_index, sub_mesh.m_vertex_offset, 0);
 				}
 				else {
-					command_buffer.draw(sub_mesh.m_vertices_count, 1, 0, 0);
+					command_buffer.draw(sub_mesh.m_vertices_count, instance_count, static_cast<uint32_t>(sub_mesh.m_vertex_offset), 0);
 				}
 			}
 
 			void GeometrySubpass::setThreadIndex(uint32_t index) {
 				m_thread_index = index;
 			}
+
+			void GeometrySubpass::setFrustumCulling(bool enable) {
+				m_frustum_culling = enable;
+			}
+
+			void GeometrySubpass::setInstancing(bool enable) {
+				m_instancing = enable;
+			}
+
+			void GeometrySubpass::setGpuDriven(core::ShaderSource&& cull_shader) {
+				m_gpu_scene = std::make_unique<GpuScene>(getRenderContext(), std::move(cull_shader), m_meshes);
+			}
+
+			void GeometrySubpass::setOcclusionCulling(core::ShaderSource&& depth_reduce_shader) {
+				m_depth_pyramid = std::make_unique<DepthPyramid>(getRenderContext(), std::move(depth_reduce_shader));
+			}
+
+			void GeometrySubpass::setDepthPrepass(bool enable) {
+				m_depth_prepass = enable;
+			}
+
+			void GeometrySubpass::setLodThresholds(const std::vector<float>& thresholds) {
+				m_lod_thresholds = thresholds;
+			}
+
+			void GeometrySubpass::setOrderIndependentTransparency(bool enable) {
+				m_order_independent_transparency = enable;
+			}
+
+			const RenderQueue& GeometrySubpass::getRenderQueue() const {
+				return m_render_queue;
+			}
+
+			void GeometrySubpass::setRecordingThreadCount(uint32_t thread_count) {
+				m_recording_thread_count = std::max(thread_count, 1u);
+
+				if (m_recording_thread_count > 1) {
+					m_thread_pool = std::make_unique<BS::thread_pool>(m_recording_thread_count);
+				}
+				else {
+					m_thread_pool.reset();
+				}
+			}
 		}
 	}
 }
@@ -17,8 +17,14 @@
 
 #pragma once
 
+#include <BS_thread_pool.hpp>
+
 #include "global_common.h"
+#include "rendering/depth_pyramid.h"
+#include "rendering/gpu_scene.h"
+#include "rendering/render_queue.h"
 #include "rendering/subpass.h"
+#include "scene/frustum.h"
 
 namespace frame {
 	namespace scene {
@@ -37,6 +43,13 @@ namespace frame {
 			glm::mat4 normal_matrix;
 		};
 
+		struct InstanceData {
+			glm::mat4 model;
+			glm::mat4 normal_matrix;
+			// Position of the draw in its batch, indexes per-draw data bound at the batch's first draw
+			uint32_t batch_index;
+		};
+
 		struct PBRMaterialUniform {
 			glm::vec4 color;
 			float metallic;
@@ -52,31 +65,160 @@ namespace frame {
 
 				virtual void prepare() override;
 
+				// Geometry shaders are built with COMPACT_GBUFFER while the target has the compact G-buffer layout,
+				// a target with the other layout waits for the device and prepares the subpass again
+				virtual void prepareRenderTarget(const RenderTarget& render_target) override;
+
+				virtual void prepareFrame(core::CommandBuffer& command_buffer) override;
+
 				virtual void draw(core::CommandBuffer& command_buffer) override;
 
+				virtual void finishFrame(core::CommandBuffer& command_buffer, RenderTarget& render_target) override;
+
+				// GPU-driven occlusion culling draws the instances it finds disoccluded in a late scope of the same frame.
+				// The transparent layer is recorded after them, in the late scope
+				virtual bool hasLateDraws() const override;
+
+				virtual void prepareLateDraws(core::CommandBuffer& command_buffer, RenderTarget& render_target) override;
+
+				virtual void drawLate(core::CommandBuffer& command_buffer) override;
+
+				virtual vk::SubpassContents getSubpassContents() const override;
+
 				void setThreadIndex(uint32_t index);
 
+				void setFrustumCulling(bool enable);
+
+				void setInstancing(bool enable);
+
+				void setGpuDriven(core::ShaderSource&& cull_shader);
+
+				// The pyramid is reduced from the depth attachment, between the rendering scopes with a GPU scene and
+				// after the render pass otherwise, where the depth attachment has to be stored. GPU-driven occlusion
+				// culling needs a dynamic rendering pipeline
+				void setOcclusionCulling(core::ShaderSource&& depth_reduce_shader);
+
+				void setRecordingThreadCount(uint32_t thread_count);
+
+				// Opaque draws that are not alpha-masked are shaded with an EQUAL depth test against the pre-pass depth.
+				// Sub-mesh variants get INVARIANT_POSITION, which declares gl_Position invariant in their vertex shaders
+				void setDepthPrepass(bool enable);
+
+				// Transparent draws are left to drawTransparentAccumulation() and are batched like opaque ones
+				void setOrderIndependentTransparency(bool enable);
+
+				// Records the transparent draws into the weighted-blended OIT accumulation and revealage targets
+				void drawTransparentAccumulation(core::CommandBuffer& command_buffer);
+
+				// Projected bounding sphere diameters, as fractions of the viewport height, below which the next coarser LOD is drawn
+				void setLodThresholds(const std::vector<float>& thresholds);
+
+				const RenderQueue& getRenderQueue() const;
+
+				virtual void bindObjectUniform(core::CommandBuffer& command_buffer, size_t object_index);
+
 			protected:
-				virtual void updateUniform(core::CommandBuffer& command_buffer, scene::Node& node, size_t thread_index);
+				static constexpr size_t MIN_DRAWS_PER_CHUNK = 64;
 
-				void drawSubmesh(core::CommandBuffer& command_buffer, scene::SubMesh& sub_mesh, vk::FrontFace front_face = vk::FrontFace::eCounterClockwise);
+				virtual void bindSubpassResources(core::CommandBuffer& command_buffer);
+
+				void bindCameraUniform(core::CommandBuffer& command_buffer);
+
+				void drawSubmesh(core::CommandBuffer& command_buffer, scene::SubMesh& sub_mesh, vk::FrontFace front_face = vk::FrontFace::eCounterClockwise, uint32_t lod = 0);
+
+				bool drawSubmeshInstanced(core::CommandBuffer& command_buffer, scene::SubMesh& sub_mesh, const core::ShaderVariant& shader_variant,
+					common::BufferAllocation& instance_allocation, uint32_t instance_count, vk::FrontFace front_face = vk::FrontFace::eCounterClockwise, uint32_t lod = 0);
 
 				virtual void preparePipelineState(core::CommandBuffer& command_buffer, vk::FrontFace front_face, bool double_sided_material);
 
-				virtual core::PipelineLayoutCPP& preparePipelineLayout(core::CommandBuffer& command_buffer, const std::vector<core::ShaderModuleCPP*>& shader_modules);
+				virtual core::PipelineLayoutCPP& preparePipelineLayout(const std::vector<core::ShaderModuleCPP*>& shader_modules);
 
 				virtual void preparePushConstants(core::CommandBuffer& command_buffer, scene::SubMesh& sub_mesh);
 
-				virtual void drawSubmeshCommand(core::CommandBuffer& command_buffer, scene::SubMesh& sub_mesh);
+				virtual void drawSubmeshCommand(core::CommandBuffer& command_buffer, scene::SubMesh& sub_mesh, uint32_t instance_count = 1, uint32_t lod = 0);
 
-				void getSortedNodes(std::multimap<float, std::pair<scene::Node*, scene::SubMesh*>>& opaque_nodes,
-					std::multimap<float, std::pair<scene::Node*, scene::SubMesh*>>& transparent_nodes);
+				// Binds per-instance resources of the GPU-driven draws, after the instance buffers
+				virtual void bindGpuSceneResources(core::CommandBuffer& command_buffer, core::PipelineLayoutCPP& pipeline_layout);
+
+				// Binds buffer to the descriptor called name, if the pipeline layout has one
+				void bindStorageBuffer(core::CommandBuffer& command_buffer, core::PipelineLayoutCPP& pipeline_layout, const std::string& name,
+					const common::Buffer& buffer, vk::DeviceSize offset = 0, vk::DeviceSize range = VK_WHOLE_SIZE);
+
+				void getSortedNodes(RenderQueue& render_queue);
 
 				scene::Camera& m_camera;
 				std::vector<scene::Mesh*> m_meshes;
 				scene::Scene& m_scene;
 				uint32_t m_thread_index{ 0 };
 				RasterizationState m_base_rasterization_state{};
+				scene::Frustum m_frustum{};
+				glm::mat4 m_view_proj{ 1.0f };
+				bool m_frustum_culling{ true };
+				bool m_instancing{ true };
+				bool m_depth_prepass{ false };
+				bool m_order_independent_transparency{ false };
+				bool m_compact_gbuffer{ false };
+				std::vector<float> m_lod_thresholds{ 0.4f, 0.2f, 0.1f, 0.05f };
+
+				RenderQueue m_render_queue;
+
+				std::unique_ptr<GpuScene> m_gpu_scene;
+
+				std::unique_ptr<DepthPyramid> m_depth_pyramid;
+
+			private:
+				struct VisibleNode {
+					scene::Node* node;
+					size_t mesh_index;
+					float distance;
+					float screen_size;
+				};
+
+				// Adds or undoes COMPACT_GBUFFER in the sub-mesh variants
+				void setGBufferLayout(bool compact);
+
+				void updateDrawStates();
+
+				// Resolves shader modules and pipeline layouts up front, recording threads only look them up
+				void preparePipelineLayouts();
+
+				core::PipelineLayoutCPP& getPipelineLayout(const core::ShaderVariant& shader_variant) const;
+
+				uint32_t selectLod(const scene::SubMesh& sub_mesh, float screen_size) const;
+
+				void updateObjectUniforms();
+
+				void recordDraws(core::CommandBuffer& command_buffer, size_t begin, size_t end, size_t transparent_begin, size_t thread_index);
+
+				void recordBatches(core::CommandBuffer& command_buffer, size_t begin, size_t end, size_t thread_index);
+
+				// Records the first draw_count queued draws split across secondary command buffers
+				void recordParallel(core::CommandBuffer& command_buffer, size_t draw_count, size_t transparent_begin);
+
+				void drawInstances(core::CommandBuffer& command_buffer, size_t begin, size_t end, vk::FrontFace front_face, size_t thread_index);
+
+				// Records one multi-draw per GpuScene batch, late selects the draws phase 2 found visible
+				void drawGpuScene(core::CommandBuffer& command_buffer, bool late);
+
+				core::PipelineLayoutCPP* bindSubmesh(core::CommandBuffer& command_buffer, scene::SubMesh& sub_mesh, const core::ShaderVariant& shader_variant,
+					vk::FrontFace front_face, common::BufferAllocation* instance_allocation);
+
+				std::vector<std::vector<uint32_t>> m_state_ids;
+				std::vector<std::vector<uint32_t>> m_batch_ids;
+				std::unordered_map<const scene::SubMesh*, core::ShaderVariant> m_instanced_variants;
+				std::unordered_map<size_t, core::PipelineLayoutCPP*> m_pipeline_layouts;
+				std::vector<std::vector<InstanceData>> m_instance_data;
+				std::vector<uint8_t> m_object_uniform_data;
+				common::BufferAllocation m_object_uniforms;
+				vk::DeviceSize m_object_uniform_stride{ 0 };
+				uint32_t m_recording_thread_count{ 1 };
+				std::unique_ptr<BS::thread_pool> m_thread_pool;
+				std::vector<core::CommandBuffer*> m_secondary_command_buffers;
+				std::vector<VisibleNode> m_visible_nodes;
+				std::vector<std::pair<scene::Node*, size_t>> m_cull_candidates;
+				std::vector<glm::vec3> m_cull_centers;
+				std::vector<glm::vec3> m_cull_extents;
+				std::vector<uint8_t> m_cull_visibility;
 			};
 		}
 	}
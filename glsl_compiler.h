@@ -136,7 +136,13 @@ namespace frame {
                 shader.setEnvInput(glslang::EShSourceGlsl, options.shaderType, glslang::EShClientVulkan, options.vulkanVersion);
                 shader.setEnvClient(glslang::EShClientVulkan, getVulkanTargetEnv(options.vulkanVersion));
                 shader.setEnvTarget(glslang::EShTargetSpv, getSpvTargetVersion(options.vulkanVersion));
-                shader.setPreamble(shader_variant.getPreamble().c_str());
+                // Vertex shaders of INVARIANT_POSITION variants compute gl_Position identically wherever the same expression is used,
+                // so passes that rasterize the same geometry get bit-identical depth
+                std::string preamble = shader_variant.getPreamble();
+                if (shader_stage == vk::ShaderStageFlagBits::eVertex) {
+                    preamble += "#ifdef INVARIANT_POSITION\ninvariant gl_Position;\n#endif\n";
+                }
+                shader.setPreamble(preamble.c_str());
                 shader.addProcesses(shader_variant.getProcesses());
 
                 if (!shader.parse(GetDefaultResources(), 100, false, EShMsgDefault, m_includer)) {
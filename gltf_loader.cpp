@@ -20,9 +20,9 @@
 #define TINYGLTF_IMPLEMENTATION
 #include "common/gltf_loader.h"
 
+#include <cstring>
 #include <limits>
 #include <queue>
-#include <set>
 
 #include "global_common.h"
 #include <glm/gtc/type_ptr.hpp>
@@ -36,12 +36,15 @@
 #include "core/queue.h"
 #include "core/fence_pool.h"
 #include "common/buffer.h"
+#include "common/buffer_uploader.h"
+#include "common/mesh_simplifier.h"
 #include "filesystem/filesystem.h"
 
 #include "scene/components/camera/camera.h"
 #include "scene/components/image/image.h"
 #include "scene/components/image/astc.h"
 #include "scene/components/light.h"
+#include "scene/components/mesh/geometry_arena.h"
 #include "scene/components/mesh/mesh.h"
 #include "scene/components/material/pbr_material.h"
 #include "scene/components/camera/perspective_camera.h"
@@ -112,6 +115,38 @@ namespace frame {
                 }
             }
     
+            std::vector<uint32_t> unpackIndices(const std::vector<uint8_t>& index_data, vk::IndexType index_type) {
+                std::vector<uint32_t> indices;
+
+                if(index_type == vk::IndexType::eUint32) {
+                    indices.resize(index_data.size() / sizeof(uint32_t));
+                    std::memcpy(indices.data(), index_data.data(), indices.size() * sizeof(uint32_t));
+                }
+                else {
+                    std::vector<uint16_t> short_indices(index_data.size() / sizeof(uint16_t));
+                    std::memcpy(short_indices.data(), index_data.data(), short_indices.size() * sizeof(uint16_t));
+                    indices.assign(short_indices.begin(), short_indices.end());
+                }
+
+                return indices;
+            }
+
+            std::vector<uint8_t> packIndices(const std::vector<uint32_t>& indices, vk::IndexType index_type) {
+                std::vector<uint8_t> index_data;
+
+                if(index_type == vk::IndexType::eUint32) {
+                    index_data.resize(indices.size() * sizeof(uint32_t));
+                    std::memcpy(index_data.data(), indices.data(), index_data.size());
+                }
+                else {
+                    std::vector<uint16_t> short_indices(indices.begin(), indices.end());
+                    index_data.resize(short_indices.size() * sizeof(uint16_t));
+                    std::memcpy(index_data.data(), short_indices.data(), index_data.size());
+                }
+
+                return index_data;
+            }
+
             std::vector<uint8_t> getAttributeData(const tinygltf::Model* model, uint32_t accessor_id) {
                 const auto& accessor = model->accessors[accessor_id];
                 const auto& buffer_view = model->bufferViews[accessor.bufferView];
@@ -128,6 +163,11 @@ namespace frame {
                 return model->accessors[accessor_id].count;
             }
     
+            size_t getAttributeElementSize(const tinygltf::Model* model, uint32_t accessor_id) {
+                const auto& accessor = model->accessors[accessor_id];
+                return tinygltf::GetComponentSizeInBytes(accessor.componentType) * tinygltf::GetNumComponentsInType(accessor.type);
+            }
+    
             size_t getAttributeStride(const tinygltf::Model* model, uint32_t accessor_id) {
                 const auto& accessor = model->accessors[accessor_id];
                 const auto& buffer_view = model->bufferViews[accessor.bufferView];
@@ -276,52 +316,6 @@ namespace frame {
                 }
             }
     
-            void prepareMeshlets(std::vector<Meshlet>& meshlets, std::unique_ptr<scene::SubMesh>& submesh, std::vector<unsigned char>& index_data) {
-    
-                Meshlet meshlet;
-                meshlet.vertex_count = 0;
-                meshlet.index_count = 0;
-    
-                std::set<uint32_t> vertices;
-                uint32_t triangle_check = 0;
-    
-                for (uint32_t i = 0; i < submesh->m_vertex_indices; i++) {
-    
-                    meshlet.indices[meshlet.index_count] = *(reinterpret_cast<uint32_t*>(index_data.data()) + i);
-    
-                    if(vertices.insert(meshlet.indices[meshlet.index_count]).second) {
-                        ++meshlet.vertex_count;
-                    }
-    
-                    meshlet.index_count++;
-                    triangle_check = triangle_check < 3 ? ++triangle_check : 1;
-                    
-                    if(meshlet.vertex_count == 64 || meshlet.index_count == 96 || i == submesh->m_vertex_indices - 1) {
-    
-                        if(i == submesh->m_vertex_indices - 1) {
-                            assert(triangle_check == 3);
-                        }
-    
-                        uint32_t counter = 0;
-    
-                        for (auto v : vertices) {
-                            meshlet.vertices[counter++] = v;
-                        }
-    
-                        if(triangle_check != 3) {
-                            meshlet.index_count -= triangle_check;
-                            i -= triangle_check;
-                            triangle_check = 0;
-                        }
-    
-                        meshlets.push_back(meshlet);
-                        meshlet.vertex_count = 0;
-                        meshlet.index_count = 0;
-                        vertices.clear();
-                    }
-                }
-            }
-    
             bool textureNeedsSrgbColorspace(const std::string& name) {
     
                 if(name == "baseColorTexture" || name == "emissiveTexture") {
@@ -367,7 +361,9 @@ namespace frame {
         std::unique_ptr<scene::Scene> GltfLoader::readSceneFromFile(
             const std::string& file_name,
             int scene_index,
-            vk::BufferUsageFlags additional_buffer_usage_flags)
+            vk::BufferUsageFlags additional_buffer_usage_flags,
+            bool pack_geometry,
+            bool generate_lods)
         {
             PROFILE_SCOPE("Load GLTF Scene");
     
@@ -400,7 +396,7 @@ namespace frame {
                 m_model_path.clear();
             }
     
-            return std::make_unique<scene::Scene>(loadScene(scene_index, additional_buffer_usage_flags));
+            return std::make_unique<scene::Scene>(loadScene(scene_index, additional_buffer_usage_flags, pack_geometry, generate_lods));
         }
     
         std::unique_ptr<scene::SubMesh> GltfLoader::readModelFromFile(
@@ -443,7 +439,7 @@ namespace frame {
             return loadModel(index, storage_buffer, additional_buffer_usage_flags);
         }
     
-        scene::Scene GltfLoader::loadScene(int scene_index, vk::BufferUsageFlags additional_buffer_usage_flags) {
+        scene::Scene GltfLoader::loadScene(int scene_index, vk::BufferUsageFlags additional_buffer_usage_flags, bool pack_geometry, bool generate_lods) {
     
             PROFILE_SCOPE("Process Scene");
     
@@ -623,6 +619,13 @@ namespace frame {
             auto default_material = createDefaultMaterial();
             
             auto materials = scene.getComponents<scene::PBRMaterial>();
+
+            BufferUploader uploader{ m_device };
+
+            std::unique_ptr<scene::GeometryArena> geometry_arena;
+            if(pack_geometry) {
+                geometry_arena = std::make_unique<scene::GeometryArena>();
+            }
     
             for (auto& gltf_mesh : m_model.meshes) {
                 PROFILE_SCOPE("Processing Mesh");
@@ -634,6 +637,8 @@ namespace frame {
     
                     auto submesh_name = fmt::format("'{}' mesh, primitive #{}", gltf_mesh.name, i_primitive);
                     auto submesh = std::make_unique<scene::SubMesh>(std::move(submesh_name));
+                    std::vector<scene::GeometryArena::VertexStream> vertex_streams;
+                    std::vector<glm::vec3> positions;
     
                     for (auto& attribute : gltf_primitive.attributes) {
                         std::string attrib_name = attribute.first;
@@ -643,15 +648,39 @@ namespace frame {
     
                         if(attrib_name == "position") {
                             assert(attribute.second < m_model.accessors.size());
-                            submesh->m_vertices_count = static_cast<uint32_t>(m_model.accessors[attribute.second].count);
+                            const auto& position_accessor = m_model.accessors[attribute.second];
+                            submesh->m_vertices_count = static_cast<uint32_t>(position_accessor.count);
+
+                            bool has_min_max = position_accessor.minValues.size() >= 3 && position_accessor.maxValues.size() >= 3;
+
+                            if((!has_min_max || generate_lods) && getAttributeFormat(&m_model, attribute.second) == vk::Format::eR32G32B32Sfloat) {
+                                size_t position_stride = getAttributeStride(&m_model, attribute.second);
+                                positions.resize(position_accessor.count);
+                                for (size_t v = 0; v < positions.size(); v++) {
+                                    std::memcpy(&positions[v], vertex_data.data() + v * position_stride, sizeof(glm::vec3));
+                                }
+                            }
+
+                            if(has_min_max) {
+                                mesh->updateBounds({
+                                    glm::vec3(position_accessor.minValues[0], position_accessor.minValues[1], position_accessor.minValues[2]),
+                                    glm::vec3(position_accessor.maxValues[0], position_accessor.maxValues[1], position_accessor.maxValues[2]) });
+                            }
+                            else if(!positions.empty()) {
+                                mesh->updateBounds(positions);
+                            }
+                        }
+
+                        if(geometry_arena) {
+                            vertex_streams.push_back({ attrib_name,
+                                getAttributeFormat(&m_model, attribute.second),
+                                static_cast<uint32_t>(getAttributeElementSize(&m_model, attribute.second)),
+                                static_cast<uint32_t>(getAttributeStride(&m_model, attribute.second)),
+                                std::move(vertex_data) });
+                            continue;
                         }
     
-                        Buffer buffer{ m_device,
-                        	vertex_data.size(),
-                        	vk::BufferUsageFlagBits::eVertexBuffer | additional_buffer_usage_flags,
-                        	VMA_MEMORY_USAGE_CPU_TO_GPU };
-    
-                        buffer.update(vertex_data);
+                        Buffer buffer = uploader.upload(vertex_data, vk::BufferUsageFlagBits::eVertexBuffer | additional_buffer_usage_flags);
                         buffer.setDebugName(fmt::format("'{}' mesh, primitive #{}: '{}' vertex buffer",
                             gltf_mesh.name, i_primitive, attrib_name));
     
@@ -663,6 +692,10 @@ namespace frame {
     
                         submesh->setAttribute(attrib_name, attrib);
                     }
+
+                    if(geometry_arena) {
+                        geometry_arena->addVertices(*submesh, vertex_streams, submesh->m_vertices_count);
+                    }
     
                     if(gltf_primitive.indices >= 0) {
                         submesh->m_vertex_indices = static_cast<uint32_t>(getAttributeSize(&m_model, gltf_primitive.indices));
@@ -685,15 +718,32 @@ namespace frame {
                             LOGE("gltf primitive has invalid format type");
                             break;
                         }
-    
-                        submesh->m_index_buffer = std::make_unique<Buffer>(m_device,
-                            index_data.size(),
-                            vk::BufferUsageFlagBits::eIndexBuffer | additional_buffer_usage_flags,
-                            VMA_MEMORY_USAGE_GPU_TO_CPU);
-                        submesh->m_index_buffer->setDebugName(fmt::format("'{}' mesh, primitive #{}: index buffer",
-                            gltf_mesh.name, i_primitive));
-    
-                        submesh->m_index_buffer->update(index_data);
+
+                        bool is_triangle_list = gltf_primitive.mode == -1 || gltf_primitive.mode == TINYGLTF_MODE_TRIANGLES;
+
+                        if(generate_lods && is_triangle_list && !positions.empty()) {
+                            auto lods = generateLods(positions, unpackIndices(index_data, submesh->m_index_type));
+
+                            // All levels go into one index list so they share the buffer and arena range of the sub mesh
+                            if(lods.size() > 1) {
+                                std::vector<uint32_t> lod_indices;
+                                for (auto& lod : lods) {
+                                    submesh->m_lods.push_back({ static_cast<uint32_t>(lod_indices.size()), static_cast<uint32_t>(lod.size()) });
+                                    lod_indices.insert(lod_indices.end(), lod.begin(), lod.end());
+                                }
+                                index_data = packIndices(lod_indices, submesh->m_index_type);
+                            }
+                        }
+
+                        if(geometry_arena) {
+                            geometry_arena->addIndices(*submesh, index_data, submesh->m_index_type);
+                        }
+                        else {
+                            submesh->m_index_buffer = std::make_unique<Buffer>(
+                                uploader.upload(index_data, vk::BufferUsageFlagBits::eIndexBuffer | additional_buffer_usage_flags));
+                            submesh->m_index_buffer->setDebugName(fmt::format("'{}' mesh, primitive #{}: index buffer",
+                                gltf_mesh.name, i_primitive));
+                        }
                     }
                     else {
                         submesh->m_vertices_count = static_cast<uint32_t>(getAttributeSize(&m_model, gltf_primitive.attributes.at("POSITION")));
@@ -713,6 +763,13 @@ namespace frame {
     
                 scene.addComponent(std::move(mesh));
             }
+
+            if(geometry_arena) {
+                geometry_arena->upload(uploader, additional_buffer_usage_flags);
+                scene.addComponent(std::move(geometry_arena));
+            }
+
+            uploader.flush();
     
             m_device.getFencePool().wait();
             m_device.getFencePool().reset();
@@ -1072,8 +1129,16 @@ namespace frame {
                 submesh->m_index_type = vk::IndexType::eUint32;
     
                 if(storage_buffer) {
+                    std::vector<glm::vec3> positions(aligned_vertex_data.size());
+                    std::transform(aligned_vertex_data.begin(), aligned_vertex_data.end(), positions.begin(),
+                        [](const AlignedVertex& vertex) { return glm::vec3(vertex.pos); });
+
+                    std::vector<uint32_t> indices(submesh->m_vertex_indices);
+                    std::memcpy(indices.data(), index_data.data(), indices.size() * sizeof(uint32_t));
+
                     std::vector<Meshlet> meshlets;
-                    prepareMeshlets(meshlets, submesh, index_data);
+                    std::vector<MeshletBounds> meshlet_bounds;
+                    buildMeshlets(positions, indices, meshlets, meshlet_bounds);
                     
                     submesh->m_vertex_indices = static_cast<uint32_t>(meshlets.size());
     
@@ -1086,6 +1151,16 @@ namespace frame {
     
                     command_buffer.copyBuffer(stage_buffer, *submesh->m_index_buffer, meshlets.size() * sizeof(Meshlet));
                     transient_buffers.push_back(std::move(stage_buffer));
+
+                    Buffer bounds_stage_buffer = Buffer::createStagingBuffer(m_device, meshlet_bounds);
+
+                    submesh->m_meshlet_bounds_buffer = std::make_unique<Buffer>(m_device,
+                        meshlet_bounds.size() * sizeof(MeshletBounds),
+                        vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eStorageBuffer,
+                        VMA_MEMORY_USAGE_GPU_ONLY);
+
+                    command_buffer.copyBuffer(bounds_stage_buffer, *submesh->m_meshlet_bounds_buffer, meshlet_bounds.size() * sizeof(MeshletBounds));
+                    transient_buffers.push_back(std::move(bounds_stage_buffer));
                 }
                 else {
                     Buffer stage_buffer = Buffer::createStagingBuffer(m_device, index_data);
@@ -34,6 +34,8 @@
 
 #include "glm/glm.hpp"
 
+#include "common/meshlet_builder.h"
+
 #define KHR_LIGHTS_PUNCTUAL_EXTENSION "KHR_lights_punctual"
 #define KHR_MATERIALS_UNLIT_EXTENSION          "KHR_materials_unlit"
 #define KHR_TEXTURE_TRANSFORM_EXTENSION        "KHR_texture_transform"
@@ -78,14 +80,6 @@ namespace frame {
             glm::vec4 normal;
         };
 
-        struct Meshlet
-        {
-            uint32_t vertices[64];
-            uint32_t indices[126];
-            uint32_t vertex_count;
-            uint32_t index_count;
-        };
-
         template <class T, class Y>
         struct TypeCast {
             Y operator()(T value) const noexcept {
@@ -101,7 +95,9 @@ namespace frame {
             std::unique_ptr<scene::Scene> readSceneFromFile(
                 const std::string& file_name,
                 int scene_index = -1,
-                vk::BufferUsageFlags additional_buffer_usage_flags = {});
+                vk::BufferUsageFlags additional_buffer_usage_flags = {},
+                bool pack_geometry = false,
+                bool generate_lods = false);
 
             std::unique_ptr<scene::SubMesh> readModelFromFile(
                 const std::string& file_name,
@@ -133,7 +129,7 @@ namespace frame {
             static std::unordered_map<std::string, bool> m_supported_extensions;
 
         private:
-            scene::Scene loadScene(int scene_index = -1, vk::BufferUsageFlags additional_buffer_usage_flags = {});
+            scene::Scene loadScene(int scene_index = -1, vk::BufferUsageFlags additional_buffer_usage_flags = {}, bool pack_geometry = false, bool generate_lods = false);
             std::unique_ptr<scene::SubMesh> loadModel(uint32_t index, bool storage_buffer = false, vk::BufferUsageFlags additional_buffer_usage_flags = {});
         };
     }
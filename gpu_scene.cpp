@@ -0,0 +1,513 @@
+/* Copyright (c) 2025, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "rendering/gpu_scene.h"
+
+#include <algorithm>
+#include <cassert>
+
+#include "core/command_buffer.h"
+#include "rendering/depth_pyramid.h"
+#include "rendering/render_context.h"
+#include "scene/components/material/material.h"
+#include "scene/components/mesh/mesh.h"
+#include "scene/components/mesh/sub_mesh.h"
+#include "scene/frustum.h"
+#include "scene/node.h"
+
+namespace frame {
+	namespace rendering {
+		GpuScene::GpuScene(RenderContext& render_context, core::ShaderSource&& cull_shader, const std::vector<scene::Mesh*>& meshes) :
+			m_render_context{ render_context },
+			m_cull_shader{ std::move(cull_shader) },
+			m_meshes{ meshes }
+		{
+			m_occlusion_variant.addDefine("OCCLUSION_PHASE");
+			m_compact_variant.addDefine("COMPACT_DRAWS");
+		}
+
+		void GpuScene::prepare() {
+			auto& device = m_render_context.getDevice();
+
+			m_resident_meshes.assign(m_meshes.size(), 0);
+			m_draws.clear();
+			m_instances.clear();
+			m_instance_nodes.clear();
+
+			m_batches.clear();
+
+			// Draws are grouped by everything bound between them so each group is one multi-draw
+			struct PendingDraw {
+				Draw draw;
+				scene::Mesh* mesh;
+			};
+			std::vector<PendingDraw> pending_draws;
+
+			for (size_t mesh_index = 0; mesh_index < m_meshes.size(); mesh_index++) {
+				auto& mesh = m_meshes[mesh_index];
+				auto& sub_meshes = mesh->getSubmeshes();
+
+				bool resident = !mesh->getNodes().empty() && std::all_of(sub_meshes.begin(), sub_meshes.end(), [](scene::SubMesh* sub_mesh) {
+					return sub_mesh->m_vertex_indices != 0 && sub_mesh->getMaterial()->m_alpha_mode != scene::AlphaMode::Blend;
+				});
+
+				for (auto& node : mesh->getNodes()) {
+					const auto& scale = node->getTransform().getScale();
+					resident = resident && scale.x * scale.y * scale.z >= 0;
+				}
+
+				if (!resident) {
+					continue;
+				}
+
+				m_resident_meshes[mesh_index] = 1;
+
+				for (auto& sub_mesh : sub_meshes) {
+					core::ShaderVariant shader_variant = sub_mesh->getShaderVariant();
+					shader_variant.addDefine("GPU_DRIVEN");
+					pending_draws.push_back({ { sub_mesh, std::move(shader_variant) }, mesh });
+				}
+			}
+
+			if (pending_draws.empty()) {
+				return;
+			}
+
+			std::stable_sort(pending_draws.begin(), pending_draws.end(), [](const PendingDraw& lhs, const PendingDraw& rhs) {
+				return getBatchKey(lhs.draw) < getBatchKey(rhs.draw);
+			});
+
+			std::vector<vk::DrawIndexedIndirectCommand> draw_commands;
+			// Batch of every draw and the first draw of that batch, read by the COMPACT_DRAWS pass
+			std::vector<glm::uvec2> draw_batches;
+
+			for (auto& pending_draw : pending_draws) {
+				auto* sub_mesh = pending_draw.draw.sub_mesh;
+				uint32_t draw_index = static_cast<uint32_t>(m_draws.size());
+
+				if (m_batches.empty() || getBatchKey(m_draws[m_batches.back().first_draw]) != getBatchKey(pending_draw.draw)) {
+					m_batches.push_back({ draw_index, 0 });
+				}
+				m_batches.back().draw_count++;
+				draw_batches.push_back(glm::uvec2(m_batches.size() - 1, m_batches.back().first_draw));
+
+				m_draws.push_back(std::move(pending_draw.draw));
+
+				vk::DrawIndexedIndirectCommand draw_command{};
+				draw_command.indexCount = sub_mesh->m_vertex_indices;
+				draw_command.firstIndex = sub_mesh->m_first_index;
+				draw_command.vertexOffset = sub_mesh->m_vertex_offset;
+				draw_command.firstInstance = static_cast<uint32_t>(m_instances.size());
+				draw_commands.push_back(draw_command);
+
+				const scene::AABB& bounds = pending_draw.mesh->getBounds();
+				bool has_bounds = glm::all(glm::lessThanEqual(bounds.getMin(), bounds.getMax()));
+
+				for (auto& node : pending_draw.mesh->getNodes()) {
+					GpuInstance instance{};
+					instance.bounds_center = glm::vec4(bounds.getCenter(), has_bounds ? 1.0f : 0.0f);
+					instance.bounds_extent = glm::vec4(bounds.getScale() * 0.5f, 0.0f);
+					instance.draw_info = glm::uvec4(draw_index, 0, 0, 0);
+
+					m_instances.push_back(instance);
+					m_instance_nodes.push_back(node);
+				}
+			}
+
+			vk::DeviceSize draws_size = draw_commands.size() * sizeof(vk::DrawIndexedIndirectCommand);
+
+			m_draw_template_buffer = std::make_unique<common::Buffer>(device, draws_size,
+				vk::BufferUsageFlagBits::eTransferSrc, VMA_MEMORY_USAGE_CPU_TO_GPU);
+			m_draw_template_buffer->update(draw_commands);
+
+			m_indirect_buffer = std::make_unique<common::Buffer>(device, draws_size,
+				vk::BufferUsageFlagBits::eIndirectBuffer | vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferDst,
+				VMA_MEMORY_USAGE_GPU_ONLY);
+
+			m_visible_instance_buffer = std::make_unique<common::Buffer>(device, m_instances.size() * sizeof(uint32_t),
+				vk::BufferUsageFlagBits::eStorageBuffer, VMA_MEMORY_USAGE_GPU_ONLY);
+
+			m_late_indirect_buffer = std::make_unique<common::Buffer>(device, draws_size,
+				vk::BufferUsageFlagBits::eIndirectBuffer | vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferDst,
+				VMA_MEMORY_USAGE_GPU_ONLY);
+
+			m_late_visible_instance_buffer = std::make_unique<common::Buffer>(device, m_instances.size() * sizeof(uint32_t),
+				vk::BufferUsageFlagBits::eStorageBuffer, VMA_MEMORY_USAGE_GPU_ONLY);
+
+			m_visibility_buffer = std::make_unique<common::Buffer>(device, m_instances.size() * sizeof(uint32_t),
+				vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferDst, VMA_MEMORY_USAGE_GPU_ONLY);
+			m_visibility_reset = true;
+
+			m_draw_count = device.isEnabled(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+			if (m_draw_count) {
+				vk::DeviceSize counts_size = m_batches.size() * sizeof(uint32_t);
+
+				m_draw_batch_buffer = std::make_unique<common::Buffer>(device, draw_batches.size() * sizeof(glm::uvec2),
+					vk::BufferUsageFlagBits::eStorageBuffer, VMA_MEMORY_USAGE_CPU_TO_GPU);
+				m_draw_batch_buffer->update(draw_batches);
+
+				m_compact_indirect_buffer = std::make_unique<common::Buffer>(device, draws_size,
+					vk::BufferUsageFlagBits::eIndirectBuffer | vk::BufferUsageFlagBits::eStorageBuffer, VMA_MEMORY_USAGE_GPU_ONLY);
+				m_draw_count_buffer = std::make_unique<common::Buffer>(device, counts_size,
+					vk::BufferUsageFlagBits::eIndirectBuffer | vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferDst,
+					VMA_MEMORY_USAGE_GPU_ONLY);
+
+				m_late_compact_indirect_buffer = std::make_unique<common::Buffer>(device, draws_size,
+					vk::BufferUsageFlagBits::eIndirectBuffer | vk::BufferUsageFlagBits::eStorageBuffer, VMA_MEMORY_USAGE_GPU_ONLY);
+				m_late_draw_count_buffer = std::make_unique<common::Buffer>(device, counts_size,
+					vk::BufferUsageFlagBits::eIndirectBuffer | vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferDst,
+					VMA_MEMORY_USAGE_GPU_ONLY);
+			}
+
+			m_instance_buffers.clear();
+			createFrameBuffers();
+		}
+
+		GpuScene::BatchKey GpuScene::getBatchKey(const Draw& draw) {
+			auto& sub_mesh = *draw.sub_mesh;
+
+			// Submeshes outside an arena bind their own vertex buffers and only batch with themselves
+			const void* vertex_source = sub_mesh.m_vertex_arena ? static_cast<const void*>(sub_mesh.m_vertex_arena) : static_cast<const void*>(&sub_mesh);
+
+			return std::make_tuple(draw.shader_variant.getId(), static_cast<const void*>(sub_mesh.getMaterial()), vertex_source,
+				static_cast<const void*>(&sub_mesh.getIndexBuffer()), sub_mesh.m_index_offset, static_cast<uint32_t>(sub_mesh.m_index_type));
+		}
+
+		void GpuScene::compactDraws(core::CommandBuffer& command_buffer, const common::Buffer& draw_buffer, const common::Buffer& compact_buffer,
+			const common::Buffer& count_buffer) {
+			// The previous frame's draws have consumed the compacted commands and counts
+			common::BufferMemoryBarrier reset_barrier{};
+			reset_barrier.m_src_stage_mask = vk::PipelineStageFlagBits::eDrawIndirect;
+			reset_barrier.m_dst_stage_mask = vk::PipelineStageFlagBits::eTransfer | vk::PipelineStageFlagBits::eComputeShader;
+			command_buffer.bufferMemoryBarrier(compact_buffer, 0, VK_WHOLE_SIZE, reset_barrier);
+			command_buffer.bufferMemoryBarrier(count_buffer, 0, VK_WHOLE_SIZE, reset_barrier);
+
+			command_buffer.getHandle().fillBuffer(count_buffer.getHandle(), 0, VK_WHOLE_SIZE, 0);
+
+			common::BufferMemoryBarrier clear_barrier{};
+			clear_barrier.m_src_stage_mask = vk::PipelineStageFlagBits::eTransfer;
+			clear_barrier.m_dst_stage_mask = vk::PipelineStageFlagBits::eComputeShader;
+			clear_barrier.m_src_access_mask = vk::AccessFlagBits::eTransferWrite;
+			clear_barrier.m_dst_access_mask = vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite;
+			command_buffer.bufferMemoryBarrier(count_buffer, 0, VK_WHOLE_SIZE, clear_barrier);
+
+			common::BufferMemoryBarrier draws_barrier{};
+			draws_barrier.m_src_stage_mask = vk::PipelineStageFlagBits::eComputeShader;
+			draws_barrier.m_dst_stage_mask = vk::PipelineStageFlagBits::eComputeShader;
+			draws_barrier.m_src_access_mask = vk::AccessFlagBits::eShaderWrite;
+			draws_barrier.m_dst_access_mask = vk::AccessFlagBits::eShaderRead;
+			command_buffer.bufferMemoryBarrier(draw_buffer, 0, VK_WHOLE_SIZE, draws_barrier);
+
+			GpuCullUniform cull_uniform{};
+			cull_uniform.draw_count = static_cast<uint32_t>(m_draws.size());
+
+			auto allocation = m_render_context.getActiveFrame().allocateBuffer(vk::BufferUsageFlagBits::eUniformBuffer, sizeof(GpuCullUniform));
+			allocation.update(cull_uniform);
+
+			auto& resource_cache = m_render_context.getDevice().getResourceCache();
+			auto& compact_module = resource_cache.requestShaderModule(vk::ShaderStageFlagBits::eCompute, m_cull_shader, m_compact_variant);
+			auto& pipeline_layout = resource_cache.requestPipelineLayout({ &compact_module });
+
+			command_buffer.bindPipelineLayout(pipeline_layout);
+			command_buffer.bindBuffer(allocation.getBuffer(), allocation.getOffset(), allocation.getSize(), 0, 0, 0);
+			command_buffer.bindBuffer(draw_buffer, 0, draw_buffer.getSize(), 0, 2, 0);
+			command_buffer.bindBuffer(*m_draw_batch_buffer, 0, m_draw_batch_buffer->getSize(), 0, 7, 0);
+			command_buffer.bindBuffer(compact_buffer, 0, compact_buffer.getSize(), 0, 8, 0);
+			command_buffer.bindBuffer(count_buffer, 0, count_buffer.getSize(), 0, 9, 0);
+
+			command_buffer.dispatch((cull_uniform.draw_count + CULL_WORKGROUP_SIZE - 1) / CULL_WORKGROUP_SIZE, 1, 1);
+
+			common::BufferMemoryBarrier compact_barrier{};
+			compact_barrier.m_src_stage_mask = vk::PipelineStageFlagBits::eComputeShader;
+			compact_barrier.m_dst_stage_mask = vk::PipelineStageFlagBits::eDrawIndirect;
+			compact_barrier.m_src_access_mask = vk::AccessFlagBits::eShaderWrite;
+			compact_barrier.m_dst_access_mask = vk::AccessFlagBits::eIndirectCommandRead;
+			command_buffer.bufferMemoryBarrier(compact_buffer, 0, VK_WHOLE_SIZE, compact_barrier);
+			command_buffer.bufferMemoryBarrier(count_buffer, 0, VK_WHOLE_SIZE, compact_barrier);
+		}
+
+		void GpuScene::createFrameBuffers() {
+			auto& device = m_render_context.getDevice();
+			const size_t frame_count = m_render_context.getRenderFrames().size();
+
+			// The frame count follows the swapchain image count and can grow after prepare(), earlier frames may still use the buffers
+			if (!m_instance_buffers.empty()) {
+				device.getHandle().waitIdle();
+			}
+
+			m_occlusion_stats_buffers.clear();
+			m_occlusion_stats_pending.assign(frame_count, 0);
+			for (size_t i = 0; i < frame_count; i++) {
+				m_occlusion_stats_buffers.push_back(std::make_unique<common::Buffer>(device, sizeof(uint32_t),
+					vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferDst, VMA_MEMORY_USAGE_GPU_TO_CPU));
+			}
+
+			m_instance_buffers.clear();
+			for (size_t i = 0; i < frame_count; i++) {
+				m_instance_buffers.push_back(std::make_unique<common::Buffer>(device, m_instances.size() * sizeof(GpuInstance),
+					vk::BufferUsageFlagBits::eStorageBuffer, VMA_MEMORY_USAGE_CPU_TO_GPU));
+			}
+		}
+
+		void GpuScene::updateInstances() {
+			if (m_instance_buffers.size() != m_render_context.getRenderFrames().size()) {
+				createFrameBuffers();
+			}
+
+			for (size_t i = 0; i < m_instances.size(); i++) {
+				glm::mat4 model = m_instance_nodes[i]->getTransform().getWorldMatrix();
+
+				m_instances[i].model = model;
+				m_instances[i].normal_matrix = glm::mat4(glm::transpose(glm::inverse(glm::mat3(model))));
+			}
+
+			m_active_instance_buffer = m_render_context.getActiveFrameIndex();
+			m_instance_buffers[m_active_instance_buffer]->update(m_instances);
+		}
+
+		GpuCullUniform GpuScene::makeCullUniform(const scene::Frustum& frustum, bool frustum_culling) const {
+			GpuCullUniform cull_uniform{};
+			std::copy(frustum.getPlanes().begin(), frustum.getPlanes().end(), cull_uniform.frustum_planes);
+			cull_uniform.instance_count = static_cast<uint32_t>(m_instances.size());
+			cull_uniform.frustum_culling = frustum_culling ? 1 : 0;
+			cull_uniform.occlusion_culling = m_occlusion_culling ? 1 : 0;
+
+			return cull_uniform;
+		}
+
+		void GpuScene::cull(core::CommandBuffer& command_buffer, const scene::Frustum& frustum, bool frustum_culling) {
+			if (m_draws.empty()) {
+				return;
+			}
+
+			updateInstances();
+
+			common::BufferMemoryBarrier reset_barrier{};
+			reset_barrier.m_src_stage_mask = vk::PipelineStageFlagBits::eDrawIndirect | vk::PipelineStageFlagBits::eVertexShader;
+			reset_barrier.m_dst_stage_mask = vk::PipelineStageFlagBits::eTransfer | vk::PipelineStageFlagBits::eComputeShader;
+			command_buffer.bufferMemoryBarrier(*m_indirect_buffer, 0, VK_WHOLE_SIZE, reset_barrier);
+			command_buffer.bufferMemoryBarrier(*m_visible_instance_buffer, 0, VK_WHOLE_SIZE, reset_barrier);
+
+			command_buffer.copyBuffer(*m_draw_template_buffer, *m_indirect_buffer, m_draw_template_buffer->getSize());
+
+			// Every instance counts as visible until phase 2 has tested it
+			if (m_visibility_reset) {
+				command_buffer.getHandle().fillBuffer(m_visibility_buffer->getHandle(), 0, VK_WHOLE_SIZE, 1);
+			}
+
+			common::BufferMemoryBarrier copy_barrier{};
+			copy_barrier.m_src_stage_mask = vk::PipelineStageFlagBits::eTransfer;
+			copy_barrier.m_dst_stage_mask = vk::PipelineStageFlagBits::eComputeShader;
+			copy_barrier.m_src_access_mask = vk::AccessFlagBits::eTransferWrite;
+			copy_barrier.m_dst_access_mask = vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite;
+			command_buffer.bufferMemoryBarrier(*m_indirect_buffer, 0, VK_WHOLE_SIZE, copy_barrier);
+
+			if (m_visibility_reset) {
+				command_buffer.bufferMemoryBarrier(*m_visibility_buffer, 0, VK_WHOLE_SIZE, copy_barrier);
+				m_visibility_reset = false;
+			}
+
+			GpuCullUniform cull_uniform = makeCullUniform(frustum, frustum_culling);
+
+			auto allocation = m_render_context.getActiveFrame().allocateBuffer(vk::BufferUsageFlagBits::eUniformBuffer, sizeof(GpuCullUniform));
+			allocation.update(cull_uniform);
+
+			auto& resource_cache = m_render_context.getDevice().getResourceCache();
+			auto& cull_module = resource_cache.requestShaderModule(vk::ShaderStageFlagBits::eCompute, m_cull_shader);
+			auto& pipeline_layout = resource_cache.requestPipelineLayout({ &cull_module });
+
+			command_buffer.bindPipelineLayout(pipeline_layout);
+			command_buffer.bindBuffer(allocation.getBuffer(), allocation.getOffset(), allocation.getSize(), 0, 0, 0);
+			command_buffer.bindBuffer(getInstanceBuffer(), 0, getInstanceBuffer().getSize(), 0, 1, 0);
+			command_buffer.bindBuffer(*m_indirect_buffer, 0, m_indirect_buffer->getSize(), 0, 2, 0);
+			command_buffer.bindBuffer(*m_visible_instance_buffer, 0, m_visible_instance_buffer->getSize(), 0, 3, 0);
+			command_buffer.bindBuffer(*m_visibility_buffer, 0, m_visibility_buffer->getSize(), 0, 4, 0);
+
+			command_buffer.dispatch((cull_uniform.instance_count + CULL_WORKGROUP_SIZE - 1) / CULL_WORKGROUP_SIZE, 1, 1);
+
+			common::BufferMemoryBarrier cull_barrier{};
+			cull_barrier.m_src_stage_mask = vk::PipelineStageFlagBits::eComputeShader;
+			cull_barrier.m_dst_stage_mask = vk::PipelineStageFlagBits::eDrawIndirect | vk::PipelineStageFlagBits::eVertexShader;
+			cull_barrier.m_src_access_mask = vk::AccessFlagBits::eShaderWrite;
+			cull_barrier.m_dst_access_mask = vk::AccessFlagBits::eIndirectCommandRead | vk::AccessFlagBits::eShaderRead;
+			command_buffer.bufferMemoryBarrier(*m_indirect_buffer, 0, VK_WHOLE_SIZE, cull_barrier);
+			command_buffer.bufferMemoryBarrier(*m_visible_instance_buffer, 0, VK_WHOLE_SIZE, cull_barrier);
+
+			if (m_draw_count) {
+				compactDraws(command_buffer, *m_indirect_buffer, *m_compact_indirect_buffer, *m_draw_count_buffer);
+			}
+		}
+
+		void GpuScene::testOcclusion(core::CommandBuffer& command_buffer, const scene::Frustum& frustum, const glm::mat4& view_proj, const DepthPyramid& depth_pyramid) {
+			if (m_draws.empty() || !m_occlusion_culling) {
+				return;
+			}
+
+			size_t stats_index = m_render_context.getActiveFrameIndex() % m_occlusion_stats_buffers.size();
+			auto& stats_buffer = *m_occlusion_stats_buffers[stats_index];
+
+			// The frame that last wrote this counter has been waited on before its slot is reused
+			if (m_occlusion_stats_pending[stats_index]) {
+				uint32_t occluded_count = *reinterpret_cast<const uint32_t*>(stats_buffer.map());
+				stats_buffer.unmap();
+
+				m_render_context.addFrameCounter(stats::StatIndex::scene_occluded_draws, static_cast<double>(occluded_count));
+			}
+
+			// The late draws of the previous frame have been consumed
+			common::BufferMemoryBarrier reset_barrier{};
+			reset_barrier.m_src_stage_mask = vk::PipelineStageFlagBits::eDrawIndirect | vk::PipelineStageFlagBits::eVertexShader;
+			reset_barrier.m_dst_stage_mask = vk::PipelineStageFlagBits::eTransfer | vk::PipelineStageFlagBits::eComputeShader;
+			command_buffer.bufferMemoryBarrier(*m_late_indirect_buffer, 0, VK_WHOLE_SIZE, reset_barrier);
+			command_buffer.bufferMemoryBarrier(*m_late_visible_instance_buffer, 0, VK_WHOLE_SIZE, reset_barrier);
+
+			command_buffer.copyBuffer(*m_draw_template_buffer, *m_late_indirect_buffer, m_draw_template_buffer->getSize());
+			command_buffer.getHandle().fillBuffer(stats_buffer.getHandle(), 0, VK_WHOLE_SIZE, 0);
+
+			common::BufferMemoryBarrier clear_barrier{};
+			clear_barrier.m_src_stage_mask = vk::PipelineStageFlagBits::eTransfer;
+			clear_barrier.m_dst_stage_mask = vk::PipelineStageFlagBits::eComputeShader;
+			clear_barrier.m_src_access_mask = vk::AccessFlagBits::eTransferWrite;
+			clear_barrier.m_dst_access_mask = vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite;
+			command_buffer.bufferMemoryBarrier(stats_buffer, 0, VK_WHOLE_SIZE, clear_barrier);
+			command_buffer.bufferMemoryBarrier(*m_late_indirect_buffer, 0, VK_WHOLE_SIZE, clear_barrier);
+
+			// Phase 1 has read the flags this pass rewrites
+			common::BufferMemoryBarrier visibility_barrier{};
+			visibility_barrier.m_src_stage_mask = vk::PipelineStageFlagBits::eComputeShader;
+			visibility_barrier.m_dst_stage_mask = vk::PipelineStageFlagBits::eComputeShader;
+			visibility_barrier.m_dst_access_mask = vk::AccessFlagBits::eShaderWrite;
+			command_buffer.bufferMemoryBarrier(*m_visibility_buffer, 0, VK_WHOLE_SIZE, visibility_barrier);
+
+			GpuCullUniform cull_uniform = makeCullUniform(frustum, true);
+			cull_uniform.view_proj = view_proj;
+			cull_uniform.pyramid_size = glm::vec2(depth_pyramid.getExtent().width, depth_pyramid.getExtent().height);
+			cull_uniform.pyramid_levels = depth_pyramid.getLevelCount();
+
+			auto allocation = m_render_context.getActiveFrame().allocateBuffer(vk::BufferUsageFlagBits::eUniformBuffer, sizeof(GpuCullUniform));
+			allocation.update(cull_uniform);
+
+			auto& resource_cache = m_render_context.getDevice().getResourceCache();
+			auto& occlusion_module = resource_cache.requestShaderModule(vk::ShaderStageFlagBits::eCompute, m_cull_shader, m_occlusion_variant);
+			auto& pipeline_layout = resource_cache.requestPipelineLayout({ &occlusion_module });
+
+			command_buffer.bindPipelineLayout(pipeline_layout);
+			command_buffer.bindBuffer(allocation.getBuffer(), allocation.getOffset(), allocation.getSize(), 0, 0, 0);
+			command_buffer.bindBuffer(getInstanceBuffer(), 0, getInstanceBuffer().getSize(), 0, 1, 0);
+			command_buffer.bindBuffer(*m_late_indirect_buffer, 0, m_late_indirect_buffer->getSize(), 0, 2, 0);
+			command_buffer.bindBuffer(*m_late_visible_instance_buffer, 0, m_late_visible_instance_buffer->getSize(), 0, 3, 0);
+			command_buffer.bindBuffer(*m_visibility_buffer, 0, m_visibility_buffer->getSize(), 0, 4, 0);
+			command_buffer.bindImage(depth_pyramid.getView(), depth_pyramid.getSampler(), 0, 5, 0);
+			command_buffer.bindBuffer(stats_buffer, 0, stats_buffer.getSize(), 0, 6, 0);
+
+			command_buffer.dispatch((cull_uniform.instance_count + CULL_WORKGROUP_SIZE - 1) / CULL_WORKGROUP_SIZE, 1, 1);
+
+			common::BufferMemoryBarrier test_barrier{};
+			test_barrier.m_src_stage_mask = vk::PipelineStageFlagBits::eComputeShader;
+			test_barrier.m_dst_stage_mask = vk::PipelineStageFlagBits::eComputeShader;
+			test_barrier.m_src_access_mask = vk::AccessFlagBits::eShaderWrite;
+			test_barrier.m_dst_access_mask = vk::AccessFlagBits::eShaderRead;
+			command_buffer.bufferMemoryBarrier(*m_visibility_buffer, 0, VK_WHOLE_SIZE, test_barrier);
+
+			common::BufferMemoryBarrier late_barrier{};
+			late_barrier.m_src_stage_mask = vk::PipelineStageFlagBits::eComputeShader;
+			late_barrier.m_dst_stage_mask = vk::PipelineStageFlagBits::eDrawIndirect | vk::PipelineStageFlagBits::eVertexShader;
+			late_barrier.m_src_access_mask = vk::AccessFlagBits::eShaderWrite;
+			late_barrier.m_dst_access_mask = vk::AccessFlagBits::eIndirectCommandRead | vk::AccessFlagBits::eShaderRead;
+			command_buffer.bufferMemoryBarrier(*m_late_indirect_buffer, 0, VK_WHOLE_SIZE, late_barrier);
+			command_buffer.bufferMemoryBarrier(*m_late_visible_instance_buffer, 0, VK_WHOLE_SIZE, late_barrier);
+
+			common::BufferMemoryBarrier host_barrier{};
+			host_barrier.m_src_stage_mask = vk::PipelineStageFlagBits::eComputeShader;
+			host_barrier.m_dst_stage_mask = vk::PipelineStageFlagBits::eHost;
+			host_barrier.m_src_access_mask = vk::AccessFlagBits::eShaderWrite;
+			host_barrier.m_dst_access_mask = vk::AccessFlagBits::eHostRead;
+			command_buffer.bufferMemoryBarrier(stats_buffer, 0, VK_WHOLE_SIZE, host_barrier);
+
+			if (m_draw_count) {
+				compactDraws(command_buffer, *m_late_indirect_buffer, *m_late_compact_indirect_buffer, *m_late_draw_count_buffer);
+			}
+
+			m_occlusion_stats_pending[stats_index] = 1;
+		}
+
+		void GpuScene::setOcclusionCulling(bool enable) {
+			// Flags left over from an earlier run would hide instances that were never tested
+			if (enable && !m_occlusion_culling) {
+				m_visibility_reset = true;
+			}
+
+			m_occlusion_culling = enable;
+		}
+
+		bool GpuScene::hasMesh(size_t mesh_index) const {
+			return mesh_index < m_resident_meshes.size() && m_resident_meshes[mesh_index];
+		}
+
+		const std::vector<GpuScene::Draw>& GpuScene::getDraws() const {
+			return m_draws;
+		}
+
+		const std::vector<GpuScene::DrawBatch>& GpuScene::getBatches() const {
+			return m_batches;
+		}
+
+		bool GpuScene::hasDrawCount() const {
+			return m_draw_count;
+		}
+
+		const common::Buffer& GpuScene::getIndirectBuffer() const {
+			assert(m_indirect_buffer && "[GpuScene] ASSERT: Scene has no indirect draws");
+			return m_draw_count ? *m_compact_indirect_buffer : *m_indirect_buffer;
+		}
+
+		const common::Buffer& GpuScene::getDrawCountBuffer() const {
+			assert(m_draw_count_buffer && "[GpuScene] ASSERT: Scene has no draw counts");
+			return *m_draw_count_buffer;
+		}
+
+		const std::vector<scene::Node*>& GpuScene::getInstanceNodes() const {
+			return m_instance_nodes;
+		}
+
+		const common::Buffer& GpuScene::getInstanceBuffer() const {
+			assert(!m_instance_buffers.empty() && "[GpuScene] ASSERT: Scene has no instances");
+			return *m_instance_buffers[m_active_instance_buffer];
+		}
+
+		const common::Buffer& GpuScene::getVisibleInstanceBuffer() const {
+			assert(m_visible_instance_buffer && "[GpuScene] ASSERT: Scene has no instances");
+			return *m_visible_instance_buffer;
+		}
+
+		const common::Buffer& GpuScene::getLateIndirectBuffer() const {
+			assert(m_late_indirect_buffer && "[GpuScene] ASSERT: Scene has no indirect draws");
+			return m_draw_count ? *m_late_compact_indirect_buffer : *m_late_indirect_buffer;
+		}
+
+		const common::Buffer& GpuScene::getLateDrawCountBuffer() const {
+			assert(m_late_draw_count_buffer && "[GpuScene] ASSERT: Scene has no draw counts");
+			return *m_late_draw_count_buffer;
+		}
+
+		const common::Buffer& GpuScene::getLateVisibleInstanceBuffer() const {
+			assert(m_late_visible_instance_buffer && "[GpuScene] ASSERT: Scene has no instances");
+			return *m_late_visible_instance_buffer;
+		}
+	}
+}
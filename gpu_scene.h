@@ -0,0 +1,182 @@
+/* Copyright (c) 2025, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include <memory>
+#include <tuple>
+#include <vector>
+
+#include "common/buffer.h"
+#include "core/shader_module.h"
+#include "global_common.h"
+
+namespace frame {
+	namespace core {
+		class CommandBuffer;
+	}
+
+	namespace scene {
+		class Frustum;
+		class Mesh;
+		class Node;
+		class SubMesh;
+	}
+
+	namespace rendering {
+		class DepthPyramid;
+		class RenderContext;
+
+		struct GpuInstance {
+			glm::mat4 model;
+			glm::mat4 normal_matrix;
+			glm::vec4 bounds_center;
+			glm::vec4 bounds_extent;
+			glm::uvec4 draw_info;
+		};
+
+		struct alignas(16) GpuCullUniform {
+			glm::mat4 view_proj;
+			glm::vec4 frustum_planes[6];
+			glm::vec2 pyramid_size;
+			uint32_t instance_count;
+			uint32_t frustum_culling;
+			uint32_t occlusion_culling;
+			uint32_t pyramid_levels;
+			uint32_t draw_count;
+		};
+
+		/*
+		 * Scene instances kept resident on the GPU for indirect drawing.
+		 * Every opaque indexed submesh gets one vk::DrawIndexedIndirectCommand whose instanceCount is
+		 * reset from a template each frame. The cull shader bumps it for every visible instance and
+		 * writes the instance id to visible_instances[firstInstance + slot].
+		 * Cull shader bindings (set 0): 0 GpuCullUniform, 1 instances, 2 draws, 3 visible_instances, 4 visibility.
+		 * Vertex shaders built with GPU_DRIVEN read instances[visible_instances[gl_InstanceIndex]].
+		 *
+		 * Occlusion culling runs in two phases. Phase 1 (cull) only draws instances whose visibility flag
+		 * was set by the previous frame. Phase 2 (testOcclusion) runs between the two rendering scopes of
+		 * the frame with the OCCLUSION_PHASE variant: it tests every instance against the depth pyramid of
+		 * the depth phase 1 produced, writes the visibility flags and counts occluded instances. Visible
+		 * instances whose flag was not set, the ones phase 1 skipped, are appended to the late draws the
+		 * same way phase 1 fills the regular ones, and are drawn in the same frame when the render pipeline
+		 * can split the subpass, otherwise phase 2 runs after the pass and the next phase 1 draws them. Instances outside the
+		 * frustum are flagged visible so they draw as soon as they enter it.
+		 * Phase 2 bindings (set 0): 0 GpuCullUniform, 1 instances, 2 late draws, 3 late visible_instances,
+		 * 4 visibility, 5 depth_pyramid, 6 occlusion_stats.
+		 *
+		 * Draws are ordered so that draws sharing a shader variant, material, vertex source and index buffer
+		 * form one DrawBatch, recorded as a single multi-draw. When VK_KHR_draw_indirect_count is enabled the
+		 * COMPACT_DRAWS variant runs after each phase over GpuCullUniform::draw_count draws: a draw with
+		 * instances is appended to its batch's range of the compacted draws, draw_batches holding its batch
+		 * index and the batch's first draw, and the batch's entry in the draw counts is incremented.
+		 * Compaction bindings (set 0): 0 GpuCullUniform, 2 draws, 7 draw_batches, 8 compacted draws, 9 draw counts.
+		 */
+		class GpuScene {
+		public:
+			static constexpr uint32_t CULL_WORKGROUP_SIZE = 64;
+
+			struct Draw {
+				scene::SubMesh* sub_mesh;
+				core::ShaderVariant shader_variant;
+			};
+
+			// Consecutive draws bound with the same state
+			struct DrawBatch {
+				uint32_t first_draw;
+				uint32_t draw_count;
+			};
+
+			GpuScene(RenderContext& render_context, core::ShaderSource&& cull_shader, const std::vector<scene::Mesh*>& meshes);
+
+			void prepare();
+
+			void cull(core::CommandBuffer& command_buffer, const scene::Frustum& frustum, bool frustum_culling = true);
+
+			void testOcclusion(core::CommandBuffer& command_buffer, const scene::Frustum& frustum, const glm::mat4& view_proj, const DepthPyramid& depth_pyramid);
+
+			void setOcclusionCulling(bool enable);
+
+			bool hasMesh(size_t mesh_index) const;
+			const std::vector<Draw>& getDraws() const;
+			const std::vector<DrawBatch>& getBatches() const;
+
+			// Draws are compacted and counted per batch on the GPU, the draw count buffers hold one uint32_t per batch
+			bool hasDrawCount() const;
+
+			const common::Buffer& getIndirectBuffer() const;
+			const common::Buffer& getDrawCountBuffer() const;
+			const common::Buffer& getInstanceBuffer() const;
+			const common::Buffer& getVisibleInstanceBuffer() const;
+
+			// Node of every instance, in instance id order
+			const std::vector<scene::Node*>& getInstanceNodes() const;
+
+			// Draws of the instances phase 2 found visible after phase 1 skipped them
+			const common::Buffer& getLateIndirectBuffer() const;
+			const common::Buffer& getLateDrawCountBuffer() const;
+			const common::Buffer& getLateVisibleInstanceBuffer() const;
+
+		private:
+			using BatchKey = std::tuple<size_t, const void*, const void*, const void*, uint32_t, uint32_t>;
+
+			static BatchKey getBatchKey(const Draw& draw);
+
+			void compactDraws(core::CommandBuffer& command_buffer, const common::Buffer& draw_buffer, const common::Buffer& compact_buffer,
+				const common::Buffer& count_buffer);
+
+			// Instance and occlusion stats buffers, one per frame
+			void createFrameBuffers();
+
+			void updateInstances();
+
+			GpuCullUniform makeCullUniform(const scene::Frustum& frustum, bool frustum_culling) const;
+
+			RenderContext& m_render_context;
+			core::ShaderSource m_cull_shader;
+			std::vector<scene::Mesh*> m_meshes;
+
+			std::vector<uint8_t> m_resident_meshes;
+			std::vector<Draw> m_draws;
+			std::vector<DrawBatch> m_batches;
+			std::vector<GpuInstance> m_instances;
+			std::vector<scene::Node*> m_instance_nodes;
+
+			std::vector<std::unique_ptr<common::Buffer>> m_instance_buffers;
+			std::unique_ptr<common::Buffer> m_draw_template_buffer;
+			std::unique_ptr<common::Buffer> m_indirect_buffer;
+			std::unique_ptr<common::Buffer> m_visible_instance_buffer;
+			std::unique_ptr<common::Buffer> m_late_indirect_buffer;
+			std::unique_ptr<common::Buffer> m_late_visible_instance_buffer;
+			std::unique_ptr<common::Buffer> m_visibility_buffer;
+			std::unique_ptr<common::Buffer> m_draw_batch_buffer;
+			std::unique_ptr<common::Buffer> m_compact_indirect_buffer;
+			std::unique_ptr<common::Buffer> m_draw_count_buffer;
+			std::unique_ptr<common::Buffer> m_late_compact_indirect_buffer;
+			std::unique_ptr<common::Buffer> m_late_draw_count_buffer;
+			std::vector<std::unique_ptr<common::Buffer>> m_occlusion_stats_buffers;
+			std::vector<uint8_t> m_occlusion_stats_pending;
+			size_t m_active_instance_buffer{ 0 };
+			bool m_visibility_reset{ true };
+			bool m_occlusion_culling{ false };
+			bool m_draw_count{ false };
+			core::ShaderVariant m_occlusion_variant;
+			core::ShaderVariant m_compact_variant;
+		};
+	}
+}
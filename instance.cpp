@@ -354,7 +354,7 @@ namespace frame {
                     const auto& queue_families = gpu->getQueueFamilyProperties();
 
                     for (uint32_t i = 0; i < queue_families.size(); i++) {
-                        if (gpu->getHandle().getSurfaceSupportKHR(i, surface)) {
+                        if (!surface || gpu->getHandle().getSurfaceSupportKHR(i, surface)) {
                             return *gpu;
                         }
                     }
@@ -0,0 +1,215 @@
+/* Copyright (c) 2025, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "rendering/light_clusters.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
+#include "core/command_buffer.h"
+#include "core/queue.h"
+#include "rendering/render_context.h"
+#include "scene/components/camera/camera.h"
+#include "scene/components/camera/orthographic_camera.h"
+#include "scene/components/camera/perspective_camera.h"
+#include "scene/components/light.h"
+
+namespace frame {
+	namespace rendering {
+		namespace {
+			constexpr uint32_t CLUSTER_COUNT = LightClusters::GRID_SIZE_X * LightClusters::GRID_SIZE_Y * LightClusters::GRID_SIZE_Z;
+
+			// The exponential slices need a positive near plane, orthographic cameras default to 0
+			constexpr float MIN_NEAR_PLANE = 0.01f;
+
+			// Slices of cameras without near and far planes
+			const glm::vec2 DEFAULT_DEPTH_RANGE{ 0.1f, 1000.0f };
+
+			glm::vec2 getDepthRange(scene::Camera& camera) {
+				glm::vec2 depth_range = DEFAULT_DEPTH_RANGE;
+
+				if (auto perspective_camera = dynamic_cast<scene::PerspectiveCamera*>(&camera)) {
+					depth_range = { perspective_camera->getNearPlane(), perspective_camera->getFarPlane() };
+				}
+				else if (auto orthographic_camera = dynamic_cast<scene::OrthographicCamera*>(&camera)) {
+					depth_range = { orthographic_camera->getNearPlane(), orthographic_camera->getFarPlane() };
+				}
+
+				depth_range.x = std::max(depth_range.x, MIN_NEAR_PLANE);
+				depth_range.y = std::max(depth_range.y, depth_range.x * 2.0f);
+				return depth_range;
+			}
+		}
+
+		LightClusters::LightClusters(RenderContext& render_context, core::ShaderSource&& cluster_shader, bool async_compute) :
+			m_render_context{ render_context },
+			m_cluster_shader{ std::move(cluster_shader) },
+			m_async_compute{ async_compute }
+		{
+			addDefinitions(m_cluster_variant);
+			m_cluster_variant.addDefinitions(light_type_definitions);
+		}
+
+		bool LightClusters::isAsyncCompute() const {
+			return m_async_compute;
+		}
+
+		common::Buffer& LightClusters::getClusterBuffer() {
+			// Async updates may run while the previous frame is still lighting, so they write the buffer of their own frame
+			const size_t buffer_count = m_async_compute ? m_render_context.getRenderFrames().size() : 1;
+
+			if (m_cluster_buffers.size() != buffer_count) {
+				std::vector<uint32_t> queue_family_indices = getQueueFamilyIndices();
+
+				// The frame count can grow with the swapchain image count while earlier frames still read the buffers
+				if (!m_cluster_buffers.empty()) {
+					m_render_context.getDevice().getHandle().waitIdle();
+				}
+				m_cluster_buffers.clear();
+				for (size_t i = 0; i < buffer_count; ++i) {
+					m_cluster_buffers.push_back(std::make_unique<common::Buffer>(m_render_context.getDevice(),
+						CLUSTER_COUNT * (1 + MAX_LIGHTS_PER_CLUSTER) * sizeof(uint32_t),
+						vk::BufferUsageFlagBits::eStorageBuffer, VMA_MEMORY_USAGE_GPU_ONLY,
+						VMA_ALLOCATION_CREATE_MAPPED_BIT | VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT, queue_family_indices));
+					m_cluster_buffers.back()->setDebugName("light clusters");
+				}
+			}
+
+			return *m_cluster_buffers[m_async_compute ? m_render_context.getActiveFrameIndex() : 0];
+		}
+
+		std::vector<uint32_t> LightClusters::getQueueFamilyIndices() const {
+			if (!m_async_compute || !m_render_context.hasAsyncCompute()) {
+				return {};
+			}
+
+			return {
+				m_render_context.getDevice().getSuitableGraphicsQueue().getFamilyIndex(),
+				m_render_context.getComputeQueue().getFamilyIndex() };
+		}
+
+		common::BufferAllocation LightClusters::allocateShared(std::vector<std::unique_ptr<common::Buffer>>& buffers, vk::BufferUsageFlags usage, vk::DeviceSize size) {
+			buffers.resize(m_render_context.getRenderFrames().size());
+
+			// Only this frame's buffer is replaced, the frame has finished on the GPU
+			auto& buffer = buffers[m_render_context.getActiveFrameIndex()];
+			if (!buffer || buffer->getSize() < size) {
+				buffer = std::make_unique<common::Buffer>(m_render_context.getDevice(), size, usage, VMA_MEMORY_USAGE_CPU_TO_GPU,
+					VMA_ALLOCATION_CREATE_MAPPED_BIT | VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT, getQueueFamilyIndices());
+			}
+
+			return common::BufferAllocation{ *buffer, size, 0 };
+		}
+
+		void LightClusters::addDefinitions(core::ShaderVariant& variant) const {
+			variant.addDefinitions({
+				"CLUSTERED_LIGHTING",
+				"CLUSTER_GRID_X " + std::to_string(GRID_SIZE_X),
+				"CLUSTER_GRID_Y " + std::to_string(GRID_SIZE_Y),
+				"CLUSTER_GRID_Z " + std::to_string(GRID_SIZE_Z),
+				"CLUSTER_MAX_LIGHTS " + std::to_string(MAX_LIGHTS_PER_CLUSTER) });
+		}
+
+		std::vector<scene::Light*> LightClusters::getDirectionalLights(const std::vector<scene::Light*>& scene_lights) {
+			std::vector<scene::Light*> directional_lights;
+			std::copy_if(scene_lights.begin(), scene_lights.end(), std::back_inserter(directional_lights), [](scene::Light* light) {
+				return light->getLightType() == scene::LightType::Directional;
+			});
+
+			return directional_lights;
+		}
+
+		void LightClusters::update(core::CommandBuffer& command_buffer, const std::vector<scene::Light*>& scene_lights, scene::Camera& camera) {
+			m_lights.clear();
+
+			for (auto& scene_light : scene_lights) {
+				if (scene_light->getLightType() != scene::LightType::Point && scene_light->getLightType() != scene::LightType::Spot) {
+					continue;
+				}
+
+				m_lights.push_back(makeLight(*scene_light));
+			}
+
+			auto& render_frame = m_render_context.getActiveFrame();
+			const auto& extent = render_frame.getRenderTarget().getExtent();
+
+			glm::vec2 depth_range = getDepthRange(camera);
+			float slice_scale = GRID_SIZE_Z / std::log(depth_range.y / depth_range.x);
+
+			ClusterUniform cluster_uniform{};
+			cluster_uniform.view = camera.getView();
+			cluster_uniform.inverse_projection = glm::inverse(camera.getPreRotation() * vulkanStyleProjection(camera.getProjection()));
+			cluster_uniform.grid_size = glm::uvec4(GRID_SIZE_X, GRID_SIZE_Y, GRID_SIZE_Z, static_cast<uint32_t>(m_lights.size()));
+			cluster_uniform.depth_params = glm::vec4(depth_range, slice_scale, -std::log(depth_range.x) * slice_scale);
+			cluster_uniform.tile_size = glm::vec2(static_cast<float>(extent.width) / GRID_SIZE_X, static_cast<float>(extent.height) / GRID_SIZE_Y);
+
+			// An empty storage range cannot be bound, keep one unused entry
+			vk::DeviceSize light_size = std::max<size_t>(m_lights.size(), 1) * sizeof(Light);
+
+			// Frame pools use exclusive sharing, but the compute family reads these first and the graphics family after it
+			if (!getQueueFamilyIndices().empty()) {
+				m_uniform_allocation = allocateShared(m_uniform_buffers, vk::BufferUsageFlagBits::eUniformBuffer, sizeof(ClusterUniform));
+				m_light_allocation = allocateShared(m_light_buffers, vk::BufferUsageFlagBits::eStorageBuffer, light_size);
+			}
+			else {
+				m_uniform_allocation = render_frame.allocateBuffer(vk::BufferUsageFlagBits::eUniformBuffer, sizeof(ClusterUniform));
+				m_light_allocation = render_frame.allocateBuffer(vk::BufferUsageFlagBits::eStorageBuffer, light_size);
+			}
+
+			m_uniform_allocation.update(cluster_uniform);
+			if (!m_lights.empty()) {
+				m_light_allocation.getBuffer().update(m_lights, m_light_allocation.getOffset());
+			}
+
+			auto& cluster_buffer = getClusterBuffer();
+
+			// The previous frame's lighting may still be reading the clusters
+			if (!m_async_compute) {
+				common::BufferMemoryBarrier read_barrier{};
+				read_barrier.m_src_stage_mask = vk::PipelineStageFlagBits::eFragmentShader;
+				read_barrier.m_dst_stage_mask = vk::PipelineStageFlagBits::eComputeShader;
+				command_buffer.bufferMemoryBarrier(cluster_buffer, 0, VK_WHOLE_SIZE, read_barrier);
+			}
+
+			auto& resource_cache = m_render_context.getDevice().getResourceCache();
+			auto& cluster_module = resource_cache.requestShaderModule(vk::ShaderStageFlagBits::eCompute, m_cluster_shader, m_cluster_variant);
+			auto& pipeline_layout = resource_cache.requestPipelineLayout({ &cluster_module });
+
+			command_buffer.bindPipelineLayout(pipeline_layout);
+			bind(command_buffer, 0, 0);
+
+			command_buffer.dispatch((CLUSTER_COUNT + CLUSTER_WORKGROUP_SIZE - 1) / CLUSTER_WORKGROUP_SIZE, 1, 1);
+
+			if (!m_async_compute) {
+				common::BufferMemoryBarrier cluster_barrier{};
+				cluster_barrier.m_src_stage_mask = vk::PipelineStageFlagBits::eComputeShader;
+				cluster_barrier.m_dst_stage_mask = vk::PipelineStageFlagBits::eFragmentShader;
+				cluster_barrier.m_src_access_mask = vk::AccessFlagBits::eShaderWrite;
+				cluster_barrier.m_dst_access_mask = vk::AccessFlagBits::eShaderRead;
+				command_buffer.bufferMemoryBarrier(cluster_buffer, 0, VK_WHOLE_SIZE, cluster_barrier);
+			}
+		}
+
+		void LightClusters::bind(core::CommandBuffer& command_buffer, uint32_t set, uint32_t first_binding) {
+			command_buffer.bindBuffer(m_uniform_allocation.getBuffer(), m_uniform_allocation.getOffset(), m_uniform_allocation.getSize(), set, first_binding, 0);
+			command_buffer.bindBuffer(m_light_allocation.getBuffer(), m_light_allocation.getOffset(), m_light_allocation.getSize(), set, first_binding + 1, 0);
+			auto& cluster_buffer = getClusterBuffer();
+			command_buffer.bindBuffer(cluster_buffer, 0, cluster_buffer.getSize(), set, first_binding + 2, 0);
+		}
+	}
+}
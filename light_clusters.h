@@ -0,0 +1,104 @@
+/* Copyright (c) 2025, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "common/buffer.h"
+#include "core/shader_module.h"
+#include "global_common.h"
+#include "rendering/subpass.h"
+
+namespace frame {
+	namespace core {
+		class CommandBuffer;
+	}
+
+	namespace scene {
+		class Camera;
+		class Light;
+	}
+
+	namespace rendering {
+		class RenderContext;
+
+		struct alignas(16) ClusterUniform {
+			glm::mat4 view;
+			glm::mat4 inverse_projection;
+			glm::uvec4 grid_size;
+			glm::vec4 depth_params;
+			glm::vec2 tile_size;
+		};
+
+		/*
+		 * Point and spot lights binned into a view space froxel grid.
+		 * The grid is GRID_SIZE_X x GRID_SIZE_Y screen tiles with GRID_SIZE_Z exponential depth slices between
+		 * the camera planes: slice = log(view_depth) * depth_params.z + depth_params.w, with near and far in depth_params.xy.
+		 * The near plane is clamped to a small positive distance; cameras without planes get a default range.
+		 * grid_size.w holds the light count. Every cluster owns 1 + MAX_LIGHTS_PER_CLUSTER uints of the cluster buffer,
+		 * its light count followed by indices into the light buffer. Lights beyond the limit are dropped from that cluster.
+		 * Cluster shader bindings (set 0): 0 ClusterUniform, 1 lights, 2 clusters, one invocation per cluster.
+		 * Lighting shaders built with CLUSTERED_LIGHTING read the same three buffers from the bindings passed to bind()
+		 * and pick their cluster from gl_FragCoord and the view depth. Directional lights are not clustered.
+		 * With async_compute update() is recorded on the compute queue: every frame gets its own cluster, uniform and
+		 * light buffers, shared concurrently with the graphics family, and the queue semaphore replaces the barriers around the dispatch.
+		 */
+		class LightClusters {
+		public:
+			static constexpr uint32_t GRID_SIZE_X = 16;
+			static constexpr uint32_t GRID_SIZE_Y = 9;
+			static constexpr uint32_t GRID_SIZE_Z = 24;
+			static constexpr uint32_t MAX_LIGHTS_PER_CLUSTER = 128;
+			static constexpr uint32_t CLUSTER_WORKGROUP_SIZE = 64;
+
+			LightClusters(RenderContext& render_context, core::ShaderSource&& cluster_shader, bool async_compute = false);
+
+			void addDefinitions(core::ShaderVariant& variant) const;
+
+			void update(core::CommandBuffer& command_buffer, const std::vector<scene::Light*>& scene_lights, scene::Camera& camera);
+
+			void bind(core::CommandBuffer& command_buffer, uint32_t set, uint32_t first_binding);
+
+			static std::vector<scene::Light*> getDirectionalLights(const std::vector<scene::Light*>& scene_lights);
+
+			bool isAsyncCompute() const;
+
+		private:
+			common::Buffer& getClusterBuffer();
+
+			// Families of both queues when the update runs on a dedicated compute family, empty for exclusive sharing
+			std::vector<uint32_t> getQueueFamilyIndices() const;
+
+			common::BufferAllocation allocateShared(std::vector<std::unique_ptr<common::Buffer>>& buffers, vk::BufferUsageFlags usage, vk::DeviceSize size);
+
+			RenderContext& m_render_context;
+			core::ShaderSource m_cluster_shader;
+			core::ShaderVariant m_cluster_variant;
+
+			std::vector<Light> m_lights;
+			bool m_async_compute;
+			std::vector<std::unique_ptr<common::Buffer>> m_cluster_buffers;
+			std::vector<std::unique_ptr<common::Buffer>> m_uniform_buffers;
+			std::vector<std::unique_ptr<common::Buffer>> m_light_buffers;
+			common::BufferAllocation m_uniform_allocation;
+			common::BufferAllocation m_light_allocation;
+		};
+	}
+}
@@ -6,6 +6,7 @@
 #include <filesystem/filesystem.h>
 #include "platform/window.h"
 
+#include <algorithm>
 #include <memory>
 #include <Windows.h>
 
@@ -26,6 +27,12 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
     window_props.mode = frame::platform::Window::Mode::Default;
     window_props.vsync = frame::platform::Window::Vsync::On;
 
+    // Renders without a surface, e.g. on machines without a display
+    const auto& arguments = context.getArguments();
+    if (std::find(arguments.begin(), arguments.end(), "--headless") != arguments.end()) {
+        window_props.backend = frame::platform::Window::Backend::Headless;
+    }
+
     platform.setWindowProperties(window_props);
     
     std::unique_ptr<frame::platform::Application> app = std::make_unique<RenderDemo>();
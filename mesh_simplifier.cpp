@@ -0,0 +1,221 @@
+/* Copyright (c) 2025, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "common/mesh_simplifier.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <unordered_map>
+
+namespace frame {
+    namespace common {
+        namespace {
+            constexpr uint32_t INVALID_INDEX = std::numeric_limits<uint32_t>::max();
+            constexpr size_t MIN_LOD_TRIANGLES = 32;
+            constexpr uint32_t MAX_GRID_ATTEMPTS = 12;
+
+            // Symmetric 4x4 plane quadric, only the upper triangle is stored
+            struct Quadric {
+                double a2{ 0.0 }, ab{ 0.0 }, ac{ 0.0 }, ad{ 0.0 };
+                double b2{ 0.0 }, bc{ 0.0 }, bd{ 0.0 };
+                double c2{ 0.0 }, cd{ 0.0 };
+                double d2{ 0.0 };
+
+                void addPlane(const glm::dvec3& normal, double distance, double weight) {
+                    a2 += weight * normal.x * normal.x;
+                    ab += weight * normal.x * normal.y;
+                    ac += weight * normal.x * normal.z;
+                    ad += weight * normal.x * distance;
+                    b2 += weight * normal.y * normal.y;
+                    bc += weight * normal.y * normal.z;
+                    bd += weight * normal.y * distance;
+                    c2 += weight * normal.z * normal.z;
+                    cd += weight * normal.z * distance;
+                    d2 += weight * distance * distance;
+                }
+
+                void add(const Quadric& other) {
+                    a2 += other.a2; ab += other.ab; ac += other.ac; ad += other.ad;
+                    b2 += other.b2; bc += other.bc; bd += other.bd;
+                    c2 += other.c2; cd += other.cd;
+                    d2 += other.d2;
+                }
+
+                double evaluate(const glm::vec3& point) const {
+                    double x = point.x;
+                    double y = point.y;
+                    double z = point.z;
+                    return a2 * x * x + 2.0 * ab * x * y + 2.0 * ac * x * z + 2.0 * ad * x +
+                        b2 * y * y + 2.0 * bc * y * z + 2.0 * bd * y +
+                        c2 * z * z + 2.0 * cd * z +
+                        d2;
+                }
+            };
+
+            // Area weighted planes of the adjacent triangles, this keeps sharp features at their original vertices
+            std::vector<Quadric> computeVertexQuadrics(const std::vector<glm::vec3>& positions, const std::vector<uint32_t>& indices) {
+                std::vector<Quadric> quadrics(positions.size());
+
+                for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+                    glm::dvec3 p0 = positions[indices[i]];
+                    glm::dvec3 p1 = positions[indices[i + 1]];
+                    glm::dvec3 p2 = positions[indices[i + 2]];
+
+                    glm::dvec3 normal = glm::cross(p1 - p0, p2 - p0);
+                    double length = glm::length(normal);
+                    if (length <= 0.0) {
+                        continue;
+                    }
+
+                    normal /= length;
+                    double distance = -glm::dot(normal, p0);
+                    double area = length * 0.5;
+
+                    for (uint32_t corner = 0; corner < 3; corner++) {
+                        quadrics[indices[i + corner]].addPlane(normal, distance, area);
+                    }
+                }
+
+                return quadrics;
+            }
+
+            std::vector<uint32_t> clusterVertices(const std::vector<glm::vec3>& positions, const std::vector<uint32_t>& indices,
+                const std::vector<Quadric>& vertex_quadrics, const glm::vec3& min_position, float cell_size) {
+                std::unordered_map<uint64_t, uint32_t> cell_lookup;
+                cell_lookup.reserve(indices.size() / 3);
+
+                std::vector<uint32_t> vertex_cells(positions.size(), INVALID_INDEX);
+                std::vector<Quadric> cell_quadrics;
+
+                for (auto index : indices) {
+                    if (vertex_cells[index] != INVALID_INDEX) {
+                        continue;
+                    }
+
+                    glm::uvec3 cell = glm::uvec3(glm::max((positions[index] - min_position) / cell_size, glm::vec3(0.0f)));
+                    uint64_t key = static_cast<uint64_t>(cell.x & 0x1fffff) |
+                        (static_cast<uint64_t>(cell.y & 0x1fffff) << 21) |
+                        (static_cast<uint64_t>(cell.z & 0x1fffff) << 42);
+
+                    auto it = cell_lookup.emplace(key, static_cast<uint32_t>(cell_quadrics.size())).first;
+                    if (it->second == cell_quadrics.size()) {
+                        cell_quadrics.emplace_back();
+                    }
+
+                    vertex_cells[index] = it->second;
+                    cell_quadrics[it->second].add(vertex_quadrics[index]);
+                }
+
+                // Every cell keeps the vertex that best fits the combined planes of the cell
+                std::vector<uint32_t> representatives(cell_quadrics.size(), INVALID_INDEX);
+                std::vector<double> representative_errors(cell_quadrics.size(), std::numeric_limits<double>::max());
+
+                for (uint32_t vertex = 0; vertex < vertex_cells.size(); vertex++) {
+                    uint32_t cell = vertex_cells[vertex];
+                    if (cell == INVALID_INDEX) {
+                        continue;
+                    }
+
+                    double error = cell_quadrics[cell].evaluate(positions[vertex]);
+                    if (error < representative_errors[cell]) {
+                        representative_errors[cell] = error;
+                        representatives[cell] = vertex;
+                    }
+                }
+
+                std::vector<uint32_t> result;
+                result.reserve(indices.size() / 2);
+
+                for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+                    uint32_t v0 = representatives[vertex_cells[indices[i]]];
+                    uint32_t v1 = representatives[vertex_cells[indices[i + 1]]];
+                    uint32_t v2 = representatives[vertex_cells[indices[i + 2]]];
+
+                    if (v0 == v1 || v1 == v2 || v0 == v2) {
+                        continue;
+                    }
+
+                    result.push_back(v0);
+                    result.push_back(v1);
+                    result.push_back(v2);
+                }
+
+                return result;
+            }
+        }
+
+        std::vector<uint32_t> simplifyMesh(const std::vector<glm::vec3>& positions, const std::vector<uint32_t>& indices, size_t target_triangle_count) {
+            if (indices.size() / 3 <= target_triangle_count) {
+                return indices;
+            }
+
+            glm::vec3 min_position{ std::numeric_limits<float>::max() };
+            glm::vec3 max_position{ std::numeric_limits<float>::lowest() };
+            for (auto index : indices) {
+                min_position = glm::min(min_position, positions[index]);
+                max_position = glm::max(max_position, positions[index]);
+            }
+
+            float largest_extent = glm::max(glm::max(max_position.x - min_position.x, max_position.y - min_position.y), max_position.z - min_position.z);
+            if (largest_extent <= 0.0f) {
+                return {};
+            }
+
+            auto vertex_quadrics = computeVertexQuadrics(positions, indices);
+
+            // A surface with n triangles has about n / 2 vertices, which roughly fill grid_size^2 cells
+            float grid_size = std::max(std::sqrt(static_cast<float>(target_triangle_count)), 2.0f);
+
+            std::vector<uint32_t> result;
+            for (uint32_t attempt = 0; attempt < MAX_GRID_ATTEMPTS; attempt++) {
+                result = clusterVertices(positions, indices, vertex_quadrics, min_position, largest_extent / grid_size);
+
+                if (result.size() / 3 <= target_triangle_count || grid_size <= 2.0f) {
+                    break;
+                }
+
+                grid_size = std::max(grid_size * 0.75f, 2.0f);
+            }
+
+            return result;
+        }
+
+        std::vector<std::vector<uint32_t>> generateLods(const std::vector<glm::vec3>& positions, const std::vector<uint32_t>& indices, uint32_t max_lod_count) {
+            std::vector<std::vector<uint32_t>> lods;
+            lods.push_back(indices);
+
+            while (lods.size() < max_lod_count) {
+                size_t previous_triangle_count = lods.back().size() / 3;
+                if (previous_triangle_count < MIN_LOD_TRIANGLES) {
+                    break;
+                }
+
+                auto lod = simplifyMesh(positions, lods.back(), previous_triangle_count / 2);
+
+                // A level that removes less than a fifth of the triangles is not worth its index memory
+                if (lod.empty() || lod.size() / 3 > previous_triangle_count * 4 / 5) {
+                    break;
+                }
+
+                lods.push_back(std::move(lod));
+            }
+
+            return lods;
+        }
+    }
+}
@@ -0,0 +1,41 @@
+/* Copyright (c) 2025, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+namespace frame {
+    namespace common {
+        constexpr uint32_t MAX_MESH_LODS = 5;
+
+        // Clusters vertices on a uniform grid and collapses every cell to the vertex with the lowest quadric error,
+        // so the result indexes into the original vertex buffer. Triangles that collapse are dropped.
+        // The grid is coarsened until the result has at most target_triangle_count triangles, which is not guaranteed to be reached.
+        std::vector<uint32_t> simplifyMesh(const std::vector<glm::vec3>& positions, const std::vector<uint32_t>& indices, size_t target_triangle_count);
+
+        // Returns the full index list followed by progressively coarser ones, each roughly halving the triangle count.
+        // The chain ends early once a level stops paying for its indices.
+        std::vector<std::vector<uint32_t>> generateLods(const std::vector<glm::vec3>& positions, const std::vector<uint32_t>& indices,
+            uint32_t max_lod_count = MAX_MESH_LODS);
+    }
+}
@@ -0,0 +1,279 @@
+/* Copyright (c) 2025, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "common/meshlet_builder.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+namespace frame {
+    namespace common {
+        namespace {
+            constexpr uint32_t INVALID_TRIANGLE = std::numeric_limits<uint32_t>::max();
+            constexpr uint8_t NO_LOCAL_INDEX = 0xff;
+
+            uint32_t spreadBits(uint32_t value) {
+                value = (value | (value << 16)) & 0x030000ff;
+                value = (value | (value << 8)) & 0x0300f00f;
+                value = (value | (value << 4)) & 0x030c30c3;
+                value = (value | (value << 2)) & 0x09249249;
+                return value;
+            }
+
+            // Orders triangles along a Morton curve through their centroids with an LSD radix sort
+            std::vector<uint32_t> getMortonOrder(const std::vector<glm::vec3>& positions, const std::vector<uint32_t>& indices) {
+                size_t triangle_count = indices.size() / 3;
+
+                std::vector<glm::vec3> centroids(triangle_count);
+                glm::vec3 min_centroid{ std::numeric_limits<float>::max() };
+                glm::vec3 max_centroid{ std::numeric_limits<float>::lowest() };
+
+                for (size_t t = 0; t < triangle_count; t++) {
+                    centroids[t] = (positions[indices[t * 3]] + positions[indices[t * 3 + 1]] + positions[indices[t * 3 + 2]]) / 3.0f;
+                    min_centroid = glm::min(min_centroid, centroids[t]);
+                    max_centroid = glm::max(max_centroid, centroids[t]);
+                }
+
+                glm::vec3 scale = 1023.0f / glm::max(max_centroid - min_centroid, glm::vec3(std::numeric_limits<float>::epsilon()));
+
+                std::vector<uint32_t> keys(triangle_count);
+                std::vector<uint32_t> order(triangle_count);
+
+                for (size_t t = 0; t < triangle_count; t++) {
+                    glm::uvec3 cell = glm::uvec3(glm::clamp((centroids[t] - min_centroid) * scale, glm::vec3(0.0f), glm::vec3(1023.0f)));
+                    keys[t] = spreadBits(cell.x) | (spreadBits(cell.y) << 1) | (spreadBits(cell.z) << 2);
+                    order[t] = static_cast<uint32_t>(t);
+                }
+
+                std::vector<uint32_t> sorted_keys(triangle_count);
+                std::vector<uint32_t> sorted_order(triangle_count);
+
+                for (uint32_t shift = 0; shift < 32; shift += 8) {
+                    size_t offsets[257] = {};
+
+                    for (auto key : keys) {
+                        offsets[((key >> shift) & 0xff) + 1]++;
+                    }
+                    for (size_t i = 1; i < 257; i++) {
+                        offsets[i] += offsets[i - 1];
+                    }
+                    for (size_t i = 0; i < triangle_count; i++) {
+                        size_t destination = offsets[(keys[i] >> shift) & 0xff]++;
+                        sorted_keys[destination] = keys[i];
+                        sorted_order[destination] = order[i];
+                    }
+
+                    keys.swap(sorted_keys);
+                    order.swap(sorted_order);
+                }
+
+                return order;
+            }
+
+            MeshletBounds computeMeshletBounds(const Meshlet& meshlet, const std::vector<glm::vec3>& positions) {
+                MeshletBounds bounds{};
+
+                glm::vec3 min_position{ std::numeric_limits<float>::max() };
+                glm::vec3 max_position{ std::numeric_limits<float>::lowest() };
+
+                for (uint32_t i = 0; i < meshlet.vertex_count; i++) {
+                    min_position = glm::min(min_position, positions[meshlet.vertices[i]]);
+                    max_position = glm::max(max_position, positions[meshlet.vertices[i]]);
+                }
+
+                glm::vec3 center = (min_position + max_position) * 0.5f;
+                float radius = 0.0f;
+
+                for (uint32_t i = 0; i < meshlet.vertex_count; i++) {
+                    radius = std::max(radius, glm::length(positions[meshlet.vertices[i]] - center));
+                }
+
+                bounds.bounding_sphere = glm::vec4(center, radius);
+
+                glm::vec3 normals[MESHLET_MAX_TRIANGLES];
+                uint32_t normal_count = 0;
+                glm::vec3 normal_sum{ 0.0f };
+
+                for (uint32_t i = 0; i < meshlet.index_count; i += 3) {
+                    const glm::vec3& p0 = positions[meshlet.indices[i]];
+                    const glm::vec3& p1 = positions[meshlet.indices[i + 1]];
+                    const glm::vec3& p2 = positions[meshlet.indices[i + 2]];
+
+                    glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+                    float length = glm::length(normal);
+
+                    // Degenerate triangles do not constrain the cone
+                    if (length > 0.0f) {
+                        normals[normal_count++] = normal / length;
+                        normal_sum += normal / length;
+                    }
+                }
+
+                bounds.normal_cone = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+
+                float sum_length = glm::length(normal_sum);
+                if (normal_count == 0 || sum_length <= std::numeric_limits<float>::epsilon()) {
+                    return bounds;
+                }
+
+                glm::vec3 axis = normal_sum / sum_length;
+                float min_dot = 1.0f;
+
+                for (uint32_t i = 0; i < normal_count; i++) {
+                    min_dot = std::min(min_dot, glm::dot(axis, normals[i]));
+                }
+
+                // Normals spread over a hemisphere or more leave no view direction that sees only backfaces
+                if (min_dot <= 0.0f) {
+                    return bounds;
+                }
+
+                bounds.normal_cone = glm::vec4(axis, std::sqrt(1.0f - min_dot * min_dot));
+                return bounds;
+            }
+        }
+
+        void buildMeshlets(const std::vector<glm::vec3>& positions, const std::vector<uint32_t>& indices,
+            std::vector<Meshlet>& meshlets, std::vector<MeshletBounds>& bounds) {
+            size_t triangle_count = indices.size() / 3;
+            size_t vertex_count = positions.size();
+
+            if (triangle_count == 0) {
+                return;
+            }
+
+            assert(std::all_of(indices.begin(), indices.end(), [vertex_count](uint32_t index) { return index < vertex_count; }) &&
+                "[MeshletBuilder] ASSERT: Index out of vertex range");
+
+            // Vertex to triangle adjacency, every list only keeps the triangles that are still unused
+            std::vector<uint32_t> live_counts(vertex_count, 0);
+            for (size_t i = 0; i < triangle_count * 3; i++) {
+                live_counts[indices[i]]++;
+            }
+
+            std::vector<uint32_t> adjacency_offsets(vertex_count + 1, 0);
+            for (size_t v = 0; v < vertex_count; v++) {
+                adjacency_offsets[v + 1] = adjacency_offsets[v] + live_counts[v];
+            }
+
+            std::vector<uint32_t> adjacency(triangle_count * 3);
+            std::vector<uint32_t> fill_offsets(adjacency_offsets.begin(), adjacency_offsets.end() - 1);
+            for (size_t i = 0; i < triangle_count * 3; i++) {
+                adjacency[fill_offsets[indices[i]]++] = static_cast<uint32_t>(i / 3);
+            }
+
+            std::vector<uint32_t> seed_order = getMortonOrder(positions, indices);
+            size_t seed_cursor = 0;
+
+            std::vector<uint8_t> emitted(triangle_count, 0);
+            // Slot of each vertex in the open meshlet's vertices
+            std::vector<uint8_t> local_indices(vertex_count, NO_LOCAL_INDEX);
+
+            Meshlet meshlet{};
+            uint32_t meshlet_triangles = 0;
+
+            auto finishMeshlet = [&]() {
+                bounds.push_back(computeMeshletBounds(meshlet, positions));
+                meshlets.push_back(meshlet);
+
+                for (uint32_t i = 0; i < meshlet.vertex_count; i++) {
+                    local_indices[meshlet.vertices[i]] = NO_LOCAL_INDEX;
+                }
+
+                meshlet = Meshlet{};
+                meshlet_triangles = 0;
+            };
+
+            auto countNewVertices = [&](uint32_t triangle) {
+                uint32_t a = indices[triangle * 3];
+                uint32_t b = indices[triangle * 3 + 1];
+                uint32_t c = indices[triangle * 3 + 2];
+
+                return static_cast<uint32_t>(local_indices[a] == NO_LOCAL_INDEX) +
+                    static_cast<uint32_t>(local_indices[b] == NO_LOCAL_INDEX && b != a) +
+                    static_cast<uint32_t>(local_indices[c] == NO_LOCAL_INDEX && c != a && c != b);
+            };
+
+            for (size_t emitted_count = 0; emitted_count < triangle_count; emitted_count++) {
+                uint32_t best_triangle = INVALID_TRIANGLE;
+                uint32_t best_new_vertices = 4;
+                uint32_t best_live_count = std::numeric_limits<uint32_t>::max();
+
+                // Neighbours adding fewer vertices come first, ties go to triangles whose vertices are closest to done
+                for (uint32_t i = 0; i < meshlet.vertex_count; i++) {
+                    uint32_t vertex = meshlet.vertices[i];
+
+                    for (uint32_t j = adjacency_offsets[vertex]; j < adjacency_offsets[vertex] + live_counts[vertex]; j++) {
+                        uint32_t triangle = adjacency[j];
+                        uint32_t new_vertices = countNewVertices(triangle);
+                        uint32_t live_count = live_counts[indices[triangle * 3]] + live_counts[indices[triangle * 3 + 1]] + live_counts[indices[triangle * 3 + 2]];
+
+                        if (new_vertices < best_new_vertices || (new_vertices == best_new_vertices && live_count < best_live_count)) {
+                            best_triangle = triangle;
+                            best_new_vertices = new_vertices;
+                            best_live_count = live_count;
+                        }
+                    }
+                }
+
+                if (best_triangle == INVALID_TRIANGLE) {
+                    while (emitted[seed_order[seed_cursor]]) {
+                        seed_cursor++;
+                    }
+
+                    best_triangle = seed_order[seed_cursor];
+                    best_new_vertices = countNewVertices(best_triangle);
+                }
+
+                if (meshlet.vertex_count + best_new_vertices > MESHLET_MAX_VERTICES || meshlet_triangles == MESHLET_MAX_TRIANGLES) {
+                    finishMeshlet();
+                }
+
+                for (uint32_t corner = 0; corner < 3; corner++) {
+                    uint32_t vertex = indices[best_triangle * 3 + corner];
+
+                    if (local_indices[vertex] == NO_LOCAL_INDEX) {
+                        local_indices[vertex] = static_cast<uint8_t>(meshlet.vertex_count);
+                        meshlet.vertices[meshlet.vertex_count++] = vertex;
+                    }
+
+                    meshlet.indices[meshlet.index_count++] = vertex;
+
+                    // Swap the triangle out of the vertex's live range
+                    uint32_t begin = adjacency_offsets[vertex];
+                    uint32_t end = begin + live_counts[vertex];
+                    for (uint32_t j = begin; j < end; j++) {
+                        if (adjacency[j] == best_triangle) {
+                            std::swap(adjacency[j], adjacency[end - 1]);
+                            break;
+                        }
+                    }
+                    live_counts[vertex]--;
+                }
+
+                emitted[best_triangle] = 1;
+                meshlet_triangles++;
+            }
+
+            if (meshlet_triangles > 0) {
+                finishMeshlet();
+            }
+        }
+    }
+}
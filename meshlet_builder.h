@@ -0,0 +1,58 @@
+/* Copyright (c) 2025, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+namespace frame {
+    namespace common {
+        constexpr uint32_t MESHLET_MAX_VERTICES = 64;
+        constexpr uint32_t MESHLET_MAX_INDICES = 126;
+        constexpr uint32_t MESHLET_MAX_TRIANGLES = MESHLET_MAX_INDICES / 3;
+
+        // Storage buffer layout read by the mesh shaders. vertices lists the meshlet's unique vertices,
+        // indices its triangles as mesh vertex indices, three per triangle.
+        struct Meshlet
+        {
+            uint32_t vertices[MESHLET_MAX_VERTICES];
+            uint32_t indices[MESHLET_MAX_INDICES];
+            uint32_t vertex_count;
+            uint32_t index_count;
+        };
+
+        // Culling data of the meshlet with the same index, kept apart so the Meshlet layout stays unchanged.
+        // bounding_sphere holds the center and radius. normal_cone holds the cone axis and the sine of its spread,
+        // a meshlet is backfacing when dot(center - eye, axis) >= normal_cone.w * length(center - eye) + radius.
+        // normal_cone.w is 1 when the triangles face too many directions to ever be culled.
+        struct MeshletBounds
+        {
+            glm::vec4 bounding_sphere;
+            glm::vec4 normal_cone;
+        };
+
+        // Clusters triangles into meshlets in time linear in the triangle count.
+        // Each meshlet grows through triangles sharing its vertices, preferring ones that add the fewest new
+        // vertices, and restarts from the next unused triangle in Morton order when it runs out of neighbours.
+        void buildMeshlets(const std::vector<glm::vec3>& positions, const std::vector<uint32_t>& indices,
+            std::vector<Meshlet>& meshlets, std::vector<MeshletBounds>& bounds);
+    }
+}
@@ -0,0 +1,44 @@
+/* Copyright (c) 2025, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "rendering/subpass/oit_accumulation_subpass.h"
+
+namespace frame {
+	namespace rendering {
+		namespace subpass {
+			OitAccumulationSubpass::OitAccumulationSubpass(RenderContext& render_context, GeometrySubpass& geometry_subpass) :
+				Subpass{ render_context, core::ShaderSource{}, core::ShaderSource{} },
+				m_geometry_subpass{ geometry_subpass }
+			{
+				setOutputAttachments({ RenderTarget::getAccumulationAttachment(false), RenderTarget::getRevealageAttachment(false) });
+				m_geometry_subpass.setOrderIndependentTransparency(true);
+			}
+
+			void OitAccumulationSubpass::prepare() {
+			}
+
+			void OitAccumulationSubpass::prepareRenderTarget(const RenderTarget& render_target) {
+				const bool compact = render_target.isCompactGBuffer();
+				setOutputAttachments({ RenderTarget::getAccumulationAttachment(compact), RenderTarget::getRevealageAttachment(compact) });
+			}
+
+			void OitAccumulationSubpass::draw(core::CommandBuffer& command_buffer) {
+				m_geometry_subpass.drawTransparentAccumulation(command_buffer);
+			}
+		}
+	}
+}
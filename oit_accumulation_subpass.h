@@ -0,0 +1,53 @@
+/* Copyright (c) 2025, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include "rendering/subpass.h"
+#include "rendering/subpass/geometry_subpass.h"
+
+namespace frame {
+	namespace rendering {
+		namespace subpass {
+			/*
+			 * Weighted-blended order-independent transparency, accumulation step.
+			 * Draws the transparent part of a GeometrySubpass draw list with the geometry shaders built with OIT_ACCUMULATION,
+			 * in batch order instead of back to front. The fragment shader writes the weighted premultiplied color to
+			 * location 0 and the alpha to location 1, which the blend state turns into a sum and 1 - revealage.
+			 * It has to be created before the geometry subpass is prepared and be followed by an OitCompositeSubpass.
+			 * Both targets need to be cleared to zero. The render target has to come from RenderTarget::OIT_CREATE_FUNC
+			 * or RenderTarget::COMPACT_OIT_CREATE_FUNC, the targets are picked from its layout every frame.
+			 */
+			class OitAccumulationSubpass : public Subpass {
+			public:
+				OitAccumulationSubpass(RenderContext& render_context, GeometrySubpass& geometry_subpass);
+
+				virtual ~OitAccumulationSubpass() = default;
+
+				virtual void prepare() override;
+
+				virtual void prepareRenderTarget(const RenderTarget& render_target) override;
+
+				virtual void draw(core::CommandBuffer& command_buffer) override;
+
+			private:
+				GeometrySubpass& m_geometry_subpass;
+			};
+		}
+	}
+}
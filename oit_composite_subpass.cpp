@@ -0,0 +1,85 @@
+/* Copyright (c) 2025, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "rendering/subpass/oit_composite_subpass.h"
+
+#include "rendering/render_context.h"
+
+namespace frame {
+	namespace rendering {
+		namespace subpass {
+			OitCompositeSubpass::OitCompositeSubpass(RenderContext& render_context, core::ShaderSource&& vertex_shader, core::ShaderSource&& fragment_shader) :
+				Subpass{ render_context, std::move(vertex_shader), std::move(fragment_shader) }
+			{
+				setInputAttachments({ RenderTarget::getAccumulationAttachment(false), RenderTarget::getRevealageAttachment(false) });
+				setOutputAttachments({ 1 });
+				setDisableDepthStencilAttachment(true);
+			}
+
+			void OitCompositeSubpass::prepare() {
+				auto& resource_cache = getRenderContext().getDevice().getResourceCache();
+				resource_cache.requestShaderModule(vk::ShaderStageFlagBits::eVertex, getVertexShader(), {});
+				resource_cache.requestShaderModule(vk::ShaderStageFlagBits::eFragment, getFragmentShader(), {});
+			}
+
+			void OitCompositeSubpass::prepareRenderTarget(const RenderTarget& render_target) {
+				const bool compact = render_target.isCompactGBuffer();
+				setInputAttachments({ RenderTarget::getAccumulationAttachment(compact), RenderTarget::getRevealageAttachment(compact) });
+			}
+
+			void OitCompositeSubpass::draw(core::CommandBuffer& command_buffer) {
+				auto& resource_cache = command_buffer.getDevice().getResourceCache();
+				auto& vert_shader_module = resource_cache.requestShaderModule(vk::ShaderStageFlagBits::eVertex, getVertexShader(), {});
+				auto& frag_shader_module = resource_cache.requestShaderModule(vk::ShaderStageFlagBits::eFragment, getFragmentShader(), {});
+
+				std::vector<core::ShaderModuleCPP*> shader_modules{ &vert_shader_module, &frag_shader_module };
+
+				auto& pipeline_layout = resource_cache.requestPipelineLayout(shader_modules);
+				command_buffer.bindPipelineLayout(pipeline_layout);
+
+				assert(pipeline_layout.getResources(core::ShaderResourceType::Input, vk::ShaderStageFlagBits::eVertex).empty());
+				command_buffer.setVertexInputState({});
+
+				auto& render_target = getRenderContext().getActiveFrame().getRenderTarget();
+				command_buffer.bindInput(render_target.getAccumulationView(), 0, 0, 0);
+				command_buffer.bindInput(render_target.getRevealageView(), 0, 1, 0);
+
+				RasterizationState rasterization_state;
+				rasterization_state.cull_mode = vk::CullModeFlagBits::eNone;
+				command_buffer.setRasterizationState(rasterization_state);
+
+				DepthStencilState depth_stencil_state{};
+				depth_stencil_state.depth_test_enable = false;
+				depth_stencil_state.depth_write_enable = false;
+				command_buffer.setDepthStencilState(depth_stencil_state);
+
+				ColorBlendAttachmentState color_blend_attachment{};
+				color_blend_attachment.blend_enable = true;
+				color_blend_attachment.src_color_blend_factor = vk::BlendFactor::eSrcAlpha;
+				color_blend_attachment.dst_color_blend_factor = vk::BlendFactor::eOneMinusSrcAlpha;
+				color_blend_attachment.src_alpha_blend_factor = vk::BlendFactor::eZero;
+				color_blend_attachment.dst_alpha_blend_factor = vk::BlendFactor::eOne;
+
+				ColorBlendState color_blend_state{};
+				color_blend_state.attachments = { color_blend_attachment };
+				command_buffer.setColorBlendState(color_blend_state);
+
+				command_buffer.draw(3, 1, 0, 0);
+			}
+		}
+	}
+}
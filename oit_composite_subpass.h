@@ -0,0 +1,46 @@
+/* Copyright (c) 2025, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include "rendering/subpass.h"
+
+namespace frame {
+	namespace rendering {
+		namespace subpass {
+			/*
+			 * Weighted-blended order-independent transparency, resolve step.
+			 * Draws a fullscreen triangle that reads the accumulation (input binding 0) and revealage (input binding 1)
+			 * targets and blends the average transparent color over the opaque image with the coverage as alpha.
+			 * The targets are picked from the render target's layout, RenderTarget::OIT_CREATE_FUNC or COMPACT_OIT_CREATE_FUNC.
+			 */
+			class OitCompositeSubpass : public Subpass {
+			public:
+				OitCompositeSubpass(RenderContext& render_context, core::ShaderSource&& vertex_shader, core::ShaderSource&& fragment_shader);
+
+				virtual ~OitCompositeSubpass() = default;
+
+				virtual void prepare() override;
+
+				virtual void prepareRenderTarget(const RenderTarget& render_target) override;
+
+				virtual void draw(core::CommandBuffer& command_buffer) override;
+			};
+		}
+	}
+}
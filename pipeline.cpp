@@ -264,8 +264,22 @@ namespace frame {
             create_info.pDynamicState = &dynamic_state;
 
             create_info.layout = pipeline_state.getPipelineLayout().getHandle();
-            create_info.renderPass = pipeline_state.getRenderPass()->getHandle();
-            create_info.subpass = pipeline_state.getSubpassIndex();
+
+            // Without a render pass the pipeline is built for dynamic rendering against the attachment formats
+            vk::PipelineRenderingCreateInfo rendering_info{};
+            if (auto render_pass = pipeline_state.getRenderPass()) {
+                create_info.renderPass = render_pass->getHandle();
+                create_info.subpass = pipeline_state.getSubpassIndex();
+            }
+            else {
+                const auto& rendering_format_state = pipeline_state.getRenderingFormatState();
+                rendering_info.setColorAttachmentFormats(rendering_format_state.color_formats);
+                rendering_info.depthAttachmentFormat = rendering_format_state.depth_format;
+                if (common::isDepthStencilFormat(rendering_format_state.depth_format)) {
+                    rendering_info.stencilAttachmentFormat = rendering_format_state.depth_format;
+                }
+                create_info.pNext = &rendering_info;
+            }
 
             auto result = getDevice().getHandle().createGraphicsPipeline(pipeline_cache, create_info);
 
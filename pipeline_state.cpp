@@ -79,6 +79,11 @@ namespace frame {
                     });
         }
 
+        bool operator!=(const RenderingFormatState& lhs, const RenderingFormatState& rhs) {
+            return std::tie(lhs.color_formats, lhs.depth_format, lhs.sample_count) !=
+                std::tie(rhs.color_formats, rhs.depth_format, rhs.sample_count);
+        }
+
         void SpecializationConstantState::reset() {
             if (m_dirty) {
                 m_specialization_constant_state.clear();
@@ -127,6 +132,7 @@ namespace frame {
             m_multisample_state = {};
             m_depth_stencil_state = {};
             m_color_blend_state = {};
+            m_rendering_format_state = {};
             m_subpass_index = 0U;
         }
 
@@ -220,6 +226,13 @@ namespace frame {
             }
         }
 
+        void PipelineState::setRenderingFormatState(const RenderingFormatState& rendering_format_state) {
+            if (m_rendering_format_state != rendering_format_state) {
+                m_rendering_format_state = rendering_format_state;
+                m_dirty = true;
+            }
+        }
+
         const core::PipelineLayoutCPP& PipelineState::getPipelineLayout() const {
             assert(m_pipeline_layout && "[PipelineState] ASSERT: PipelineCPP layout is not set");
             return *m_pipeline_layout;
@@ -265,6 +278,10 @@ namespace frame {
             return m_subpass_index;
         }
 
+        const RenderingFormatState& PipelineState::getRenderingFormatState() const {
+            return m_rendering_format_state;
+        }
+
         bool PipelineState::isDirty() const {
             return m_dirty || m_specialization_constant_state.isDirty();
         }
@@ -111,6 +111,12 @@ namespace frame {
             uint32_t viewport_count = 1;
             uint32_t scissor_count = 1;
         };
+
+        struct RenderingFormatState {
+            std::vector<vk::Format> color_formats;
+            vk::Format depth_format = vk::Format::eUndefined;
+            vk::SampleCountFlagBits sample_count = vk::SampleCountFlagBits::e1;
+        };
         
         class SpecializationConstantState {
         public:
@@ -155,6 +161,7 @@ namespace frame {
             void setDepthStencilState(const DepthStencilState& depth_stencil_state);
             void setColorBlendState(const ColorBlendState& color_blend_state);
             void setSubpassIndex(uint32_t subpass_index);
+            void setRenderingFormatState(const RenderingFormatState& rendering_format_state);
 
             const core::PipelineLayoutCPP& getPipelineLayout() const;
             const core::RenderPassCPP* getRenderPass() const;
@@ -167,6 +174,7 @@ namespace frame {
             const DepthStencilState& getDepthStencilState() const;
             const ColorBlendState& getColorBlendState() const;
             uint32_t getSubpassIndex() const;
+            const RenderingFormatState& getRenderingFormatState() const;
 
             bool isDirty() const;
             void clearDirty();
@@ -185,6 +193,7 @@ namespace frame {
             MultisampleState m_multisample_state{};
             DepthStencilState m_depth_stencil_state{};
             ColorBlendState m_color_blend_state{};
+            RenderingFormatState m_rendering_format_state{};
 
             uint32_t m_subpass_index{ 0U };
         };
@@ -198,5 +207,6 @@ namespace frame {
         bool operator!=(const MultisampleState& lhs, const MultisampleState& rhs);
         bool operator!=(const DepthStencilState& lhs, const DepthStencilState& rhs);
         bool operator!=(const ColorBlendState& lhs, const ColorBlendState& rhs);
+        bool operator!=(const RenderingFormatState& lhs, const RenderingFormatState& rhs);
     }
 }
@@ -82,13 +82,22 @@ namespace frame {
                     return ExitCode::NoApplication;
                 }
 
+                // A paced application samples input right before the frame is simulated
+                bool paced = m_active_app->waitForFrame();
+                if (paced) {
+                    m_window->processEvents();
+                }
+
                 update();
 
                 if (m_active_app->shouldClose()) {
                     m_active_app->finish();
+                    m_window->close();
                 }
 
-                m_window->processEvents();
+                if (!paced) {
+                    m_window->processEvents();
+                }
 
                 if (m_window->shouldClose() || m_close_requested) {
                     return ExitCode::Close;
@@ -181,6 +190,9 @@ namespace frame {
             if (properties.vsync) {
                 m_window_properties.vsync = properties.vsync.value();
             }
+            if (properties.backend) {
+                m_window_properties.backend = properties.backend.value();
+            }
             if (properties.extent.width) {
                 m_window_properties.extent.width = properties.extent.width.value();
             }
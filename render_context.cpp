@@ -18,9 +18,22 @@
 
 #include "rendering/render_context.h"
 #include "core/queue.h"
+#include "core/timeline_semaphore.h"
 
 namespace frame {
     namespace rendering {
+        namespace {
+            const core::Queue& getAsyncComputeQueue(core::Device& device, const core::Queue& graphics_queue) {
+                // A family without graphics lets compute work overlap rasterization
+                try {
+                    return device.getQueueByFlags(vk::QueueFlagBits::eCompute, 0, vk::QueueFlagBits::eGraphics);
+                }
+                catch (std::runtime_error&) {
+                    return graphics_queue;
+                }
+            }
+        }
+
         vk::Format RenderContext::DEFAULT_VK_FORMAT = vk::Format::eR8G8B8A8Srgb;
 
         RenderContext::RenderContext(core::Device& device,
@@ -33,7 +46,8 @@ namespace frame {
             m_surface_extent{ window.getExtent().width, window.getExtent().height },
             m_device{ device },
             m_window{ window },
-            m_queue{ device.getSuitableGraphicsQueue() }
+            m_queue{ device.getSuitableGraphicsQueue() },
+            m_compute_queue{ getAsyncComputeQueue(device, m_queue) }
         {
             if(surface) {
                 vk::SurfaceCapabilitiesKHR surface_props = device.getPhysicalDevice().getHandle().getSurfaceCapabilitiesKHR(surface);
@@ -49,6 +63,19 @@ namespace frame {
             }
         }
 
+        RenderContext::~RenderContext() {
+            m_device.getHandle().waitIdle();
+
+            for (auto& semaphore : m_present_semaphores) {
+                m_device.getHandle().destroySemaphore(semaphore);
+            }
+        }
+
+        void RenderContext::setFramesInFlight(uint32_t frames_in_flight) {
+            assert(!m_prepared && "[RenderContext] ASSERT: Frames in flight must be set before prepare()");
+            m_frames_in_flight = frames_in_flight;
+        }
+
         void RenderContext::prepare(size_t thread_count, rendering::RenderTarget::CreateFunc create_render_target_func) {
 
             m_device.getHandle().waitIdle();
@@ -59,22 +86,30 @@ namespace frame {
 
                 for (auto& image_handle : m_swapchain->getImages()) {
                     auto swapchain_image = core::ImageCPP{ m_device, image_handle, extent, m_swapchain->getFormat(), m_swapchain->getUsage(), true };
-                    auto render_target = create_render_target_func(std::move(swapchain_image));
-                    m_frames.emplace_back(std::make_unique<rendering::RenderFrame>(m_device, std::move(render_target), thread_count));
+                    m_render_targets.push_back(create_render_target_func(std::move(swapchain_image)));
                 }
+                createPresentSemaphores();
             }
             else {
-                auto color_image = core::ImageCPP{
-                    m_device,
-                    vk::Extent3D{m_surface_extent.width, m_surface_extent.height, 1},
-                    DEFAULT_VK_FORMAT,
-                    vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eTransferSrc,
-                    VMA_MEMORY_USAGE_GPU_ONLY
-                };
+                // Offscreen frames own their color image, one per frame in flight
+                for (uint32_t i = 0; i < std::max(m_frames_in_flight, 1u); ++i) {
+                    auto color_image = core::ImageCPP{
+                        m_device,
+                        vk::Extent3D{m_surface_extent.width, m_surface_extent.height, 1},
+                        DEFAULT_VK_FORMAT,
+                        vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eTransferSrc | vk::ImageUsageFlagBits::eTransferDst,
+                        VMA_MEMORY_USAGE_GPU_ONLY
+                    };
+
+                    m_render_targets.push_back(create_render_target_func(std::move(color_image)));
+                }
+            }
 
-                auto render_target = create_render_target_func(std::move(color_image));
-                m_frames.emplace_back(std::make_unique<rendering::RenderFrame>(m_device, std::move(render_target), thread_count));
+            size_t frame_count = m_frames_in_flight > 0 ? m_frames_in_flight : m_render_targets.size();
+            for (size_t i = 0; i < frame_count; ++i) {
+                m_frames.emplace_back(std::make_unique<rendering::RenderFrame>(m_device, thread_count));
             }
+            assignFrameRenderTargets();
 
             m_create_render_target_func = create_render_target_func;
             m_thread_count = thread_count;
@@ -85,6 +120,10 @@ namespace frame {
             return m_swapchain ? m_swapchain->getFormat() : DEFAULT_VK_FORMAT;
         }
 
+        vk::ImageLayout RenderContext::getOutputLayout() const {
+            return m_swapchain ? vk::ImageLayout::ePresentSrcKHR : vk::ImageLayout::eTransferSrcOptimal;
+        }
+
         void RenderContext::updateSwapchain(const vk::Extent2D& extent) {
             if(!m_swapchain) {
                 LOGW("Can't update the swapchains extent. No swapchain, offscreen rendering detected, skipping.");
@@ -144,21 +183,18 @@ namespace frame {
                 vk::Extent2D swapchain_extent = m_swapchain->getExtent();
             vk::Extent3D extent{ swapchain_extent.width, swapchain_extent.height, 1 };
 
-            auto frame_it = m_frames.begin();
-
+            m_render_targets.clear();
             for (auto& image_handle : m_swapchain->getImages()) {
                 core::ImageCPP swapchain_image{ m_device, image_handle, extent, m_swapchain->getFormat(), m_swapchain->getUsage() };
-                auto render_target = m_create_render_target_func(std::move(swapchain_image));
-
-                if(frame_it != m_frames.end()) {
-                    (*frame_it)->updateRenderTarget(std::move(render_target));
-                }
-                else {
-                    m_frames.emplace_back(std::make_unique<rendering::RenderFrame>(m_device, std::move(render_target), m_thread_count));
-                }
+                m_render_targets.push_back(m_create_render_target_func(std::move(swapchain_image)));
+            }
+            createPresentSemaphores();
 
-                ++frame_it;
+            // Without a fixed ring the frame count follows the swapchain image count
+            while(m_frames_in_flight == 0 && m_frames.size() < m_render_targets.size()) {
+                m_frames.emplace_back(std::make_unique<rendering::RenderFrame>(m_device, m_thread_count));
             }
+            assignFrameRenderTargets();
 
             m_device.getResourceCache().clearFramebuffers();
         }
@@ -219,16 +255,98 @@ namespace frame {
 
             if(m_swapchain) {
                 assert(m_acquired_semaphore && "[RenderContext] ASSERT: We do not have acquired_semaphore, it was probably consumed?");
-                render_semaphore = submit(m_queue, command_buffers, m_acquired_semaphore, vk::PipelineStageFlagBits::eColorAttachmentOutput);
+                m_compute_semaphores.push_back(m_acquired_semaphore);
+                m_compute_wait_values.push_back(0);
+                // Depth and G-buffer attachments belong to the swapchain image and are shared by every ring slot that renders
+                // to it, so their first writes wait for the image's previous frame to be presented as well
+                m_compute_wait_stages.push_back(vk::PipelineStageFlagBits::eEarlyFragmentTests | vk::PipelineStageFlagBits::eLateFragmentTests |
+                    vk::PipelineStageFlagBits::eColorAttachmentOutput);
+
+                // Owned per image, a frame's semaphore pool can be reset while its last present still waits.
+                // Acquiring the image again implies that present has finished
+                render_semaphore = m_present_semaphores[m_active_image_index];
+            }
+
+            if(m_device.hasTimelineSemaphores()) {
+                m_frame_value = submitTimeline(m_queue, command_buffers, m_compute_semaphores, m_compute_wait_values, m_compute_wait_stages, render_semaphore);
+
+                for (auto& destroy : m_frame_garbage) {
+                    m_device.deferDestruction(m_queue, m_frame_value, std::move(destroy));
+                }
+                m_frame_garbage.clear();
             }
             else {
-                submit(m_queue, command_buffers);
+                submitBinary(m_queue, command_buffers, m_compute_semaphores, m_compute_wait_stages, render_semaphore);
             }
 
+            m_compute_semaphores.clear();
+            m_compute_wait_values.clear();
+            m_compute_wait_stages.clear();
+
             endFrame(render_semaphore);
         }
 
+        core::CommandBuffer& RenderContext::beginCompute(core::CommandBuffer::ResetMode reset_mode) {
+            assert(m_frame_active && "[RenderContext] ASSERT: Frame is not active, please call begin()");
+            return getActiveFrame().requestCommandBuffer(m_compute_queue, reset_mode);
+        }
+
+        void RenderContext::submitCompute(const std::vector<core::CommandBuffer*>& command_buffers, vk::PipelineStageFlags graphics_wait_stage) {
+            assert(m_frame_active && "[RenderContext] ASSERT: Frame is not active, please call begin()");
+
+            if(m_device.hasTimelineSemaphores()) {
+                uint64_t value = submitTimeline(m_compute_queue, command_buffers, {}, {}, {}, nullptr);
+                m_compute_semaphores.push_back(m_device.getTimelineSemaphore(m_compute_queue).getHandle());
+                m_compute_wait_values.push_back(value);
+            }
+            else {
+                m_compute_semaphores.push_back(submit(m_compute_queue, command_buffers, std::vector<vk::Semaphore>{}, std::vector<vk::PipelineStageFlags>{}));
+                m_compute_wait_values.push_back(0);
+            }
+            m_compute_wait_stages.push_back(graphics_wait_stage);
+        }
+
+        const core::Queue& RenderContext::getComputeQueue() const {
+            return m_compute_queue;
+        }
+
+        bool RenderContext::hasAsyncCompute() const {
+            return m_compute_queue.getFamilyIndex() != m_queue.getFamilyIndex();
+        }
+
+        uint64_t RenderContext::getFrameValue() const {
+            assert(m_device.hasTimelineSemaphores() && "[RenderContext] ASSERT: Frame values require timeline semaphores");
+            return m_frame_value;
+        }
+
+        bool RenderContext::isFrameComplete(uint64_t frame_value) const {
+            return m_device.getTimelineSemaphore(m_queue).isComplete(frame_value);
+        }
+
+        void RenderContext::waitForFrameValue(uint64_t frame_value) const {
+            if(m_device.getTimelineSemaphore(m_queue).wait(frame_value) != vk::Result::eSuccess) {
+                throw std::runtime_error("[RenderContext] ERROR: Frame wait fail");
+            }
+        }
+
+        void RenderContext::setLowLatency(bool enable, bool use_present_wait) {
+            m_frame_pacer = enable ? std::make_unique<FramePacer>(*this, use_present_wait) : nullptr;
+        }
+
+        FramePacer* RenderContext::getFramePacer() {
+            return m_frame_pacer.get();
+        }
+
+        void RenderContext::deferDestruction(std::function<void()>&& destroy) {
+            assert(m_device.hasTimelineSemaphores() && "[RenderContext] ASSERT: Deferred destruction requires timeline semaphores");
+            m_frame_garbage.push_back(std::move(destroy));
+        }
+
         void RenderContext::beginFrame() {
+            if(m_device.hasTimelineSemaphores()) {
+                m_device.collectGarbage();
+            }
+
             if(m_swapchain) {
                 handleSurfaceChanges();
             }
@@ -241,7 +359,7 @@ namespace frame {
             if(m_swapchain) {
                 vk::Result result;
                 try {
-                    std::tie(result, m_active_frame_index) = m_swapchain->acquireNextImage(m_acquired_semaphore);
+                    std::tie(result, m_active_image_index) = m_swapchain->acquireNextImage(m_acquired_semaphore);
                 }
                 catch (vk::OutOfDateKHRError&) {
                     result = vk::Result::eErrorOutOfDateKHR;
@@ -258,7 +376,7 @@ namespace frame {
                     if(swapchain_updated) {
                         m_device.getHandle().destroySemaphore(m_acquired_semaphore);
                         m_acquired_semaphore = prev_frame.requestSemaphoreWithOwnership();
-                        std::tie(result, m_active_frame_index) = m_swapchain->acquireNextImage(m_acquired_semaphore);
+                        std::tie(result, m_active_image_index) = m_swapchain->acquireNextImage(m_acquired_semaphore);
                     }
                 }
 
@@ -268,8 +386,15 @@ namespace frame {
                 }
             }
 
+            // Swapchain images map onto the frame ring, the ring size bounds how far the CPU runs ahead
+            m_active_frame_index = (m_active_frame_index + 1) % static_cast<uint32_t>(m_frames.size());
+            if(!m_swapchain) {
+                m_active_image_index = m_active_frame_index % static_cast<uint32_t>(m_render_targets.size());
+            }
+
             m_frame_active = true;
             waitFrame();
+            getActiveFrame().updateRenderTarget(*m_render_targets[m_active_image_index]);
         }
 
         vk::Semaphore RenderContext::submit(const core::Queue& queue,
@@ -277,37 +402,95 @@ namespace frame {
             vk::Semaphore wait_semaphore,
             vk::PipelineStageFlags wait_pipeline_stage)
         {
-            std::vector<vk::CommandBuffer> cmd_buf_handles(command_buffers.size(), nullptr);
-            std::transform(command_buffers.begin(), command_buffers.end(), cmd_buf_handles.begin(),
-                [](const core::CommandBuffer* cmd_buf) { return cmd_buf->getHandle(); });
-
-            RenderFrame& frame = getActiveFrame();
-            vk::Semaphore signal_semaphore = frame.requestSemaphore();
-
-            vk::SubmitInfo submit_info(nullptr, nullptr, cmd_buf_handles, signal_semaphore);
             if(wait_semaphore) {
-                submit_info.setWaitSemaphores(wait_semaphore);
-                submit_info.pWaitDstStageMask = &wait_pipeline_stage;
+                return submit(queue, command_buffers, std::vector<vk::Semaphore>{ wait_semaphore }, std::vector<vk::PipelineStageFlags>{ wait_pipeline_stage });
             }
+            return submit(queue, command_buffers, std::vector<vk::Semaphore>{}, std::vector<vk::PipelineStageFlags>{});
+        }
 
-            vk::Fence fence = frame.requestFence();
-            queue.getHandle().submit(submit_info, fence);
+        vk::Semaphore RenderContext::submit(const core::Queue& queue,
+            const std::vector<core::CommandBuffer*>& command_buffers,
+            const std::vector<vk::Semaphore>& wait_semaphores,
+            const std::vector<vk::PipelineStageFlags>& wait_pipeline_stages)
+        {
+            assert(wait_semaphores.size() == wait_pipeline_stages.size() && "[RenderContext] ASSERT: Every wait semaphore needs a stage");
+
+            vk::Semaphore signal_semaphore = getActiveFrame().requestSemaphore();
+
+            if(m_device.hasTimelineSemaphores()) {
+                submitTimeline(queue, command_buffers, wait_semaphores, std::vector<uint64_t>(wait_semaphores.size(), 0), wait_pipeline_stages, signal_semaphore);
+            }
+            else {
+                submitBinary(queue, command_buffers, wait_semaphores, wait_pipeline_stages, signal_semaphore);
+            }
 
             return signal_semaphore;
         }
 
         void RenderContext::submit(const core::Queue& queue, const std::vector<core::CommandBuffer*>& command_buffers) {
 
+            if(m_device.hasTimelineSemaphores()) {
+                submitTimeline(queue, command_buffers, {}, {}, {}, nullptr);
+                return;
+            }
+
+            submitBinary(queue, command_buffers, {}, {}, nullptr);
+        }
+
+        void RenderContext::submitBinary(const core::Queue& queue,
+            const std::vector<core::CommandBuffer*>& command_buffers,
+            const std::vector<vk::Semaphore>& wait_semaphores,
+            const std::vector<vk::PipelineStageFlags>& wait_pipeline_stages,
+            vk::Semaphore signal_semaphore)
+        {
             std::vector<vk::CommandBuffer> cmd_buf_handles(command_buffers.size(), nullptr);
             std::transform(command_buffers.begin(), command_buffers.end(), cmd_buf_handles.begin(),
                 [](const core::CommandBuffer* cmd_buf) { return cmd_buf->getHandle(); });
 
-            RenderFrame& frame = getActiveFrame();
-            vk::SubmitInfo submit_info(nullptr, nullptr, cmd_buf_handles);
-            vk::Fence fence = frame.requestFence();
+            std::vector<vk::Semaphore> signal_semaphores;
+            if(signal_semaphore) {
+                signal_semaphores.push_back(signal_semaphore);
+            }
+
+            vk::SubmitInfo submit_info(wait_semaphores, wait_pipeline_stages, cmd_buf_handles, signal_semaphores);
+
+            vk::Fence fence = getActiveFrame().requestFence();
             queue.getHandle().submit(submit_info, fence);
         }
 
+        uint64_t RenderContext::submitTimeline(const core::Queue& queue,
+            const std::vector<core::CommandBuffer*>& command_buffers,
+            const std::vector<vk::Semaphore>& wait_semaphores,
+            const std::vector<uint64_t>& wait_values,
+            const std::vector<vk::PipelineStageFlags>& wait_pipeline_stages,
+            vk::Semaphore signal_semaphore)
+        {
+            assert(wait_semaphores.size() == wait_values.size() && "[RenderContext] ASSERT: Every wait semaphore needs a value");
+            assert(wait_semaphores.size() == wait_pipeline_stages.size() && "[RenderContext] ASSERT: Every wait semaphore needs a stage");
+
+            std::vector<vk::CommandBuffer> cmd_buf_handles(command_buffers.size(), nullptr);
+            std::transform(command_buffers.begin(), command_buffers.end(), cmd_buf_handles.begin(),
+                [](const core::CommandBuffer* cmd_buf) { return cmd_buf->getHandle(); });
+
+            core::TimelineSemaphore& timeline = m_device.getTimelineSemaphore(queue);
+            uint64_t value = timeline.advance();
+
+            // Binary semaphores ignore their entry in the value arrays
+            std::vector<vk::Semaphore> signal_semaphores{ timeline.getHandle() };
+            std::vector<uint64_t> signal_values{ value };
+            if(signal_semaphore) {
+                signal_semaphores.push_back(signal_semaphore);
+                signal_values.push_back(0);
+            }
+
+            vk::TimelineSemaphoreSubmitInfo timeline_info(wait_values, signal_values);
+            vk::SubmitInfo submit_info(wait_semaphores, wait_pipeline_stages, cmd_buf_handles, signal_semaphores, &timeline_info);
+            queue.getHandle().submit(submit_info);
+
+            getActiveFrame().addTimelineWait(timeline, value);
+            return value;
+        }
+
         void RenderContext::waitFrame() {
             getActiveFrame().reset();
         }
@@ -316,9 +499,12 @@ namespace frame {
 
             assert(m_frame_active && "[RenderContext] ASSERT: Frame is not active, please call beginFrame");
 
+            vk::SwapchainKHR vk_swapchain;
+            uint64_t present_id = 0;
+
             if(m_swapchain) {
-                vk::SwapchainKHR vk_swapchain = m_swapchain->getHandle();
-                vk::PresentInfoKHR present_info(semaphore, vk_swapchain, m_active_frame_index);
+                vk_swapchain = m_swapchain->getHandle();
+                vk::PresentInfoKHR present_info(semaphore, vk_swapchain, m_active_image_index);
 
                 vk::DisplayPresentInfoKHR disp_present_info;
                 if(m_device.isExtensionSupported(VK_KHR_DISPLAY_SWAPCHAIN_EXTENSION_NAME) &&
@@ -328,6 +514,14 @@ namespace frame {
                     present_info.pNext = &disp_present_info;
                 }
 
+                vk::PresentIdKHR present_id_info;
+                if(m_frame_pacer && m_frame_pacer->usesPresentWait()) {
+                    present_id = ++m_present_id;
+                    present_id_info.setPresentIds(present_id);
+                    present_id_info.pNext = present_info.pNext;
+                    present_info.pNext = &present_id_info;
+                }
+
                 vk::Result result;
                 try {
                     result = m_queue.present(present_info);
@@ -341,6 +535,10 @@ namespace frame {
                 }
             }
 
+            if(m_frame_pacer) {
+                m_frame_pacer->frameSubmitted(vk_swapchain, present_id);
+            }
+
             if(m_acquired_semaphore) {
                 releaseOwnedSemaphore(m_acquired_semaphore);
                 m_acquired_semaphore = nullptr;
@@ -353,6 +551,16 @@ namespace frame {
             return std::exchange(m_acquired_semaphore, nullptr);
         }
 
+        void RenderContext::addFrameCounter(stats::StatIndex index, double value) {
+            std::lock_guard<std::mutex> guard{ m_frame_counters_mutex };
+            m_frame_counters[index].result += value;
+        }
+
+        stats::StatsProvider::Counters RenderContext::consumeFrameCounters() {
+            std::lock_guard<std::mutex> guard{ m_frame_counters_mutex };
+            return std::exchange(m_frame_counters, {});
+        }
+
         RenderFrame& RenderContext::getActiveFrame() {
             assert(m_frame_active && "[RenderContext] ASSERT: Frame is not active, please call beginFrame");
             return *m_frames[m_active_frame_index];
@@ -392,14 +600,13 @@ namespace frame {
             vk::Extent2D swapchain_extent = m_swapchain->getExtent();
             vk::Extent3D extent{ swapchain_extent.width, swapchain_extent.height, 1 };
 
-            auto frame_it = m_frames.begin();
-
+            m_render_targets.clear();
             for (auto& image_handle : m_swapchain->getImages()) {
                 core::ImageCPP swapchain_image{ m_device, image_handle, extent, m_swapchain->getFormat(), m_swapchain->getUsage() };
-                auto render_target = m_create_render_target_func(std::move(swapchain_image));
-                (*frame_it)->updateRenderTarget(std::move(render_target));
-                ++frame_it;
+                m_render_targets.push_back(m_create_render_target_func(std::move(swapchain_image)));
             }
+            createPresentSemaphores();
+            assignFrameRenderTargets();
         }
 
         core::Swapchain const& RenderContext::getSwapchain() const {
@@ -415,6 +622,24 @@ namespace frame {
             return m_active_frame_index;
         }
 
+        uint32_t RenderContext::getActiveImageIndex() const {
+            return m_active_image_index;
+        }
+
+        void RenderContext::assignFrameRenderTargets() {
+            // Frames can be queried before the first beginFrame(), which then binds the acquired image's target
+            for (size_t i = 0; i < m_frames.size(); ++i) {
+                m_frames[i]->updateRenderTarget(*m_render_targets[i % m_render_targets.size()]);
+            }
+        }
+
+        void RenderContext::createPresentSemaphores() {
+            // Only grows, a recreated swapchain may still have presents waiting on the existing ones
+            while(m_present_semaphores.size() < m_render_targets.size()) {
+                m_present_semaphores.push_back(m_device.getHandle().createSemaphore({}));
+            }
+        }
+
         std::vector<std::unique_ptr<RenderFrame>>& RenderContext::getRenderFrames() {
             return m_frames;
         }
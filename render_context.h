@@ -18,10 +18,15 @@
 
 #pragma once
 
+#include <functional>
+#include <mutex>
+
 #include "core/device.h"
 #include "core/swapchain.h"
 #include "platform/window.h"
+#include "rendering/frame_pacer.h"
 #include "rendering/render_frame.h"
+#include "stats/stats_provider.h"
 
 namespace frame {
     namespace core {
@@ -51,10 +56,13 @@ namespace frame {
 
             RenderContext(const RenderContext&) = delete;
             RenderContext(RenderContext&&) = delete;
-            virtual ~RenderContext() = default;
+            virtual ~RenderContext();
             RenderContext& operator=(const RenderContext&) = delete;
             RenderContext& operator=(RenderContext&&) = delete;
 
+            // Size of the frame ring, 0 keeps one frame per swapchain image. Must be set before prepare()
+            void setFramesInFlight(uint32_t frames_in_flight);
+
             void prepare(size_t thread_count = 1, 
                 RenderTarget::CreateFunc create_render_target_func = RenderTarget::CREATE_FUNC);
 
@@ -77,7 +85,35 @@ namespace frame {
                 vk::Semaphore wait_semaphore,
                 vk::PipelineStageFlags wait_pipeline_stage);
 
+            vk::Semaphore submit(const core::Queue& queue,
+                const std::vector<core::CommandBuffer*>& command_buffers,
+                const std::vector<vk::Semaphore>& wait_semaphores,
+                const std::vector<vk::PipelineStageFlags>& wait_pipeline_stages);
+
             void submit(const core::Queue& queue, const std::vector<core::CommandBuffer*>& command_buffers);
+
+            // Command buffer of the active frame on the compute queue, a dedicated family when the device has one
+            core::CommandBuffer& beginCompute(core::CommandBuffer::ResetMode reset_mode = core::CommandBuffer::ResetMode::ResetPool);
+
+            // Submits to the compute queue, the next graphics submit of the frame waits for it at graphics_wait_stage
+            void submitCompute(const std::vector<core::CommandBuffer*>& command_buffers, vk::PipelineStageFlags graphics_wait_stage);
+
+            const core::Queue& getComputeQueue() const;
+            bool hasAsyncCompute() const;
+
+            // Graphics timeline value signaled by the last submitted frame, requires timeline semaphores
+            uint64_t getFrameValue() const;
+            // Non-blocking check whether the frame that signaled frame_value has finished on the GPU
+            bool isFrameComplete(uint64_t frame_value) const;
+            // Blocks until the frame that signaled frame_value has finished on the GPU
+            void waitForFrameValue(uint64_t frame_value) const;
+            // Runs destroy once the active frame has finished on the GPU
+            void deferDestruction(std::function<void()>&& destroy);
+
+            // Paces frames for input latency instead of throughput, present-wait needs VK_KHR_present_id and VK_KHR_present_wait enabled
+            void setLowLatency(bool enable, bool use_present_wait = false);
+            FramePacer* getFramePacer();
+
             virtual void waitFrame();
             void endFrame(vk::Semaphore semaphore);
 
@@ -89,30 +125,67 @@ namespace frame {
             void releaseOwnedSemaphore(vk::Semaphore semaphore);
             core::Device& getDevice();
             vk::Format getFormat() const;
+            // Layout the color output is left in at the end of a frame, transfer source for offscreen readback
+            vk::ImageLayout getOutputLayout() const;
             core::Swapchain const& getSwapchain() const;
             vk::Extent2D const& getSurfaceExtent() const;
             uint32_t getActiveFrameIndex() const;
+            uint32_t getActiveImageIndex() const;
             std::vector<std::unique_ptr<RenderFrame>>& getRenderFrames();
             virtual bool handleSurfaceChanges(bool force_update = false);
             vk::Semaphore consumeAcquiredSemaphore();
+            void addFrameCounter(stats::StatIndex index, double value);
+            stats::StatsProvider::Counters consumeFrameCounters();
 
         protected:
             vk::Extent2D m_surface_extent;
 
         private:
+            uint64_t submitTimeline(const core::Queue& queue,
+                const std::vector<core::CommandBuffer*>& command_buffers,
+                const std::vector<vk::Semaphore>& wait_semaphores,
+                const std::vector<uint64_t>& wait_values,
+                const std::vector<vk::PipelineStageFlags>& wait_pipeline_stages,
+                vk::Semaphore signal_semaphore);
+
+            void submitBinary(const core::Queue& queue,
+                const std::vector<core::CommandBuffer*>& command_buffers,
+                const std::vector<vk::Semaphore>& wait_semaphores,
+                const std::vector<vk::PipelineStageFlags>& wait_pipeline_stages,
+                vk::Semaphore signal_semaphore);
+
+            void assignFrameRenderTargets();
+
+            void createPresentSemaphores();
+
             core::Device& m_device;
             const platform::Window& m_window;
             const core::Queue& m_queue;
+            const core::Queue& m_compute_queue;
+            std::vector<vk::Semaphore> m_compute_semaphores;
+            std::vector<uint64_t> m_compute_wait_values;
+            std::vector<vk::PipelineStageFlags> m_compute_wait_stages;
+            std::vector<std::function<void()>> m_frame_garbage;
+            uint64_t m_frame_value{ 0 };
+            std::unique_ptr<FramePacer> m_frame_pacer;
+            uint64_t m_present_id{ 0 };
             std::unique_ptr<core::Swapchain> m_swapchain;
             core::SwapchainProperties m_swapchain_properties;
             std::vector<std::unique_ptr<RenderFrame>> m_frames;
+            std::vector<std::unique_ptr<RenderTarget>> m_render_targets;
+            // Render-complete semaphores waited on by present, indexed by swapchain image
+            std::vector<vk::Semaphore> m_present_semaphores;
+            uint32_t m_frames_in_flight{ 0 };
             vk::Semaphore m_acquired_semaphore;
             bool m_prepared{ false };
             uint32_t m_active_frame_index{ 0 };
+            uint32_t m_active_image_index{ 0 };
             bool m_frame_active{ false };
             RenderTarget::CreateFunc m_create_render_target_func = RenderTarget::CREATE_FUNC;
             vk::SurfaceTransformFlagBitsKHR m_pre_transform{ vk::SurfaceTransformFlagBitsKHR::eIdentity };
             size_t m_thread_count{ 1 };
+            stats::StatsProvider::Counters m_frame_counters;
+            std::mutex m_frame_counters_mutex;
         };
     }
 }
@@ -25,12 +25,11 @@ constexpr uint32_t BUFFER_POOL_BLOCK_SIZE = 256;
 
 namespace frame {
     namespace rendering {
-        RenderFrame::RenderFrame(core::Device& device, std::unique_ptr<RenderTarget>&& render_target, size_t thread_count) :
+        RenderFrame::RenderFrame(core::Device& device, size_t thread_count) :
             m_device{ device },
             m_fence_pool{ device },
             m_semaphore_pool{ device },
-            m_thread_count{ thread_count },
-            m_swapchain_render_target{ std::move(render_target) }
+            m_thread_count{ thread_count }
         {
             for (auto& usage_it : m_supported_usage_map) {
                 auto [buffer_pools_it, inserted] = m_buffer_pools.emplace(usage_it.first, std::vector<std::pair<common::BufferPool, common::BufferBlock*>>{});
@@ -142,13 +141,24 @@ namespace frame {
         }
 
         RenderTarget& RenderFrame::getRenderTarget() {
-            return *m_swapchain_render_target;
+            assert(m_swapchain_render_target && "[RenderFrame] ASSERT: No render target assigned to the frame");
+            return m_render_target_override ? *m_render_target_override : *m_swapchain_render_target;
         }
 
         RenderTarget const& RenderFrame::getRenderTarget() const {
+            assert(m_swapchain_render_target && "[RenderFrame] ASSERT: No render target assigned to the frame");
+            return m_render_target_override ? *m_render_target_override : *m_swapchain_render_target;
+        }
+
+        RenderTarget& RenderFrame::getSwapchainRenderTarget() {
+            assert(m_swapchain_render_target && "[RenderFrame] ASSERT: No render target assigned to the frame");
             return *m_swapchain_render_target;
         }
 
+        void RenderFrame::setRenderTargetOverride(RenderTarget* render_target) {
+            m_render_target_override = render_target;
+        }
+
         const core::SemaphorePool& RenderFrame::getSemaphorePool() const {
             return m_semaphore_pool;
         }
@@ -220,11 +230,24 @@ namespace frame {
             return m_semaphore_pool.requestSemaphoreWithOwnership();
         }
 
+        void RenderFrame::addTimelineWait(core::TimelineSemaphore& timeline, uint64_t value) {
+            auto& wait_value = m_timeline_values[&timeline];
+            wait_value = std::max(wait_value, value);
+        }
+
         void RenderFrame::reset() {
+            for (auto& [timeline, value] : m_timeline_values) {
+                if (timeline->wait(value) != vk::Result::eSuccess) {
+                    throw std::runtime_error("[RenderFrame] ERROR: Timeline semaphore wait fail");
+                }
+            }
+            m_timeline_values.clear();
+
             if (m_fence_pool.wait() != vk::Result::eSuccess) {
                 throw std::runtime_error("[RenderFrame] ERROR: Fence pool wait fail");
             }
             m_fence_pool.reset();
+            m_render_target_override = nullptr;
 
             for (auto& command_pools_per_queue : m_command_pools) {
                 for (auto& command_pool : command_pools_per_queue.second) {
@@ -254,6 +277,10 @@ namespace frame {
             m_descriptor_management_strategy = new_strategy;
         }
 
+        size_t RenderFrame::getThreadCount() const {
+            return m_thread_count;
+        }
+
         void RenderFrame::updateDescriptorSets(size_t thread_index) {
             assert(thread_index < m_descriptor_sets.size());
             auto& thread_descriptor_sets = *m_descriptor_sets[thread_index];
@@ -262,8 +289,8 @@ namespace frame {
             }
         }
 
-        void RenderFrame::updateRenderTarget(std::unique_ptr<RenderTarget>&& render_target) {
-            m_swapchain_render_target = std::move(render_target);
+        void RenderFrame::updateRenderTarget(RenderTarget& render_target) {
+            m_swapchain_render_target = &render_target;
         }
     }
 }
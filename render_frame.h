@@ -20,6 +20,7 @@
 #include "common/buffer_pool.h"
 #include "core/fence_pool.h"
 #include "core/semaphore_pool.h"
+#include "core/timeline_semaphore.h"
 #include "core/device.h"
 #include "core/command_buffer.h"
 #include "common/resource_caching.h"
@@ -41,13 +42,16 @@ namespace frame {
         
         class RenderFrame {
         public:
-            RenderFrame(core::Device& device, std::unique_ptr<RenderTarget>&& render_target, size_t thread_count = 1);
+            RenderFrame(core::Device& device, size_t thread_count = 1);
             
             void clearDescriptors();
             core::Device& getDevice();
             const core::FencePool& getFencePool() const;
             RenderTarget& getRenderTarget();
             RenderTarget const& getRenderTarget() const;
+            RenderTarget& getSwapchainRenderTarget();
+            // Redirects getRenderTarget() to an offscreen target until the frame is reset, nullptr restores the swapchain target
+            void setRenderTargetOverride(RenderTarget* render_target);
             const core::SemaphorePool& getSemaphorePool() const;
             void releaseOwnedSemaphore(vk::Semaphore semaphore);
             vk::DescriptorSet requestDescriptorSet(const core::DescriptorSetLayoutCPP& descriptor_set_layout,
@@ -58,6 +62,8 @@ namespace frame {
             vk::Fence requestFence();
             vk::Semaphore requestSemaphore();
             vk::Semaphore requestSemaphoreWithOwnership();
+            // Work of this frame signals value on the timeline, reset() waits for it in place of the fences
+            void addTimelineWait(core::TimelineSemaphore& timeline, uint64_t value);
             void reset();
             
             common::BufferAllocation allocateBuffer(vk::BufferUsageFlags usage, vk::DeviceSize size, size_t thread_index = 0);
@@ -71,10 +77,13 @@ namespace frame {
             
             void setDescriptorManagementStrategy(DescriptorManagementStrategy new_strategy);
             
-            void updateRenderTarget(std::unique_ptr<RenderTarget>&& render_target);
+            // The RenderContext owns the swapchain targets, a frame borrows the one of the image it acquired
+            void updateRenderTarget(RenderTarget& render_target);
             
             void updateDescriptorSets(size_t thread_index = 0);
 
+            size_t getThreadCount() const;
+
         private:
             std::vector<std::unique_ptr<core::CommandPool>>& getCommandPools(const core::Queue& queue,
                 core::CommandBuffer::ResetMode reset_mode);
@@ -96,8 +105,10 @@ namespace frame {
             std::vector<std::unique_ptr<std::unordered_map<std::size_t, core::DescriptorSetCPP>>> m_descriptor_sets;
             core::FencePool m_fence_pool;
             core::SemaphorePool m_semaphore_pool;
+            std::map<core::TimelineSemaphore*, uint64_t> m_timeline_values;
             size_t m_thread_count;
-            std::unique_ptr<RenderTarget> m_swapchain_render_target;
+            RenderTarget* m_swapchain_render_target{ nullptr };
+            RenderTarget* m_render_target_override{ nullptr };
             BufferAllocationStrategy m_buffer_allocation_strategy{ BufferAllocationStrategy::MultipleAllocationsPerBuffer };
             DescriptorManagementStrategy m_descriptor_management_strategy{ DescriptorManagementStrategy::StoreInCache };
             std::map<vk::BufferUsageFlags, std::vector<std::pair<common::BufferPool, common::BufferBlock*>>> m_buffer_pools;
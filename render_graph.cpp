@@ -0,0 +1,692 @@
+/* Copyright (c) 2025, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "rendering/render_graph.h"
+
+#include <algorithm>
+#include <cassert>
+#include <queue>
+
+#include "common/common.h"
+#include "core/command_buffer.h"
+#include "core/debug.h"
+#include "core/device.h"
+
+namespace frame {
+	namespace rendering {
+		namespace {
+			struct AccessInfo {
+				vk::PipelineStageFlags2 stages;
+				vk::AccessFlags2 access;
+				vk::ImageLayout layout;
+				vk::ImageUsageFlags usage;
+				bool write;
+			};
+
+			const vk::AccessFlags2 WRITE_ACCESS_MASK =
+				vk::AccessFlagBits2::eColorAttachmentWrite | vk::AccessFlagBits2::eDepthStencilAttachmentWrite |
+				vk::AccessFlagBits2::eShaderWrite | vk::AccessFlagBits2::eTransferWrite | vk::AccessFlagBits2::eMemoryWrite;
+
+			AccessInfo getAccessInfo(RenderGraphAccess access) {
+				const vk::PipelineStageFlags2 shader_stages =
+					vk::PipelineStageFlagBits2::eVertexShader | vk::PipelineStageFlagBits2::eFragmentShader | vk::PipelineStageFlagBits2::eComputeShader;
+				const vk::PipelineStageFlags2 depth_stages =
+					vk::PipelineStageFlagBits2::eEarlyFragmentTests | vk::PipelineStageFlagBits2::eLateFragmentTests;
+
+				switch (access) {
+				case RenderGraphAccess::ColorAttachment:
+					return { vk::PipelineStageFlagBits2::eColorAttachmentOutput,
+						vk::AccessFlagBits2::eColorAttachmentRead | vk::AccessFlagBits2::eColorAttachmentWrite,
+						vk::ImageLayout::eColorAttachmentOptimal, vk::ImageUsageFlagBits::eColorAttachment, true };
+				case RenderGraphAccess::DepthAttachment:
+					return { depth_stages,
+						vk::AccessFlagBits2::eDepthStencilAttachmentRead | vk::AccessFlagBits2::eDepthStencilAttachmentWrite,
+						vk::ImageLayout::eDepthStencilAttachmentOptimal, vk::ImageUsageFlagBits::eDepthStencilAttachment, true };
+				case RenderGraphAccess::DepthAttachmentRead:
+					return { depth_stages, vk::AccessFlagBits2::eDepthStencilAttachmentRead,
+						vk::ImageLayout::eDepthStencilReadOnlyOptimal, vk::ImageUsageFlagBits::eDepthStencilAttachment, false };
+				case RenderGraphAccess::SampledRead:
+					return { vk::PipelineStageFlagBits2::eFragmentShader | vk::PipelineStageFlagBits2::eComputeShader,
+						vk::AccessFlagBits2::eShaderRead, vk::ImageLayout::eShaderReadOnlyOptimal, vk::ImageUsageFlagBits::eSampled, false };
+				case RenderGraphAccess::StorageRead:
+					return { shader_stages, vk::AccessFlagBits2::eShaderRead, vk::ImageLayout::eGeneral, vk::ImageUsageFlagBits::eStorage, false };
+				case RenderGraphAccess::StorageWrite:
+					return { vk::PipelineStageFlagBits2::eFragmentShader | vk::PipelineStageFlagBits2::eComputeShader,
+						vk::AccessFlagBits2::eShaderRead | vk::AccessFlagBits2::eShaderWrite,
+						vk::ImageLayout::eGeneral, vk::ImageUsageFlagBits::eStorage, true };
+				case RenderGraphAccess::TransferRead:
+					return { vk::PipelineStageFlagBits2::eTransfer, vk::AccessFlagBits2::eTransferRead,
+						vk::ImageLayout::eTransferSrcOptimal, vk::ImageUsageFlagBits::eTransferSrc, false };
+				case RenderGraphAccess::TransferWrite:
+					return { vk::PipelineStageFlagBits2::eTransfer, vk::AccessFlagBits2::eTransferWrite,
+						vk::ImageLayout::eTransferDstOptimal, vk::ImageUsageFlagBits::eTransferDst, true };
+				case RenderGraphAccess::VertexRead:
+					return { vk::PipelineStageFlagBits2::eVertexInput, vk::AccessFlagBits2::eVertexAttributeRead, vk::ImageLayout::eUndefined, {}, false };
+				case RenderGraphAccess::IndexRead:
+					return { vk::PipelineStageFlagBits2::eVertexInput, vk::AccessFlagBits2::eIndexRead, vk::ImageLayout::eUndefined, {}, false };
+				case RenderGraphAccess::IndirectRead:
+					return { vk::PipelineStageFlagBits2::eDrawIndirect, vk::AccessFlagBits2::eIndirectCommandRead, vk::ImageLayout::eUndefined, {}, false };
+				case RenderGraphAccess::UniformRead:
+					return { shader_stages, vk::AccessFlagBits2::eUniformRead, vk::ImageLayout::eUndefined, {}, false };
+				default:
+					throw std::runtime_error("[RenderGraph] ERROR: Unknown resource access");
+				}
+			}
+
+			vk::ImageSubresourceRange getBarrierRange(const core::ImageViewCPP& view) {
+				auto subresource_range = view.getSubresourceRange();
+				if (common::isDepthOnlyFormat(view.getFormat())) {
+					subresource_range.aspectMask = vk::ImageAspectFlagBits::eDepth;
+				}
+				else if (common::isDepthStencilFormat(view.getFormat())) {
+					subresource_range.aspectMask = vk::ImageAspectFlagBits::eDepth | vk::ImageAspectFlagBits::eStencil;
+				}
+				return subresource_range;
+			}
+
+			vk::PipelineStageFlags toLegacyStages(vk::PipelineStageFlags2 stages) {
+				return vk::PipelineStageFlags(static_cast<VkPipelineStageFlags>(static_cast<VkPipelineStageFlags2>(stages)));
+			}
+
+			vk::AccessFlags toLegacyAccess(vk::AccessFlags2 access) {
+				return vk::AccessFlags(static_cast<VkAccessFlags>(static_cast<VkAccessFlags2>(access)));
+			}
+		}
+
+		RenderGraph::PassBuilder::PassBuilder(RenderGraph& graph, uint32_t pass_index) :
+			m_graph{ graph },
+			m_pass_index{ pass_index }
+		{}
+
+		RenderGraph::PassBuilder& RenderGraph::PassBuilder::useImage(ImageHandle image, RenderGraphAccess access) {
+			assert(image < m_graph.m_images.size() && "[RenderGraph] ASSERT: Invalid image handle");
+			assert(getAccessInfo(access).layout != vk::ImageLayout::eUndefined && "[RenderGraph] ASSERT: Buffer access used on an image");
+			m_graph.m_passes[m_pass_index].images.push_back({ image, access });
+			m_graph.m_compiled = false;
+			return *this;
+		}
+
+		RenderGraph::PassBuilder& RenderGraph::PassBuilder::useBuffer(BufferHandle buffer, RenderGraphAccess access) {
+			assert(buffer < m_graph.m_buffers.size() && "[RenderGraph] ASSERT: Invalid buffer handle");
+			m_graph.m_passes[m_pass_index].buffers.push_back({ buffer, access });
+			m_graph.m_compiled = false;
+			return *this;
+		}
+
+		RenderGraph::PassBuilder& RenderGraph::PassBuilder::setSideEffects() {
+			m_graph.m_passes[m_pass_index].side_effects = true;
+			m_graph.m_compiled = false;
+			return *this;
+		}
+
+		RenderGraph::RenderGraph(core::Device& device, bool synchronization2, uint32_t frame_count) :
+			m_device{ device },
+			m_synchronization2{ synchronization2 },
+			m_frame_count{ std::max(frame_count, 1u) }
+		{}
+
+		RenderGraph::~RenderGraph() {
+			releaseTransients();
+		}
+
+		RenderGraph::ImageHandle RenderGraph::createImage(const std::string& name, const RenderGraphImageDesc& desc) {
+			ImageResource image{};
+			image.name = name;
+			image.desc = desc;
+			m_images.push_back(std::move(image));
+			m_compiled = false;
+			return static_cast<ImageHandle>(m_images.size() - 1);
+		}
+
+		RenderGraph::ImageHandle RenderGraph::importImage(const std::string& name,
+			vk::ImageLayout initial_layout,
+			vk::ImageLayout final_layout,
+			vk::PipelineStageFlags2 initial_stages)
+		{
+			ImageResource image{};
+			image.name = name;
+			image.imported = true;
+			image.initial_layout = initial_layout;
+			image.final_layout = final_layout;
+			image.initial_stages = initial_stages;
+			m_images.push_back(std::move(image));
+			m_compiled = false;
+			return static_cast<ImageHandle>(m_images.size() - 1);
+		}
+
+		RenderGraph::BufferHandle RenderGraph::importBuffer(const std::string& name) {
+			m_buffers.push_back({ name });
+			m_compiled = false;
+			return static_cast<BufferHandle>(m_buffers.size() - 1);
+		}
+
+		void RenderGraph::setImportedImage(ImageHandle image, const core::ImageViewCPP& view) {
+			assert(m_images[image].imported && "[RenderGraph] ASSERT: Only imported images can be rebound");
+			m_images[image].view = &view;
+		}
+
+		void RenderGraph::setImportedBuffer(BufferHandle buffer, const common::Buffer& resource) {
+			m_buffers[buffer].buffer = &resource;
+		}
+
+		void RenderGraph::setOutput(ImageHandle image) {
+			m_images[image].output = true;
+			m_compiled = false;
+		}
+
+		RenderGraph::PassBuilder RenderGraph::addPass(const std::string& name, ExecuteFunc&& execute) {
+			Pass pass{};
+			pass.name = name;
+			pass.execute = std::move(execute);
+			m_passes.push_back(std::move(pass));
+			m_compiled = false;
+			return PassBuilder{ *this, static_cast<uint32_t>(m_passes.size() - 1) };
+		}
+
+		void RenderGraph::compile() {
+			releaseTransients();
+
+			// Dependencies follow declaration order: a reader waits for the last writer, a writer for
+			// the last writer and every reader since then
+			std::vector<std::vector<uint32_t>> successors(m_passes.size());
+			std::vector<std::vector<uint32_t>> producers(m_passes.size());
+
+			struct Tracker {
+				uint32_t writer{ ~0u };
+				std::vector<uint32_t> readers;
+			};
+			std::vector<Tracker> image_trackers(m_images.size());
+			std::vector<Tracker> buffer_trackers(m_buffers.size());
+
+			auto add_edge = [&](uint32_t from, uint32_t to, bool produces) {
+				if (from == ~0u || from == to) {
+					return;
+				}
+				successors[from].push_back(to);
+				if (produces) {
+					producers[to].push_back(from);
+				}
+			};
+
+			auto track = [&](Tracker& tracker, uint32_t pass_index, RenderGraphAccess access) {
+				if (getAccessInfo(access).write) {
+					add_edge(tracker.writer, pass_index, true);
+					for (auto reader : tracker.readers) {
+						add_edge(reader, pass_index, false);
+					}
+					tracker.writer = pass_index;
+					tracker.readers.clear();
+				}
+				else {
+					add_edge(tracker.writer, pass_index, true);
+					tracker.readers.push_back(pass_index);
+				}
+			};
+
+			for (uint32_t i = 0; i < m_passes.size(); ++i) {
+				for (auto& access : m_passes[i].images) {
+					track(image_trackers[access.resource], i, access.access);
+				}
+				for (auto& access : m_passes[i].buffers) {
+					track(buffer_trackers[access.resource], i, access.access);
+				}
+			}
+
+			cullPasses(producers);
+			orderPasses(successors);
+
+			for (auto& image : m_images) {
+				image.first_use = ~0u;
+				image.last_use = 0;
+			}
+
+			for (uint32_t position = 0; position < m_order.size(); ++position) {
+				for (auto& access : m_passes[m_order[position]].images) {
+					auto& image = m_images[access.resource];
+					image.first_use = std::min(image.first_use, position);
+					image.last_use = std::max(image.last_use, position);
+					image.desc.usage |= getAccessInfo(access.access).usage;
+				}
+			}
+
+			allocateTransients();
+
+			m_compiled = true;
+		}
+
+		void RenderGraph::cullPasses(const std::vector<std::vector<uint32_t>>& producers) {
+			std::vector<uint32_t> stack;
+
+			for (uint32_t i = 0; i < m_passes.size(); ++i) {
+				auto& pass = m_passes[i];
+				pass.culled = true;
+
+				bool root = pass.side_effects;
+				for (auto& access : pass.images) {
+					auto& image = m_images[access.resource];
+					root |= getAccessInfo(access.access).write && (image.imported || image.output);
+				}
+				for (auto& access : pass.buffers) {
+					root |= getAccessInfo(access.access).write;
+				}
+
+				if (root) {
+					stack.push_back(i);
+				}
+			}
+
+			while (!stack.empty()) {
+				auto pass_index = stack.back();
+				stack.pop_back();
+
+				if (!m_passes[pass_index].culled) {
+					continue;
+				}
+				m_passes[pass_index].culled = false;
+
+				for (auto producer : producers[pass_index]) {
+					stack.push_back(producer);
+				}
+			}
+		}
+
+		void RenderGraph::orderPasses(const std::vector<std::vector<uint32_t>>& successors) {
+			std::vector<uint32_t> in_degree(m_passes.size(), 0);
+			for (uint32_t i = 0; i < m_passes.size(); ++i) {
+				if (m_passes[i].culled) {
+					continue;
+				}
+				for (auto successor : successors[i]) {
+					if (!m_passes[successor].culled) {
+						in_degree[successor]++;
+					}
+				}
+			}
+
+			// Ready passes run in declaration order so the result is deterministic
+			std::priority_queue<uint32_t, std::vector<uint32_t>, std::greater<uint32_t>> ready;
+			for (uint32_t i = 0; i < m_passes.size(); ++i) {
+				if (!m_passes[i].culled && in_degree[i] == 0) {
+					ready.push(i);
+				}
+			}
+
+			m_order.clear();
+			while (!ready.empty()) {
+				auto pass_index = ready.top();
+				ready.pop();
+				m_order.push_back(pass_index);
+
+				for (auto successor : successors[pass_index]) {
+					if (!m_passes[successor].culled && --in_degree[successor] == 0) {
+						ready.push(successor);
+					}
+				}
+			}
+		}
+
+		void RenderGraph::allocateTransients() {
+			std::vector<uint32_t> transients;
+			for (uint32_t i = 0; i < m_images.size(); ++i) {
+				if (!m_images[i].imported && m_images[i].first_use != ~0u) {
+					transients.push_back(i);
+				}
+			}
+
+			std::sort(transients.begin(), transients.end(),
+				[this](uint32_t lhs, uint32_t rhs) { return m_images[lhs].first_use < m_images[rhs].first_use; });
+
+			for (auto index : transients) {
+				auto& image = m_images[index];
+
+				vk::ImageCreateInfo create_info({}, vk::ImageType::e2D, image.desc.format, image.desc.extent, 1, 1,
+					image.desc.samples, vk::ImageTiling::eOptimal, image.desc.usage);
+
+				image.transients.resize(m_frame_count);
+				for (auto& transient : image.transients) {
+					transient.handle = m_device.getHandle().createImage(create_info);
+				}
+
+				// Every frame slot gets the same memory layout
+				auto requirements = m_device.getHandle().getImageMemoryRequirements(image.transients[0].handle);
+				m_unaliased_memory_size += requirements.size * m_frame_count;
+
+				// Reuse the block whose previous occupant is dead and which has to grow the least
+				uint32_t best_block = ~0u;
+				vk::DeviceSize best_growth = 0;
+				for (uint32_t b = 0; b < m_memory_blocks.size(); ++b) {
+					auto& block = m_memory_blocks[b];
+					if (block.last_use >= image.first_use || !(block.requirements.memoryTypeBits & requirements.memoryTypeBits)) {
+						continue;
+					}
+
+					vk::DeviceSize growth = requirements.size > block.requirements.size ? requirements.size - block.requirements.size : 0;
+					if (best_block == ~0u || growth < best_growth) {
+						best_block = b;
+						best_growth = growth;
+					}
+				}
+
+				if (best_block == ~0u) {
+					MemoryBlock block{};
+					block.requirements = requirements;
+					m_memory_blocks.push_back(block);
+					best_block = static_cast<uint32_t>(m_memory_blocks.size() - 1);
+				}
+
+				auto& block = m_memory_blocks[best_block];
+				block.requirements.size = std::max(block.requirements.size, requirements.size);
+				block.requirements.alignment = std::max(block.requirements.alignment, requirements.alignment);
+				block.requirements.memoryTypeBits &= requirements.memoryTypeBits;
+				block.last_use = image.last_use;
+
+				image.alias_predecessor = block.last_image;
+				image.memory_block = best_block;
+				block.last_image = index;
+			}
+
+			VmaAllocationCreateInfo allocation_create_info{};
+			allocation_create_info.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+
+			for (auto& block : m_memory_blocks) {
+				VkMemoryRequirements requirements = block.requirements;
+				block.allocations.resize(m_frame_count, VK_NULL_HANDLE);
+
+				for (auto& allocation : block.allocations) {
+					if (vmaAllocateMemory(alloc::getMemoryAllocator(), &requirements, &allocation_create_info, &allocation, nullptr) != VK_SUCCESS) {
+						throw std::runtime_error("[RenderGraph] ERROR: Failed to allocate transient image memory");
+					}
+				}
+				m_transient_memory_size += block.requirements.size * m_frame_count;
+			}
+
+			for (auto index : transients) {
+				auto& image = m_images[index];
+
+				for (uint32_t slot = 0; slot < m_frame_count; ++slot) {
+					auto& transient = image.transients[slot];
+
+					if (vmaBindImageMemory(alloc::getMemoryAllocator(), m_memory_blocks[image.memory_block].allocations[slot], transient.handle) != VK_SUCCESS) {
+						throw std::runtime_error("[RenderGraph] ERROR: Failed to bind transient image memory");
+					}
+
+					transient.image = std::make_unique<core::ImageCPP>(m_device, transient.handle, image.desc.extent, image.desc.format, image.desc.usage);
+					transient.image->setDebugName(image.name);
+					transient.view = std::make_unique<core::ImageViewCPP>(*transient.image, vk::ImageViewType::e2D);
+				}
+
+				image.view = image.transients[0].view.get();
+			}
+
+			if (!transients.empty()) {
+				LOGI("[RenderGraph] {} transient images for {} frame slots in {} bytes ({} bytes without aliasing)",
+					transients.size(), m_frame_count, m_transient_memory_size, m_unaliased_memory_size);
+			}
+		}
+
+		void RenderGraph::releaseTransients() {
+			// Frames still in flight may be using the transient images and their memory
+			if (!m_memory_blocks.empty()) {
+				m_device.getHandle().waitIdle();
+			}
+
+			for (auto& image : m_images) {
+				if (image.imported) {
+					continue;
+				}
+
+				image.view = nullptr;
+
+				for (auto& transient : image.transients) {
+					transient.view.reset();
+					transient.image.reset();
+
+					if (transient.handle) {
+						m_device.getHandle().destroyImage(transient.handle);
+					}
+				}
+				image.transients.clear();
+
+				image.memory_block = ~0u;
+				image.alias_predecessor = ~0u;
+			}
+
+			for (auto& block : m_memory_blocks) {
+				for (auto allocation : block.allocations) {
+					vmaFreeMemory(alloc::getMemoryAllocator(), allocation);
+				}
+			}
+
+			m_memory_blocks.clear();
+			m_transient_memory_size = 0;
+			m_unaliased_memory_size = 0;
+			m_compiled = false;
+		}
+
+		bool RenderGraph::transition(ResourceState& state, RenderGraphAccess access, bool is_image,
+			vk::PipelineStageFlags2& src_stages, vk::AccessFlags2& src_access,
+			vk::PipelineStageFlags2& dst_stages, vk::AccessFlags2& dst_access)
+		{
+			auto info = getAccessInfo(access);
+			dst_stages = info.stages;
+			dst_access = info.access;
+
+			// Writes and layout transitions wait for everything since the last write
+			if (info.write || (is_image && state.layout != info.layout)) {
+				src_stages = state.write_stages | state.read_stages;
+				src_access = state.write_access;
+
+				if (is_image) {
+					state.layout = info.layout;
+				}
+				state.write_stages = info.stages;
+				state.write_access = info.access & WRITE_ACCESS_MASK;
+				state.read_stages = info.write ? vk::PipelineStageFlags2{} : info.stages;
+				state.visible_stages = info.stages;
+				state.visible_access = info.access;
+				return true;
+			}
+
+			// Reads only wait when the last write is not yet visible to them
+			bool visible = !(info.stages & ~state.visible_stages) && !(info.access & ~state.visible_access);
+			state.read_stages |= info.stages;
+
+			if (!state.write_stages || visible) {
+				return false;
+			}
+
+			src_stages = state.write_stages;
+			src_access = state.write_access;
+			state.visible_stages |= info.stages;
+			state.visible_access |= info.access;
+			return true;
+		}
+
+		void RenderGraph::addImageBarrier(Barriers& barriers, ImageHandle image, RenderGraphAccess access) {
+			auto& resource = m_images[image];
+			auto& state = resource.state;
+
+			// The first use of an aliased image waits for the last use of the image that held the memory before
+			if (!resource.imported && state.layout == vk::ImageLayout::eUndefined && !state.write_stages &&
+				resource.alias_predecessor != ~0u) {
+				auto& predecessor = m_images[resource.alias_predecessor].state;
+				state.write_stages = predecessor.write_stages | predecessor.read_stages;
+				state.write_access = predecessor.write_access;
+			}
+
+			auto old_layout = state.layout;
+			vk::PipelineStageFlags2 src_stages, dst_stages;
+			vk::AccessFlags2 src_access, dst_access;
+
+			if (!transition(state, access, true, src_stages, src_access, dst_stages, dst_access)) {
+				return;
+			}
+
+			auto& view = getImageView(image);
+			barriers.images.emplace_back(src_stages, src_access, dst_stages, dst_access, old_layout, state.layout,
+				VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, view.getImage().getHandle(), getBarrierRange(view));
+		}
+
+		void RenderGraph::addBufferBarrier(Barriers& barriers, BufferHandle buffer, RenderGraphAccess access) {
+			vk::PipelineStageFlags2 src_stages, dst_stages;
+			vk::AccessFlags2 src_access, dst_access;
+
+			if (!transition(m_buffers[buffer].state, access, false, src_stages, src_access, dst_stages, dst_access)) {
+				return;
+			}
+
+			barriers.buffers.emplace_back(src_stages, src_access, dst_stages, dst_access,
+				VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, getBuffer(buffer).getHandle(), 0, VK_WHOLE_SIZE);
+		}
+
+		void RenderGraph::flushBarriers(core::CommandBuffer& command_buffer, Barriers& barriers) {
+			if (barriers.images.empty() && barriers.buffers.empty()) {
+				return;
+			}
+
+			if (m_synchronization2) {
+				vk::DependencyInfo dependency_info({}, {}, barriers.buffers, barriers.images);
+				command_buffer.getHandle().pipelineBarrier2(dependency_info);
+			}
+			else {
+				// Without synchronization2 the whole batch becomes a single legacy barrier
+				vk::PipelineStageFlags src_stages, dst_stages;
+				std::vector<vk::ImageMemoryBarrier> image_barriers;
+				std::vector<vk::BufferMemoryBarrier> buffer_barriers;
+
+				for (auto& barrier : barriers.images) {
+					src_stages |= toLegacyStages(barrier.srcStageMask);
+					dst_stages |= toLegacyStages(barrier.dstStageMask);
+					image_barriers.emplace_back(toLegacyAccess(barrier.srcAccessMask), toLegacyAccess(barrier.dstAccessMask),
+						barrier.oldLayout, barrier.newLayout, barrier.srcQueueFamilyIndex, barrier.dstQueueFamilyIndex,
+						barrier.image, barrier.subresourceRange);
+				}
+
+				for (auto& barrier : barriers.buffers) {
+					src_stages |= toLegacyStages(barrier.srcStageMask);
+					dst_stages |= toLegacyStages(barrier.dstStageMask);
+					buffer_barriers.emplace_back(toLegacyAccess(barrier.srcAccessMask), toLegacyAccess(barrier.dstAccessMask),
+						barrier.srcQueueFamilyIndex, barrier.dstQueueFamilyIndex, barrier.buffer, barrier.offset, barrier.size);
+				}
+
+				if (!src_stages) {
+					src_stages = vk::PipelineStageFlagBits::eTopOfPipe;
+				}
+				if (!dst_stages) {
+					dst_stages = vk::PipelineStageFlagBits::eBottomOfPipe;
+				}
+
+				command_buffer.getHandle().pipelineBarrier(src_stages, dst_stages, {}, {}, buffer_barriers, image_barriers);
+			}
+
+			barriers.images.clear();
+			barriers.buffers.clear();
+		}
+
+		void RenderGraph::execute(core::CommandBuffer& command_buffer, uint32_t frame_index) {
+			assert(frame_index < m_frame_count && "[RenderGraph] ASSERT: Frame index out of range");
+
+			if (!m_compiled) {
+				compile();
+			}
+
+			// Earlier writes in the initial stages are always waited for, imported contents are only kept when the initial layout keeps them
+			for (auto& image : m_images) {
+				image.state = {};
+				if (!image.imported && !image.transients.empty()) {
+					image.view = image.transients[frame_index].view.get();
+				}
+				else if (image.imported) {
+					assert(image.view && "[RenderGraph] ASSERT: Imported image has no view bound");
+					assert((image.view->getImage().getUsage() & image.desc.usage) == image.desc.usage &&
+						"[RenderGraph] ASSERT: Imported image lacks the usage its accesses need");
+					image.state.layout = image.initial_layout;
+					image.state.write_stages = image.initial_stages;
+					if (image.initial_stages) {
+						image.state.write_access = vk::AccessFlagBits2::eMemoryWrite;
+					}
+				}
+			}
+
+			for (auto& buffer : m_buffers) {
+				assert(buffer.buffer && "[RenderGraph] ASSERT: Imported buffer is not bound");
+				buffer.state = {};
+				buffer.state.write_stages = vk::PipelineStageFlagBits2::eAllCommands;
+				buffer.state.write_access = vk::AccessFlagBits2::eMemoryWrite;
+			}
+
+			Barriers barriers;
+
+			for (auto pass_index : m_order) {
+				auto& pass = m_passes[pass_index];
+
+				for (auto& access : pass.images) {
+					addImageBarrier(barriers, access.resource, access.access);
+				}
+				for (auto& access : pass.buffers) {
+					addBufferBarrier(barriers, access.resource, access.access);
+				}
+				flushBarriers(command_buffer, barriers);
+
+				if (pass.execute) {
+					core::ScopedDebugLabel pass_debug_label{ command_buffer, pass.name };
+					pass.execute(command_buffer);
+				}
+			}
+
+			for (uint32_t i = 0; i < m_images.size(); ++i) {
+				auto& image = m_images[i];
+				if (!image.imported || image.final_layout == vk::ImageLayout::eUndefined || image.state.layout == image.final_layout) {
+					continue;
+				}
+
+				auto& view = getImageView(i);
+				barriers.images.emplace_back(image.state.write_stages | image.state.read_stages, image.state.write_access,
+					vk::PipelineStageFlagBits2::eBottomOfPipe, vk::AccessFlags2{}, image.state.layout, image.final_layout,
+					VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, view.getImage().getHandle(), getBarrierRange(view));
+				image.state.layout = image.final_layout;
+			}
+			flushBarriers(command_buffer, barriers);
+		}
+
+		const core::ImageViewCPP& RenderGraph::getImageView(ImageHandle image) const {
+			assert(m_images[image].view && "[RenderGraph] ASSERT: Image has no view, it was culled or not bound");
+			return *m_images[image].view;
+		}
+
+		const common::Buffer& RenderGraph::getBuffer(BufferHandle buffer) const {
+			assert(m_buffers[buffer].buffer && "[RenderGraph] ASSERT: Buffer is not bound");
+			return *m_buffers[buffer].buffer;
+		}
+
+		bool RenderGraph::isPassCulled(uint32_t pass_index) const {
+			return m_passes[pass_index].culled;
+		}
+
+		uint32_t RenderGraph::getFrameCount() const {
+			return m_frame_count;
+		}
+
+		vk::DeviceSize RenderGraph::getTransientMemorySize() const {
+			return m_transient_memory_size;
+		}
+
+		vk::DeviceSize RenderGraph::getUnaliasedMemorySize() const {
+			return m_unaliased_memory_size;
+		}
+	}
+}
@@ -0,0 +1,215 @@
+/* Copyright (c) 2025, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/buffer.h"
+#include "core/image.h"
+#include "core/image_view.h"
+
+namespace frame {
+	namespace core {
+		class CommandBuffer;
+		class Device;
+	}
+
+	namespace rendering {
+		enum class RenderGraphAccess {
+			ColorAttachment,
+			DepthAttachment,
+			DepthAttachmentRead,
+			SampledRead,
+			StorageRead,
+			StorageWrite,
+			TransferRead,
+			TransferWrite,
+			VertexRead,
+			IndexRead,
+			IndirectRead,
+			UniformRead
+		};
+
+		struct RenderGraphImageDesc {
+			vk::Extent3D extent{ 1, 1, 1 };
+			vk::Format format{ vk::Format::eUndefined };
+			vk::ImageUsageFlags usage{};
+			vk::SampleCountFlagBits samples{ vk::SampleCountFlagBits::e1 };
+		};
+
+		/*
+		 * Frame graph of passes that declare the images and buffers they access.
+		 * compile() orders the passes by their dependencies, drops passes that contribute nothing to an
+		 * imported resource, an output or a pass with side effects, and places transient images whose
+		 * lifetimes do not overlap in the same device memory.
+		 * execute() records one batched barrier per pass (synchronization2 when enabled) before running it.
+		 * Transient images start every frame undefined; imported images start in their initial layout after
+		 * writes in the given stages, which are waited for even when the initial layout discards the contents,
+		 * and are left in their final layout. Pass callbacks must leave every image in the layout implied
+		 * by its declared access.
+		 * Transient images and their memory exist once per frame slot and execute() uses the set of the given slot,
+		 * so frames in flight never share them. Releasing them, on recompilation or destruction, waits for the device.
+		 */
+		class RenderGraph {
+		public:
+			using ImageHandle = uint32_t;
+			using BufferHandle = uint32_t;
+			using ExecuteFunc = std::function<void(core::CommandBuffer&)>;
+
+			class PassBuilder {
+			public:
+				PassBuilder(RenderGraph& graph, uint32_t pass_index);
+
+				PassBuilder& useImage(ImageHandle image, RenderGraphAccess access);
+				PassBuilder& useBuffer(BufferHandle buffer, RenderGraphAccess access);
+				PassBuilder& setSideEffects();
+
+			private:
+				RenderGraph& m_graph;
+				uint32_t m_pass_index;
+			};
+
+			RenderGraph(core::Device& device, bool synchronization2 = false, uint32_t frame_count = 1);
+			~RenderGraph();
+
+			RenderGraph(const RenderGraph&) = delete;
+			RenderGraph& operator=(const RenderGraph&) = delete;
+
+			ImageHandle createImage(const std::string& name, const RenderGraphImageDesc& desc);
+			ImageHandle importImage(const std::string& name,
+				vk::ImageLayout initial_layout = vk::ImageLayout::eUndefined,
+				vk::ImageLayout final_layout = vk::ImageLayout::eUndefined,
+				vk::PipelineStageFlags2 initial_stages = vk::PipelineStageFlagBits2::eAllCommands);
+			BufferHandle importBuffer(const std::string& name);
+
+			void setImportedImage(ImageHandle image, const core::ImageViewCPP& view);
+			void setImportedBuffer(BufferHandle buffer, const common::Buffer& resource);
+			void setOutput(ImageHandle image);
+
+			PassBuilder addPass(const std::string& name, ExecuteFunc&& execute);
+
+			void compile();
+			void execute(core::CommandBuffer& command_buffer, uint32_t frame_index = 0);
+
+			const core::ImageViewCPP& getImageView(ImageHandle image) const;
+			const common::Buffer& getBuffer(BufferHandle buffer) const;
+
+			bool isPassCulled(uint32_t pass_index) const;
+			uint32_t getFrameCount() const;
+			vk::DeviceSize getTransientMemorySize() const;
+			vk::DeviceSize getUnaliasedMemorySize() const;
+
+		private:
+			struct Access {
+				uint32_t resource;
+				RenderGraphAccess access;
+			};
+
+			struct Pass {
+				std::string name;
+				ExecuteFunc execute;
+				std::vector<Access> images;
+				std::vector<Access> buffers;
+				bool side_effects{ false };
+				bool culled{ false };
+			};
+
+			struct ResourceState {
+				vk::ImageLayout layout{ vk::ImageLayout::eUndefined };
+				vk::PipelineStageFlags2 write_stages{};
+				vk::AccessFlags2 write_access{};
+				vk::PipelineStageFlags2 read_stages{};
+				vk::PipelineStageFlags2 visible_stages{};
+				vk::AccessFlags2 visible_access{};
+			};
+
+			struct TransientImage {
+				vk::Image handle;
+				std::unique_ptr<core::ImageCPP> image;
+				std::unique_ptr<core::ImageViewCPP> view;
+			};
+
+			struct ImageResource {
+				std::string name;
+				RenderGraphImageDesc desc;
+				bool imported{ false };
+				bool output{ false };
+				vk::ImageLayout initial_layout{ vk::ImageLayout::eUndefined };
+				vk::ImageLayout final_layout{ vk::ImageLayout::eUndefined };
+				vk::PipelineStageFlags2 initial_stages{};
+				const core::ImageViewCPP* view{ nullptr };
+
+				// Transient storage, one per frame slot
+				std::vector<TransientImage> transients;
+				uint32_t memory_block{ ~0u };
+				uint32_t alias_predecessor{ ~0u };
+				uint32_t first_use{ ~0u };
+				uint32_t last_use{ 0 };
+
+				ResourceState state;
+			};
+
+			struct BufferResource {
+				std::string name;
+				const common::Buffer* buffer{ nullptr };
+				ResourceState state;
+			};
+
+			struct MemoryBlock {
+				vk::MemoryRequirements requirements;
+				uint32_t last_use{ 0 };
+				uint32_t last_image{ ~0u };
+				// One per frame slot
+				std::vector<VmaAllocation> allocations;
+			};
+
+			struct Barriers {
+				std::vector<vk::ImageMemoryBarrier2> images;
+				std::vector<vk::BufferMemoryBarrier2> buffers;
+			};
+
+			void cullPasses(const std::vector<std::vector<uint32_t>>& producers);
+			void orderPasses(const std::vector<std::vector<uint32_t>>& successors);
+			void allocateTransients();
+			void releaseTransients();
+
+			bool transition(ResourceState& state, RenderGraphAccess access, bool is_image,
+				vk::PipelineStageFlags2& src_stages, vk::AccessFlags2& src_access,
+				vk::PipelineStageFlags2& dst_stages, vk::AccessFlags2& dst_access);
+			void addImageBarrier(Barriers& barriers, ImageHandle image, RenderGraphAccess access);
+			void addBufferBarrier(Barriers& barriers, BufferHandle buffer, RenderGraphAccess access);
+			void flushBarriers(core::CommandBuffer& command_buffer, Barriers& barriers);
+
+			core::Device& m_device;
+			bool m_synchronization2;
+			uint32_t m_frame_count;
+			bool m_compiled{ false };
+			std::vector<Pass> m_passes;
+			std::vector<uint32_t> m_order;
+			std::vector<ImageResource> m_images;
+			std::vector<BufferResource> m_buffers;
+			std::vector<MemoryBlock> m_memory_blocks;
+			vk::DeviceSize m_transient_memory_size{ 0 };
+			vk::DeviceSize m_unaliased_memory_size{ 0 };
+		};
+	}
+}
@@ -50,6 +50,12 @@ namespace frame {
                         attachment.setStencilStoreOp(load_store_infos[i].m_store_op);
                     }
 
+                    // Transient attachments never outlive the render pass
+                    if (attachments[i].usage & vk::ImageUsageFlagBits::eTransientAttachment) {
+                        attachment.setStoreOp(vk::AttachmentStoreOp::eDontCare);
+                        attachment.setStencilStoreOp(vk::AttachmentStoreOp::eDontCare);
+                    }
+
                     attachment_descriptions.push_back(attachment);
                 }
 
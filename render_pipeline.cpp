@@ -30,6 +30,42 @@
 
 namespace frame {
     namespace rendering {
+        namespace {
+            bool writesAttachment(const Subpass& subpass, const std::vector<Attachment>& attachments, uint32_t attachment) {
+                const auto& outputs = subpass.getOutputAttachments();
+                const auto& resolves = subpass.getColorResolveAttachments();
+
+                if (std::find(outputs.begin(), outputs.end(), attachment) != outputs.end() ||
+                    std::find(resolves.begin(), resolves.end(), attachment) != resolves.end()) {
+                    return true;
+                }
+
+                if (subpass.getDisableDepthStencilAttachment()) {
+                    return false;
+                }
+
+                if (subpass.getDepthStencilResolveMode() != vk::ResolveModeFlagBits::eNone &&
+                    subpass.getDepthStencilResolveAttachment() == attachment) {
+                    return true;
+                }
+
+                return common::isDepthFormat(attachments[attachment].format);
+            }
+
+            void attachmentBarrier(core::CommandBuffer& command_buffer) {
+                vk::MemoryBarrier attachment_barrier(
+                    vk::AccessFlagBits::eColorAttachmentWrite | vk::AccessFlagBits::eDepthStencilAttachmentWrite,
+                    vk::AccessFlagBits::eColorAttachmentRead | vk::AccessFlagBits::eColorAttachmentWrite |
+                    vk::AccessFlagBits::eDepthStencilAttachmentRead | vk::AccessFlagBits::eDepthStencilAttachmentWrite);
+
+                command_buffer.getHandle().pipelineBarrier(
+                    vk::PipelineStageFlagBits::eColorAttachmentOutput | vk::PipelineStageFlagBits::eLateFragmentTests,
+                    vk::PipelineStageFlagBits::eColorAttachmentOutput | vk::PipelineStageFlagBits::eEarlyFragmentTests |
+                    vk::PipelineStageFlagBits::eLateFragmentTests,
+                    {}, attachment_barrier, {}, {});
+            }
+        }
+
         RenderPipeline::RenderPipeline(std::vector<std::unique_ptr<Subpass>>&& subpasses) :
             m_subpasses{ std::move(subpasses) }
         {
@@ -52,6 +88,11 @@ namespace frame {
         }
 
         void RenderPipeline::addSubpass(std::unique_ptr<Subpass>&& subpass) {
+            if (m_dynamic_rendering && !subpass->getInputAttachments().empty()) {
+                throw std::runtime_error("[RenderPipeline] ERROR: Subpasses reading input attachments require the render pass path");
+            }
+
+            subpass->setLateDrawsSupported(m_dynamic_rendering);
             subpass->prepare();
             m_subpasses.emplace_back(std::move(subpass));
         }
@@ -80,6 +121,64 @@ namespace frame {
             m_clear_value = clear_values;
         }
 
+        void RenderPipeline::setDynamicRendering(bool enable) {
+            for (auto& subpass : m_subpasses) {
+                if (enable && !subpass->getInputAttachments().empty()) {
+                    throw std::runtime_error("[RenderPipeline] ERROR: Subpasses reading input attachments require the render pass path");
+                }
+            }
+
+            m_dynamic_rendering = enable;
+
+            // A render pass cannot be ended inside a subpass, its subpasses run phase 2 culling after it instead
+            for (auto& subpass : m_subpasses) {
+                subpass->setLateDrawsSupported(enable);
+            }
+        }
+
+        bool RenderPipeline::isDynamicRendering() const {
+            return m_dynamic_rendering;
+        }
+
+        std::vector<LoadStoreInfo> RenderPipeline::getRenderingLoadStore(size_t subpass_index, const RenderTarget& render_target, bool late_scope) const {
+            const auto& attachments = render_target.getAttachments();
+            std::vector<LoadStoreInfo> load_store(attachments.size());
+
+            for (uint32_t i = 0; i < attachments.size(); ++i) {
+                if (i < m_load_store.size()) {
+                    load_store[i] = m_load_store[i];
+                }
+
+                bool written_before = false;
+                bool written_after = false;
+
+                for (size_t j = 0; j < m_subpasses.size(); ++j) {
+                    if (j != subpass_index && writesAttachment(*m_subpasses[j], attachments, i)) {
+                        (j < subpass_index ? written_before : written_after) = true;
+                    }
+                }
+
+                // Late draws continue on what the first scope of the same subpass wrote
+                bool written_here = writesAttachment(*m_subpasses[subpass_index], attachments, i);
+                if (written_here && m_subpasses[subpass_index]->hasLateDraws()) {
+                    (late_scope ? written_before : written_after) = true;
+                }
+
+                // Attachments shared between rendering scopes keep their contents across them
+                if (written_before) {
+                    load_store[i].m_load_op = vk::AttachmentLoadOp::eLoad;
+                }
+                if (written_after) {
+                    load_store[i].m_store_op = vk::AttachmentStoreOp::eStore;
+                }
+                else if (attachments[i].usage & vk::ImageUsageFlagBits::eTransientAttachment) {
+                    load_store[i].m_store_op = vk::AttachmentStoreOp::eDontCare;
+                }
+            }
+
+            return load_store;
+        }
+
         void RenderPipeline::draw(core::CommandBuffer& command_buffer, RenderTarget& render_target, vk::SubpassContents contents) {
 
             assert(!m_subpasses.empty() && "Render pipeline should contain at least one sub-pass");
@@ -88,6 +187,14 @@ namespace frame {
                 m_clear_value.push_back(vk::ClearValue{ vk::ClearColorValue().setFloat32({0.0f, 0.0f, 0.0f, 1.0f}) });
             }
 
+            for (auto& subpass : m_subpasses) {
+                assert((!m_dynamic_rendering || subpass->getInputAttachments().empty()) &&
+                    "[RenderPipeline] ASSERT: Subpasses reading input attachments require the render pass path");
+
+                subpass->prepareRenderTarget(render_target);
+                subpass->prepareFrame(command_buffer);
+            }
+
             for (size_t i = 0; i < m_subpasses.size(); ++i) {
 
                 m_active_subpass_index = i;
@@ -95,24 +202,95 @@ namespace frame {
 
                 subpass->updateRenderTargetAttachments(render_target);
 
-                if (i == 0) {
-                    command_buffer.beginRenderPass(render_target, m_load_store, m_clear_value, m_subpasses, contents);
+                vk::SubpassContents subpass_contents = i == 0 ? contents : vk::SubpassContents::eInline;
+                if (subpass->getSubpassContents() == vk::SubpassContents::eSecondaryCommandBuffers) {
+                    subpass_contents = vk::SubpassContents::eSecondaryCommandBuffers;
+                }
+
+                m_active_contents = subpass_contents;
+
+                if (m_dynamic_rendering) {
+                    if (i > 0) {
+                        command_buffer.endRendering();
+
+                        attachmentBarrier(command_buffer);
+                    }
+
+                    command_buffer.beginRendering(render_target, getRenderingLoadStore(i, render_target), m_clear_value, *subpass, subpass_contents);
+                }
+                else if (i == 0) {
+                    command_buffer.beginRenderPass(render_target, m_load_store, m_clear_value, m_subpasses, subpass_contents);
                 }
                 else {
-                    command_buffer.nextSubpass();
+                    command_buffer.nextSubpass(subpass_contents);
                 }
 
                 if (subpass->getDebugName().empty()) {
                     subpass->setDebugName(fmt::format("RP subpass #{}", i));
                 }
-                core::ScopedDebugLabel subpass_debug_label{ command_buffer, subpass->getDebugName().c_str() };
 
-                subpass->draw(command_buffer);
+                if (subpass_contents == vk::SubpassContents::eSecondaryCommandBuffers) {
+                    subpass->draw(command_buffer);
+                }
+                else {
+                    core::ScopedDebugLabel subpass_debug_label{ command_buffer, subpass->getDebugName().c_str() };
+
+                    subpass->draw(command_buffer);
+                }
+
+                if (subpass->hasLateDraws()) {
+                    drawLate(command_buffer, render_target, i);
+                }
             }
 
             m_active_subpass_index = 0;
         }
 
+        void RenderPipeline::drawLate(core::CommandBuffer& command_buffer, RenderTarget& render_target, size_t subpass_index) {
+            auto& subpass = m_subpasses[subpass_index];
+
+            command_buffer.endRendering();
+
+            subpass->prepareLateDraws(command_buffer, render_target);
+
+            attachmentBarrier(command_buffer);
+
+            // Late draws are recorded inline whatever the subpass records into its first scope
+            command_buffer.beginRendering(render_target, getRenderingLoadStore(subpass_index, render_target, true), m_clear_value, *subpass, vk::SubpassContents::eInline);
+            m_active_contents = vk::SubpassContents::eInline;
+
+            std::string debug_name = fmt::format("{} (late)", subpass->getDebugName());
+            core::ScopedDebugLabel late_debug_label{ command_buffer, debug_name.c_str() };
+
+            subpass->drawLate(command_buffer);
+        }
+
+        void RenderPipeline::finishFrame(core::CommandBuffer& command_buffer, RenderTarget& render_target) {
+            for (auto& subpass : m_subpasses) {
+                subpass->finishFrame(command_buffer, render_target);
+            }
+        }
+
+        void RenderPipeline::dispatchCompute(core::CommandBuffer& command_buffer) {
+            for (auto& subpass : m_subpasses) {
+                if (subpass->getComputeWaitStage()) {
+                    subpass->dispatchCompute(command_buffer);
+                }
+            }
+        }
+
+        vk::PipelineStageFlags RenderPipeline::getComputeWaitStages() const {
+            vk::PipelineStageFlags wait_stages;
+            for (auto& subpass : m_subpasses) {
+                wait_stages |= subpass->getComputeWaitStage();
+            }
+            return wait_stages;
+        }
+
+        vk::SubpassContents RenderPipeline::getActiveSubpassContents() const {
+            return m_active_contents;
+        }
+
         std::unique_ptr<Subpass>& RenderPipeline::getActiveSubpass() {
             return m_subpasses[m_active_subpass_index];
         }
@@ -49,16 +49,46 @@ namespace frame {
             void addForwardSubpass(std::unique_ptr<subpass::ForwardSubpass>&& subpass);
             std::vector<std::unique_ptr<Subpass>>& getSubpasses();
 
+            /**
+             * @brief Records each subpass as its own dynamic rendering scope instead of a cached
+             *        render pass and framebuffer. Subpasses that read input attachments need the
+             *        render pass path, which remains the default for tile-based GPUs. Subpasses only
+             *        get a late draws scope with dynamic rendering, on the render pass path they run
+             *        that work after the pass and draw its results the next frame.
+             */
+            void setDynamicRendering(bool enable);
+            bool isDynamicRendering() const;
+
             void draw(core::CommandBuffer& command_buffer, RenderTarget& render_target,
                       vk::SubpassContents contents = vk::SubpassContents::eInline);
+
+            void finishFrame(core::CommandBuffer& command_buffer, RenderTarget& render_target);
+
+            /**
+             * @brief Records the async compute work of all subpasses into a compute queue command buffer.
+             *        getComputeWaitStages() returns the graphics stages that wait for it, none if there is no such work.
+             */
+            void dispatchCompute(core::CommandBuffer& command_buffer);
+            vk::PipelineStageFlags getComputeWaitStages() const;
             
             std::unique_ptr<Subpass>& getActiveSubpass();
 
+            // Contents of the rendering scope or subpass left open by draw(), which may differ from the
+            // last subpass's getSubpassContents() when it has late draws
+            vk::SubpassContents getActiveSubpassContents() const;
+
         private:
+            // late_scope selects the load and store operations of the subpass's late draws scope
+            std::vector<LoadStoreInfo> getRenderingLoadStore(size_t subpass_index, const RenderTarget& render_target, bool late_scope = false) const;
+
+            void drawLate(core::CommandBuffer& command_buffer, RenderTarget& render_target, size_t subpass_index);
+
             std::vector<std::unique_ptr<Subpass>> m_subpasses;
             std::vector<LoadStoreInfo> m_load_store = std::vector<LoadStoreInfo>(2);
             std::vector<vk::ClearValue> m_clear_value = std::vector<vk::ClearValue>(2);
             size_t m_active_subpass_index{ 0 };
+            vk::SubpassContents m_active_contents{ vk::SubpassContents::eInline };
+            bool m_dynamic_rendering{ false };
         };
     }
 }
@@ -0,0 +1,161 @@
+/* Copyright (c) 2025, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "rendering/render_queue.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+
+namespace frame {
+	namespace rendering {
+		uint64_t RenderQueue::makeKey(RenderLayer layer, uint32_t state_id, uint32_t quantized_depth) {
+			assert(quantized_depth <= MAX_DEPTH);
+
+			uint64_t key = static_cast<uint64_t>(layer) << 63;
+
+			if (layer == RenderLayer::Opaque) {
+				key |= static_cast<uint64_t>(state_id & 0x7FFFFFFFu) << 32;
+				key |= static_cast<uint64_t>(quantized_depth);
+			}
+			else {
+				key |= static_cast<uint64_t>(MAX_DEPTH - quantized_depth) << 39;
+				key |= static_cast<uint64_t>(state_id & 0x7FFFFFFFu) << 8;
+			}
+
+			return key;
+		}
+
+		uint64_t RenderQueue::makeInstancedKey(uint32_t state_id, uint32_t batch_id, uint32_t quantized_depth, RenderLayer layer) {
+			assert(quantized_depth <= MAX_DEPTH);
+
+			assert(batch_id <= MAX_BATCH_ID);
+
+			uint64_t key = static_cast<uint64_t>(layer) << 63;
+			key |= static_cast<uint64_t>(state_id & 0x7FFFFFFFu) << 32;
+			key |= static_cast<uint64_t>(1) << INSTANCED_BIT;
+			key |= static_cast<uint64_t>(batch_id) << 16;
+			key |= static_cast<uint64_t>(quantized_depth >> (DEPTH_BITS - 16));
+
+			return key;
+		}
+
+		uint32_t RenderQueue::makeStateId(uint32_t variant_id, uint32_t material_id) {
+			return (std::min(variant_id, MAX_VARIANT_ID) << 16) | std::min(material_id, MAX_MATERIAL_ID);
+		}
+
+		uint32_t RenderQueue::quantizeDepth(float distance, float max_distance) {
+			if (max_distance <= 0.0f) {
+				return 0;
+			}
+
+			float normalized = std::clamp(distance / max_distance, 0.0f, 1.0f);
+			return static_cast<uint32_t>(normalized * static_cast<float>(MAX_DEPTH));
+		}
+
+		RenderLayer RenderQueue::getLayer(uint64_t key) {
+			return static_cast<RenderLayer>(key >> 63);
+		}
+
+		void RenderQueue::clear() {
+			m_entries.clear();
+			m_items.clear();
+		}
+
+		void RenderQueue::reserve(size_t count) {
+			m_entries.reserve(count);
+			m_items.reserve(count);
+		}
+
+		void RenderQueue::push(uint64_t key, scene::Node& node, scene::SubMesh& sub_mesh, uint32_t quantized_depth, uint32_t lod) {
+			m_entries.push_back({ key, static_cast<uint32_t>(m_items.size()) });
+			m_items.push_back({ &node, &sub_mesh, quantized_depth, lod });
+		}
+
+		void RenderQueue::sort() {
+			const size_t count = m_entries.size();
+			if (count < 2) {
+				return;
+			}
+
+			m_scratch.resize(count);
+
+			std::array<std::array<uint32_t, 256>, 8> histograms{};
+
+			for (const auto& entry : m_entries) {
+				for (uint32_t pass = 0; pass < 8; pass++) {
+					histograms[pass][(entry.key >> (pass * 8)) & 0xFF]++;
+				}
+			}
+
+			Entry* src = m_entries.data();
+			Entry* dst = m_scratch.data();
+
+			for (uint32_t pass = 0; pass < 8; pass++) {
+				auto& histogram = histograms[pass];
+
+				// All keys share this digit, the pass would be a plain copy
+				if (histogram[(src[0].key >> (pass * 8)) & 0xFF] == count) {
+					continue;
+				}
+
+				uint32_t offset = 0;
+				for (auto& bucket : histogram) {
+					uint32_t bucket_count = bucket;
+					bucket = offset;
+					offset += bucket_count;
+				}
+
+				for (size_t i = 0; i < count; i++) {
+					dst[histogram[(src[i].key >> (pass * 8)) & 0xFF]++] = src[i];
+				}
+
+				std::swap(src, dst);
+			}
+
+			if (src != m_entries.data()) {
+				m_entries.swap(m_scratch);
+			}
+		}
+
+		size_t RenderQueue::size() const {
+			return m_entries.size();
+		}
+
+		bool RenderQueue::empty() const {
+			return m_entries.empty();
+		}
+
+		size_t RenderQueue::getLayerBegin(RenderLayer layer) const {
+			if (layer == RenderLayer::Opaque) {
+				return 0;
+			}
+
+			auto it = std::partition_point(m_entries.begin(), m_entries.end(),
+				[](const Entry& entry) { return getLayer(entry.key) == RenderLayer::Opaque; });
+			return static_cast<size_t>(std::distance(m_entries.begin(), it));
+		}
+
+		uint64_t RenderQueue::getKey(size_t index) const {
+			return m_entries[index].key;
+		}
+
+		const DrawItem& RenderQueue::operator[](size_t index) const {
+			return m_items[m_entries[index].item];
+		}
+	}
+}
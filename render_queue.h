@@ -0,0 +1,89 @@
+/* Copyright (c) 2025, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace frame {
+	namespace scene {
+		class Node;
+		class SubMesh;
+	}
+
+	namespace rendering {
+		enum class RenderLayer : uint8_t {
+			Opaque = 0,
+			Transparent = 1
+		};
+
+		struct DrawItem {
+			scene::Node* node;
+			scene::SubMesh* sub_mesh;
+			uint32_t depth;
+			uint32_t lod;
+		};
+
+		/*
+		 * Flat list of draws ordered by a 64-bit key.
+		 * Opaque keys:      layer(1) | state(31) | 0(8) | depth(24), front to back within a state
+		 * Instanced keys:   layer(1) | state(31) | 1(1) | batch(15) | depth(16), draws of one batch are contiguous and
+		 *                   follow the non-instanced draws of their state. Batch ids only have to be unique within a state.
+		 *                   Transparent draws use them too when blending does not depend on draw order.
+		 * Transparent keys: layer(1) | inverted depth(24) | state(31) | unused(8), back to front
+		 * The state is (pipeline variant id << 16 | material id). Storage is kept between frames.
+		 */
+		class RenderQueue {
+		public:
+			static constexpr uint32_t DEPTH_BITS = 24;
+			static constexpr uint32_t MAX_DEPTH = (1u << DEPTH_BITS) - 1;
+			static constexpr uint32_t MAX_VARIANT_ID = (1u << 15) - 1;
+			static constexpr uint32_t MAX_MATERIAL_ID = (1u << 16) - 1;
+			static constexpr uint32_t INSTANCED_BIT = 31;
+			static constexpr uint32_t MAX_BATCH_ID = (1u << 15) - 1;
+
+			static uint64_t makeKey(RenderLayer layer, uint32_t state_id, uint32_t quantized_depth);
+			static uint64_t makeInstancedKey(uint32_t state_id, uint32_t batch_id, uint32_t quantized_depth, RenderLayer layer = RenderLayer::Opaque);
+			static uint32_t makeStateId(uint32_t variant_id, uint32_t material_id);
+			static uint32_t quantizeDepth(float distance, float max_distance);
+			static RenderLayer getLayer(uint64_t key);
+
+			void clear();
+			void reserve(size_t count);
+			void push(uint64_t key, scene::Node& node, scene::SubMesh& sub_mesh, uint32_t quantized_depth = 0, uint32_t lod = 0);
+			void sort();
+
+			size_t size() const;
+			bool empty() const;
+			size_t getLayerBegin(RenderLayer layer) const;
+			uint64_t getKey(size_t index) const;
+			const DrawItem& operator[](size_t index) const;
+
+		private:
+			struct Entry {
+				uint64_t key;
+				uint32_t item;
+			};
+
+			std::vector<Entry> m_entries;
+			std::vector<Entry> m_scratch;
+			std::vector<DrawItem> m_items;
+		};
+	}
+}
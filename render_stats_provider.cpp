@@ -0,0 +1,60 @@
+/* Copyright (c) 2025, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "stats/render_stats_provider.h"
+
+#include "rendering/render_context.h"
+
+namespace frame {
+	namespace stats {
+		namespace {
+			const std::set<StatIndex> render_stats = {
+				StatIndex::scene_visible_draws,
+				StatIndex::scene_culled_draws,
+				StatIndex::scene_occluded_draws,
+				StatIndex::scene_base_triangles,
+				StatIndex::scene_lod_triangles,
+				StatIndex::frame_latency
+			};
+		}
+
+		RenderStatsProvider::RenderStatsProvider(std::set<StatIndex>& requested_stats, rendering::RenderContext& render_context) :
+			m_render_context(render_context)
+		{
+			for (auto index : render_stats) {
+				if (requested_stats.erase(index) > 0) {
+					m_available_stats.insert(index);
+				}
+			}
+		}
+
+		bool RenderStatsProvider::isAvailable(StatIndex index) const {
+			return m_available_stats.find(index) != m_available_stats.end();
+		}
+
+		StatsProvider::Counters RenderStatsProvider::sample(float delta_time) {
+			Counters frame_counters = m_render_context.consumeFrameCounters();
+
+			Counters res;
+			for (auto index : m_available_stats) {
+				auto it = frame_counters.find(index);
+				res[index].result = it != frame_counters.end() ? it->second.result : 0.0;
+			}
+			return res;
+		}
+	}
+}
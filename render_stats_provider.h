@@ -0,0 +1,39 @@
+/* Copyright (c) 2025, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "stats/stats_provider.h"
+
+namespace frame {
+	namespace rendering {
+		class RenderContext;
+	}
+
+	namespace stats {
+		class RenderStatsProvider : public StatsProvider {
+		public:
+			RenderStatsProvider(std::set<StatIndex>& requested_stats, rendering::RenderContext& render_context);
+			bool isAvailable(StatIndex index) const override;
+			Counters sample(float delta_time) override;
+
+		private:
+			rendering::RenderContext& m_render_context;
+			std::set<StatIndex> m_available_stats;
+		};
+	}
+}
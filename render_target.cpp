@@ -22,6 +22,132 @@
 
 namespace frame {
     namespace rendering {
+        namespace {
+            bool supportsLazilyAllocatedMemory(core::Device& device) {
+                const auto& memory_properties = device.getPhysicalDevice().getMemoryProperties();
+                for (uint32_t i = 0; i < memory_properties.memoryTypeCount; ++i) {
+                    if (memory_properties.memoryTypes[i].propertyFlags & vk::MemoryPropertyFlagBits::eLazilyAllocated) {
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            std::unique_ptr<RenderTarget> createGBufferTarget(core::ImageCPP&& image, bool compact, bool order_independent_transparency) {
+                std::vector<core::ImageCPP> images;
+                auto& device = image.getDevice();
+                auto extent = image.getExtent();
+
+                // if the image parameter is depth format, it is used for shadow mapping, render target contains only depth image
+                if (common::isDepthFormat(image.getFormat())) {
+                    images.push_back(std::move(image));
+                    return std::make_unique<RenderTarget>(std::move(images));
+                }
+                else {
+                    // depth image
+                    vk::Format depth_format = common::getSuitableDepthFormat(device.getPhysicalDevice().getHandle());
+                    core::ImageCPP depth_image{
+                        device,
+                        extent,
+                        depth_format,
+                        vk::ImageUsageFlagBits::eDepthStencilAttachment | vk::ImageUsageFlagBits::eSampled,
+                        VMA_MEMORY_USAGE_GPU_ONLY
+                    };
+                    images.push_back(std::move(depth_image));
+
+                    // original image
+                    images.emplace_back(std::move(image));
+
+                    // the G-buffer and transparency attachments are only read as input attachments within the render pass,
+                    // so they are transient and backed by lazily allocated memory where the device has it
+                    const vk::ImageUsageFlags transient_usage = vk::ImageUsageFlagBits::eColorAttachment |
+                        vk::ImageUsageFlagBits::eInputAttachment | vk::ImageUsageFlagBits::eTransientAttachment;
+                    const VmaMemoryUsage transient_memory_usage = supportsLazilyAllocatedMemory(device) ?
+                        VMA_MEMORY_USAGE_GPU_LAZILY_ALLOCATED : VMA_MEMORY_USAGE_GPU_ONLY;
+
+                    // albedo image
+                    core::ImageCPP albedo_image{
+                        device,
+                        extent,
+                        vk::Format::eR8G8B8A8Unorm,
+                        transient_usage,
+                        transient_memory_usage
+                    };
+                    images.push_back(std::move(albedo_image));
+
+                    // normal image, octahedral encoded in the compact layout
+                    core::ImageCPP normal_image{
+                        device,
+                        extent,
+                        compact ? vk::Format::eR16G16Snorm : vk::Format::eR16G16B16A16Sfloat,
+                        transient_usage,
+                        transient_memory_usage
+                    };
+                    images.push_back(std::move(normal_image));
+
+                    // material image, holds emissive in rgb and roughness in alpha in the compact layout
+                    core::ImageCPP material_image{
+                        device,
+                        extent,
+                        vk::Format::eR8G8B8A8Unorm,
+                        transient_usage,
+                        transient_memory_usage
+                    };
+                    images.push_back(std::move(material_image));
+
+                    // the compact layout reconstructs position from depth and packs metallic into the albedo alpha
+                    if (!compact) {
+                        // position image
+                        core::ImageCPP position_image{
+                            device,
+                            extent,
+                            vk::Format::eR16G16B16A16Sfloat,
+                            transient_usage,
+                            transient_memory_usage
+                        };
+                        images.push_back(std::move(position_image));
+
+                        // emissive image
+                        core::ImageCPP emissive_image{
+                            device,
+                            extent,
+                            vk::Format::eR8G8B8A8Unorm,
+                            transient_usage,
+                            transient_memory_usage
+                        };
+                        images.push_back(std::move(emissive_image));
+                    }
+
+                    // the transparency targets come last, the G-buffer attachment indices are the same with and without them
+                    if (order_independent_transparency) {
+                        // weighted-blended transparency accumulation image
+                        core::ImageCPP accumulation_image{
+                            device,
+                            extent,
+                            vk::Format::eR16G16B16A16Sfloat,
+                            transient_usage,
+                            transient_memory_usage
+                        };
+                        images.push_back(std::move(accumulation_image));
+
+                        // weighted-blended transparency revealage image, holds 1 - revealage so it clears to zero
+                        core::ImageCPP revealage_image{
+                            device,
+                            extent,
+                            vk::Format::eR16Sfloat,
+                            transient_usage,
+                            transient_memory_usage
+                        };
+                        images.push_back(std::move(revealage_image));
+                    }
+                }
+
+                auto render_target = std::make_unique<RenderTarget>(std::move(images));
+                render_target->setCompactGBuffer(compact);
+                return render_target;
+            }
+        }
+
         const RenderTarget::CreateFunc RenderTarget::DEFAULT_CREATE_FUNC = [](core::ImageCPP&& image) -> std::unique_ptr<RenderTarget> {
 
             std::vector<core::ImageCPP> images;
@@ -32,87 +158,22 @@ namespace frame {
 
         };
 
-        const RenderTarget::CreateFunc RenderTarget::CREATE_FUNC = [](core::ImageCPP&& image) -> std::unique_ptr<RenderTarget>
-        {
-            std::vector<core::ImageCPP> images;
-            auto& device = image.getDevice();
-            auto extent = image.getExtent();
+        const RenderTarget::CreateFunc RenderTarget::CREATE_FUNC = [](core::ImageCPP&& image) -> std::unique_ptr<RenderTarget> {
+            return createGBufferTarget(std::move(image), false, false);
+        };
 
-            // if the image parameter is depth format, it is used for shadow mapping, render target contains only depth image
-            if (common::isDepthFormat(image.getFormat())) {
-                images.push_back(std::move(image));
-                return std::make_unique<RenderTarget>(std::move(images));
-            }
-            else {
-                // depth image
-                vk::Format depth_format = common::getSuitableDepthFormat(device.getPhysicalDevice().getHandle());
-                core::ImageCPP depth_image{
-                    device,
-                    extent,
-                    depth_format,
-                    vk::ImageUsageFlagBits::eDepthStencilAttachment | vk::ImageUsageFlagBits::eSampled,
-                    VMA_MEMORY_USAGE_GPU_ONLY
-                };
-                images.push_back(std::move(depth_image));
-
-                // original image
-                images.emplace_back(std::move(image));
-
-                // albedo image
-                core::ImageCPP albedo_image{
-                    device,
-                    extent,
-                    vk::Format::eR8G8B8A8Unorm,
-                    vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eInputAttachment,
-                    VMA_MEMORY_USAGE_GPU_ONLY
-                };
-                images.push_back(std::move(albedo_image));
-
-                // normal image
-                core::ImageCPP normal_image{
-                    device,
-                    extent,
-                    vk::Format::eR16G16B16A16Sfloat,
-                    vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eInputAttachment,
-                    VMA_MEMORY_USAGE_GPU_ONLY
-                };
-                images.push_back(std::move(normal_image));
-
-                // material image
-                core::ImageCPP material_image{
-                    device,
-                    extent,
-                    vk::Format::eR8G8B8A8Unorm,
-                    vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eInputAttachment,
-                    VMA_MEMORY_USAGE_GPU_ONLY
-                };
-                images.push_back(std::move(material_image));
-
-                // position image
-                core::ImageCPP position_image{
-                    device,
-                    extent,
-                    vk::Format::eR16G16B16A16Sfloat,
-                    vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eInputAttachment,
-                    VMA_MEMORY_USAGE_GPU_ONLY
-                };
-                images.push_back(std::move(position_image));
-
-                // emissive image
-                core::ImageCPP emissive_image{
-                    device,
-                    extent,
-                    vk::Format::eR8G8B8A8Unorm,
-                    vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eInputAttachment,
-                    VMA_MEMORY_USAGE_GPU_ONLY
-                };
-                images.push_back(std::move(emissive_image));
+        const RenderTarget::CreateFunc RenderTarget::COMPACT_CREATE_FUNC = [](core::ImageCPP&& image) -> std::unique_ptr<RenderTarget> {
+            return createGBufferTarget(std::move(image), true, false);
+        };
 
-            }
+        const RenderTarget::CreateFunc RenderTarget::OIT_CREATE_FUNC = [](core::ImageCPP&& image) -> std::unique_ptr<RenderTarget> {
+            return createGBufferTarget(std::move(image), false, true);
+        };
 
-            return std::make_unique<RenderTarget>(std::move(images));
+        const RenderTarget::CreateFunc RenderTarget::COMPACT_OIT_CREATE_FUNC = [](core::ImageCPP&& image) -> std::unique_ptr<RenderTarget> {
+            return createGBufferTarget(std::move(image), true, true);
         };
-        
+
         RenderTarget::RenderTarget(std::vector<core::ImageCPP>&& images_) :
             m_device{ images_.back().getDevice() },
             m_images{ std::move(images_) }
@@ -211,6 +272,22 @@ namespace frame {
             return m_output_attachments;
         }
 
+        void RenderTarget::setCompactGBuffer(bool compact) {
+            m_compact_gbuffer = compact;
+        }
+
+        bool RenderTarget::isCompactGBuffer() const {
+            return m_compact_gbuffer;
+        }
+
+        uint32_t RenderTarget::getAccumulationAttachment(bool compact) {
+            return compact ? 5 : 7;
+        }
+
+        uint32_t RenderTarget::getRevealageAttachment(bool compact) {
+            return compact ? 6 : 8;
+        }
+
         void RenderTarget::setLayout(uint32_t attachment, vk::ImageLayout layout) {
             m_attachments[attachment].initial_layout = layout;
         }
@@ -270,6 +347,9 @@ namespace frame {
         }
 
         const core::ImageViewCPP& RenderTarget::getPositionView() const {
+            if (m_compact_gbuffer) {
+                throw std::runtime_error("[RenderTarget] ERROR: The compact G-buffer has no position view");
+            }
             if (m_views.size() > 5) {
                 return m_views[5];
             }
@@ -280,6 +360,9 @@ namespace frame {
         }
 
         const core::ImageViewCPP& RenderTarget::getEmissiveView() const {
+            if (m_compact_gbuffer) {
+                throw std::runtime_error("[RenderTarget] ERROR: The compact G-buffer has no emissive view");
+            }
             if (m_views.size() > 6) {
                 return m_views[6];
             }
@@ -288,5 +371,27 @@ namespace frame {
                 throw std::runtime_error("Views array out of range");
             }
         }
+
+        const core::ImageViewCPP& RenderTarget::getAccumulationView() const {
+            const uint32_t attachment = getAccumulationAttachment(m_compact_gbuffer);
+            if (m_views.size() > attachment) {
+                return m_views[attachment];
+            }
+            else {
+                LOGE("Current render target has no accumulation view");
+                throw std::runtime_error("Views array out of range");
+            }
+        }
+
+        const core::ImageViewCPP& RenderTarget::getRevealageView() const {
+            const uint32_t attachment = getRevealageAttachment(m_compact_gbuffer);
+            if (m_views.size() > attachment) {
+                return m_views[attachment];
+            }
+            else {
+                LOGE("Current render target has no revealage view");
+                throw std::runtime_error("Views array out of range");
+            }
+        }
     }
 }
@@ -48,6 +48,19 @@ namespace frame {
             
             static const CreateFunc CREATE_FUNC;
             static const CreateFunc DEFAULT_CREATE_FUNC;
+            // Drops the position and emissive targets: position is reconstructed from depth, normals are octahedral RG16,
+            // metallic goes to the albedo alpha and the material target holds emissive and roughness
+            static const CreateFunc COMPACT_CREATE_FUNC;
+            // The G-buffer layouts followed by the weighted-blended transparency accumulation and revealage targets
+            static const CreateFunc OIT_CREATE_FUNC;
+            // In all G-buffer layouts only depth and the color image passed in can be sampled. The albedo, normal, material,
+            // position, emissive and transparency targets are transient input attachments without the sampled usage, they can
+            // only be read by later subpasses of the same render pass. Passes sampling them need a create function that adds it
+            static const CreateFunc COMPACT_OIT_CREATE_FUNC;
+
+            // Attachment indices of the weighted-blended transparency targets for either G-buffer layout, OIT targets only
+            static uint32_t getAccumulationAttachment(bool compact);
+            static uint32_t getRevealageAttachment(bool compact);
 
             RenderTarget(std::vector<core::ImageCPP>&& images);
             RenderTarget(std::vector<core::ImageViewCPP>&& image_views);
@@ -70,6 +83,11 @@ namespace frame {
             void setOutputAttachments(std::vector<uint32_t>& output);
             const std::vector<uint32_t>& getOutputAttachments() const;
 
+            // Set by the compact create functions. The geometry, deferred and OIT subpasses read it every frame
+            // to pick their shader variants and attachments, there is no separate switch on the subpasses
+            void setCompactGBuffer(bool compact);
+            bool isCompactGBuffer() const;
+
             void setLayout(uint32_t attachment, vk::ImageLayout layout);
             vk::ImageLayout getLayout(uint32_t attachment) const;
 
@@ -80,6 +98,8 @@ namespace frame {
         	const core::ImageViewCPP& getMaterialView() const;
             const core::ImageViewCPP& getPositionView() const;
             const core::ImageViewCPP& getEmissiveView() const;
+            const core::ImageViewCPP& getAccumulationView() const;
+            const core::ImageViewCPP& getRevealageView() const;
         private:
             core::Device const& m_device;
             vk::Extent2D m_extent;
@@ -88,6 +108,7 @@ namespace frame {
             std::vector<Attachment> m_attachments;
             std::vector<uint32_t> m_input_attachments = {};
             std::vector<uint32_t> m_output_attachments = { 0 };
+            bool m_compact_gbuffer{ false };
         };
     }
 }
\ No newline at end of file
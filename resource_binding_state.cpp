@@ -26,11 +26,22 @@ namespace frame {
         }
 
         bool ResourceSet::isDirty() const {
-            return m_dirty;
+            return m_dirty || m_offset_dirty;
+        }
+
+        bool ResourceSet::isOffsetDirtyOnly() const {
+            return !m_dirty && m_offset_dirty;
         }
 
         void ResourceSet::clearDirty() {
             m_dirty = false;
+            m_offset_dirty = false;
+
+            for (auto& binding_it : m_resource_bindings) {
+                for (auto& element_it : binding_it.second) {
+                    element_it.second.m_dirty = false;
+                }
+            }
         }
 
         void ResourceSet::clearDirty(uint32_t binding, uint32_t array_element) {
@@ -40,10 +51,22 @@ namespace frame {
         void ResourceSet::bindBuffer(const common::Buffer& buffer, vk::DeviceSize offset, vk::DeviceSize range,
             uint32_t binding, uint32_t array_element)
         {
-            m_resource_bindings[binding][array_element].m_dirty = true;
-            m_resource_bindings[binding][array_element].m_buffer = &buffer;
-            m_resource_bindings[binding][array_element].m_offset = offset;
-            m_resource_bindings[binding][array_element].m_range = range;
+            auto& resource_info = m_resource_bindings[binding][array_element];
+
+            // Rebinding the same buffer range at another offset can be served by a dynamic offset
+            if (resource_info.m_buffer == &buffer && resource_info.m_range == range && resource_info.m_image_view == nullptr) {
+                if (resource_info.m_offset != offset) {
+                    resource_info.m_dirty = true;
+                    resource_info.m_offset = offset;
+                    m_offset_dirty = true;
+                }
+                return;
+            }
+
+            resource_info.m_dirty = true;
+            resource_info.m_buffer = &buffer;
+            resource_info.m_offset = offset;
+            resource_info.m_range = range;
 
             m_dirty = true;
         }
@@ -51,6 +74,11 @@ namespace frame {
         void ResourceSet::bindImage(const core::ImageViewCPP& image_view, const core::Sampler& sampler,
             uint32_t binding, uint32_t array_element)
         {
+            auto& resource_info = m_resource_bindings[binding][array_element];
+            if (resource_info.m_image_view == &image_view && resource_info.m_sampler == &sampler) {
+                return;
+            }
+
             m_resource_bindings[binding][array_element].m_dirty = true;
             m_resource_bindings[binding][array_element].m_image_view = &image_view;
             m_resource_bindings[binding][array_element].m_sampler = &sampler;
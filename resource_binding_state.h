@@ -43,6 +43,7 @@ namespace frame {
         public:
             void reset();
             bool isDirty() const;
+            bool isOffsetDirtyOnly() const;
             void clearDirty();
             void clearDirty(uint32_t binding, uint32_t array_element);
 
@@ -60,6 +61,7 @@ namespace frame {
 
         private:
             bool m_dirty{ false };
+            bool m_offset_dirty{ false };
             BindingMap<ResourceInfo> m_resource_bindings;
         };
 
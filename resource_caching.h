@@ -307,6 +307,15 @@ namespace std {
             {
                 frame::common::hashCombineResource(result, render_pass->getHandle());
             }
+            else
+            {
+                for (auto format : pipeline_state.getRenderingFormatState().color_formats)
+                {
+                    frame::common::hashCombineResource(result, format);
+                }
+
+                frame::common::hashCombineResource(result, pipeline_state.getRenderingFormatState().depth_format);
+            }
 
             frame::common::hashCombineResource(result, pipeline_state.getSpecializationConstantState());
 
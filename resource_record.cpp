@@ -113,17 +113,29 @@ namespace frame {
                 throw std::runtime_error("PipelineLayout not registered in m_pipeline_layout_to_index");
             }
             
-            auto render_pass_it = m_render_pass_to_index.find(render_pass);
-            if (render_pass_it == m_render_pass_to_index.end()) {
-                throw std::runtime_error("RenderPass not registered in m_render_pass_to_index");
+            size_t render_pass_index = NO_RENDER_PASS_INDEX;
+            if (render_pass) {
+                auto render_pass_it = m_render_pass_to_index.find(render_pass);
+                if (render_pass_it == m_render_pass_to_index.end()) {
+                    throw std::runtime_error("RenderPass not registered in m_render_pass_to_index");
+                }
+                render_pass_index = render_pass_it->second;
             }
 
             common::write(m_stream,
                 ResourceType::GraphicsPipelineCPP,
                 m_pipeline_layout_to_index.at(&pipeline_layout),
-                m_render_pass_to_index.at(render_pass),
+                render_pass_index,
                 pipeline_state.getSubpassIndex());
 
+            if (!render_pass) {
+                auto& rendering_format_state = pipeline_state.getRenderingFormatState();
+                common::write(m_stream,
+                    rendering_format_state.color_formats,
+                    rendering_format_state.depth_format,
+                    rendering_format_state.sample_count);
+            }
+
             auto& specialization_constant_state = pipeline_state.getSpecializationConstantState().getSpecializationConstantState();
 
             common::write(m_stream, specialization_constant_state);
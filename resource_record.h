@@ -50,6 +50,8 @@ namespace frame {
 
         class ResourceRecord {
         public:
+            static constexpr size_t NO_RENDER_PASS_INDEX = ~size_t{ 0 };
+
             void setData(const std::vector<uint8_t>& data);
             std::vector<uint8_t> getData();
             const std::ostringstream& getStream();
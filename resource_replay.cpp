@@ -138,6 +138,14 @@ namespace frame {
 
             common::read(stream, pipeline_layout_index, render_pass_index, subpass_index);
 
+            rendering::RenderingFormatState rendering_format_state{};
+            if (render_pass_index == ResourceRecord::NO_RENDER_PASS_INDEX) {
+                common::read(stream,
+                    rendering_format_state.color_formats,
+                    rendering_format_state.depth_format,
+                    rendering_format_state.sample_count);
+            }
+
             std::map<uint32_t, std::vector<uint8_t>> specialization_constant_state{};
             common::read(stream, specialization_constant_state);
 
@@ -162,8 +170,13 @@ namespace frame {
             rendering::PipelineState pipeline_state{};
             assert(pipeline_layout_index < m_pipeline_layouts.size());
             pipeline_state.setPipelineLayout(*m_pipeline_layouts[pipeline_layout_index]);
-            assert(render_pass_index < m_render_passes.size());
-            pipeline_state.setRenderPass(*m_render_passes[render_pass_index]);
+            if (render_pass_index == ResourceRecord::NO_RENDER_PASS_INDEX) {
+                pipeline_state.setRenderingFormatState(rendering_format_state);
+            }
+            else {
+                assert(render_pass_index < m_render_passes.size());
+                pipeline_state.setRenderPass(*m_render_passes[render_pass_index]);
+            }
 
             for (auto& item : specialization_constant_state) {
                 pipeline_state.setSpecializationConstant(item.first, item.second);
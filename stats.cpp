@@ -27,6 +27,7 @@
 
 #include "core/device.h"
 #include "stats/frame_stats_provider.h"
+#include "stats/render_stats_provider.h"
 #ifdef VK_USE_PLATFORM_ANDROID_KHR
 	#include "hwcpipe_stats_provider.h"
 #endif
@@ -66,13 +67,16 @@ namespace frame {
 			std::set<StatIndex> stats = m_requested_stats;
 			
 			m_providers.emplace_back(std::make_unique<FrameTimeStatsProvider>(stats));
+			m_providers.emplace_back(std::make_unique<RenderStatsProvider>(stats, m_render_context));
 
 #ifdef VK_USE_PLATFORM_ANDROID_KHR
 			m_providers.emplace_back(std::make_unique<HWCPipeStatsProvider>(stats));
 #endif
 
 			rendering::RenderContext& render_context = m_render_context;
-			m_providers.emplace_back(std::make_unique<VulkanStatsProvider>(stats, m_sampling_config, render_context));
+			auto vulkan_provider = std::make_unique<VulkanStatsProvider>(stats, m_sampling_config, render_context);
+			m_vulkan_provider = vulkan_provider.get();
+			m_providers.emplace_back(std::move(vulkan_provider));
 			
 			m_frame_time_provider = m_providers[0].get();
 
@@ -305,6 +309,18 @@ namespace frame {
 					return "External Read Bytes (MiB/s)";
 				case StatIndex::gpu_ext_write_bytes:
 					return "External Write Bytes (MiB/s)";
+				case StatIndex::scene_visible_draws:
+					return "Visible Draws";
+				case StatIndex::scene_culled_draws:
+					return "Culled Draws";
+				case StatIndex::scene_occluded_draws:
+					return "Occluded Draws";
+				case StatIndex::scene_base_triangles:
+					return "Base Triangles";
+				case StatIndex::scene_lod_triangles:
+					return "LOD Triangles";
+				case StatIndex::frame_latency:
+					return "Frame Latency (ms)";
 				default:
 					return nullptr;
 				}
@@ -386,6 +402,10 @@ namespace frame {
 			}
 		}
 
+		float Stats::getGpuFrameTime() const {
+			return m_vulkan_provider ? m_vulkan_provider->getGpuFrameTime() : 0.0f;
+		}
+
 		const StatGraphData& Stats::getGraphData(StatIndex index) const {
 			for (auto& p : m_providers) {
 				if (p->isAvailable(index)) {
@@ -41,6 +41,8 @@ namespace frame {
 	}
 
 	namespace stats {
+		class VulkanStatsProvider;
+
 		class Stats {
 		public:
 			explicit Stats(rendering::RenderContext& render_context, size_t buffer_size = 16);
@@ -66,10 +68,14 @@ namespace frame {
 			void beginSampling(core::CommandBuffer& cb);
 			void endSampling(core::CommandBuffer& cb);
 
+			// Measured GPU time of the last completed frame in seconds, 0 when timestamps are not available
+			float getGpuFrameTime() const;
+
 		private:
 			rendering::RenderContext& m_render_context;
 			std::set<StatIndex> m_requested_stats;
 			StatsProvider* m_frame_time_provider{ nullptr };
+			VulkanStatsProvider* m_vulkan_provider{ nullptr };
 			std::vector<std::unique_ptr<StatsProvider>> m_providers;
 			CounterSamplingConfig m_sampling_config;
 			size_t m_buffer_size;
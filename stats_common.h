@@ -59,6 +59,14 @@ namespace frame {
 			gpu_ext_read_bytes,
 			gpu_ext_write_bytes,
 			gpu_tex_cycles,
+
+			scene_visible_draws,
+			scene_culled_draws,
+			scene_occluded_draws,
+			scene_base_triangles,
+			scene_lod_triangles,
+
+			frame_latency,
 		};
 
 		struct StatIndexHash {
@@ -56,6 +56,14 @@ namespace frame {
             {StatIndex::gpu_ext_write_stalls,  {"External Write Stalls",                       "{:4.1f} M/s",   static_cast<float>(1e-6)}},
             {StatIndex::gpu_ext_read_bytes,    {"External Read Bytes",                         "{:4.1f} MiB/s", 1.0f / (1024.0f * 1024.0f)}},
             {StatIndex::gpu_ext_write_bytes,   {"External Write Bytes",                        "{:4.1f} MiB/s", 1.0f / (1024.0f * 1024.0f)}},
+
+            //Render Stats
+            {StatIndex::scene_visible_draws,   {"Visible Draws",                               "{:4.0f}"}},
+            {StatIndex::scene_culled_draws,    {"Culled Draws",                                "{:4.0f}"}},
+            {StatIndex::scene_occluded_draws,  {"Occluded Draws",                              "{:4.0f}"}},
+            {StatIndex::scene_base_triangles,  {"Base Triangles",                              "{:4.0f}"}},
+            {StatIndex::scene_lod_triangles,   {"LOD Triangles",                               "{:4.0f}"}},
+            {StatIndex::frame_latency,         {"Frame Latency",                               "{:3.1f} ms",    1000.0f}},
             // clang-format on
         };
         
@@ -64,7 +64,7 @@ namespace frame {
         }
 
         common::Buffer const& SubMesh::getIndexBuffer() const {
-            return *m_index_buffer;
+            return m_index_arena ? *m_index_arena : *m_index_buffer;
         }
 
         vk::IndexType SubMesh::getIndexType() const {
@@ -75,6 +75,18 @@ namespace frame {
             return m_vertex_buffers.at(name);
         }
 
+        std::uint32_t SubMesh::getLodCount() const {
+            return m_lods.empty() ? 1 : static_cast<std::uint32_t>(m_lods.size());
+        }
+
+        IndexLod SubMesh::getLod(std::uint32_t lod) const {
+            if (m_lods.empty()) {
+                return { 0, m_vertex_indices };
+            }
+
+            return m_lods[std::min(lod, static_cast<std::uint32_t>(m_lods.size()) - 1)];
+        }
+
         void SubMesh::computeShaderVariant() {
             m_shader_variant.clear();
 
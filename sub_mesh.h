@@ -39,6 +39,12 @@ namespace frame {
             std::uint32_t offset = 0;
         };
 
+        // Index range of one level of detail, relative to m_first_index. Every level shares the vertices of the sub mesh.
+        struct IndexLod {
+            std::uint32_t first_index = 0;
+            std::uint32_t index_count = 0;
+        };
+
         class SubMesh : public Component {
         public:
             SubMesh(const std::string& name = {});
@@ -59,14 +65,29 @@ namespace frame {
             vk::IndexType getIndexType() const;
             common::Buffer const& getVertexBuffer(std::string const& name) const;
 
+            std::uint32_t getLodCount() const;
+            IndexLod getLod(std::uint32_t lod) const;
+
             vk::IndexType m_index_type{};
             std::uint32_t m_index_offset = 0;
             std::uint32_t m_vertices_count = 0;
             std::uint32_t m_vertex_indices = 0;
+            std::uint32_t m_first_index = 0;
+            std::int32_t m_vertex_offset = 0;
 
             std::unordered_map<std::string, common::Buffer> m_vertex_buffers;
             std::unique_ptr<common::Buffer> m_index_buffer;
 
+            // MeshletBounds of every meshlet in m_index_buffer when it holds meshlets, null otherwise
+            std::unique_ptr<common::Buffer> m_meshlet_bounds_buffer;
+
+            // Shared buffers owned by a GeometryArena, all attributes are interleaved in m_vertex_arena
+            const common::Buffer* m_vertex_arena = nullptr;
+            const common::Buffer* m_index_arena = nullptr;
+
+            // Coarser index lists stored after the full one, m_lods[0] covers m_vertex_indices. Empty without generated LODs.
+            std::vector<IndexLod> m_lods;
+
         private:
             void computeShaderVariant();
 
@@ -32,6 +32,16 @@ namespace frame {
 			return mat;
 		}
 
+		Light makeLight(scene::Light& scene_light) {
+			const auto& properties = scene_light.getProperties();
+			auto& transform = scene_light.getNode()->getTransform();
+
+			return { {transform.getTranslation(), static_cast<float>(scene_light.getLightType())},
+				{properties.color, properties.intensity},
+				{transform.getRotation() * properties.direction, properties.range},
+				{properties.inner_cone_angle, properties.outer_cone_angle} };
+		}
+
 		Subpass::Subpass(RenderContext& render_context, core::ShaderSource&& vertex_source, core::ShaderSource&& fragment_source) :
 			m_fragment_shader{ std::move(fragment_source) },
 			m_render_context{ render_context },
@@ -39,6 +49,36 @@ namespace frame {
 		{
 		}
 
+		void Subpass::prepareRenderTarget(const RenderTarget& render_target) {
+		}
+
+		void Subpass::prepareFrame(core::CommandBuffer& command_buffer) {
+		}
+
+		void Subpass::finishFrame(core::CommandBuffer& command_buffer, RenderTarget& render_target) {
+		}
+
+		bool Subpass::hasLateDraws() const {
+			return false;
+		}
+
+		void Subpass::prepareLateDraws(core::CommandBuffer& command_buffer, RenderTarget& render_target) {
+		}
+
+		void Subpass::drawLate(core::CommandBuffer& command_buffer) {
+		}
+
+		void Subpass::dispatchCompute(core::CommandBuffer& command_buffer) {
+		}
+
+		vk::PipelineStageFlags Subpass::getComputeWaitStage() const {
+			return {};
+		}
+
+		vk::SubpassContents Subpass::getSubpassContents() const {
+			return vk::SubpassContents::eInline;
+		}
+
 		const std::vector<uint32_t>& Subpass::getInputAttachments() const {
 			return m_input_attachments;
 		}
@@ -119,6 +159,14 @@ namespace frame {
 			m_input_attachments = input;
 		}
 
+		void Subpass::setLateDrawsSupported(bool supported) {
+			m_late_draws_supported = supported;
+		}
+
+		bool Subpass::isLateDrawsSupported() const {
+			return m_late_draws_supported;
+		}
+
 		void Subpass::setOutputAttachments(std::vector<uint32_t> const& output) {
 			m_output_attachments = output;
 		}
@@ -53,6 +53,8 @@ namespace frame {
 		
 		glm::mat4 vulkanStyleProjection(const glm::mat4& proj);
 
+		Light makeLight(scene::Light& scene_light);
+
 		inline const std::vector<std::string> light_type_definitions = {
 			"DIRECTIONAL_LIGHT " + std::to_string(static_cast<float>(scene::LightType::Directional)),
 			"POINT_LIGHT " + std::to_string(static_cast<float>(scene::LightType::Point)),
@@ -71,6 +73,35 @@ namespace frame {
 			virtual void draw(core::CommandBuffer& command_buffer) = 0;
 			
 			virtual void prepare() = 0;
+
+			// Called by the render pipeline with the target it is about to draw, before prepareFrame().
+			// Subpasses depending on the attachment layout, like the compact G-buffer, follow the target here
+			virtual void prepareRenderTarget(const RenderTarget& render_target);
+
+			// Records work that has to run outside of the render pass, before it begins
+			virtual void prepareFrame(core::CommandBuffer& command_buffer);
+
+			// Records work that has to run after the render pass has ended, e.g. consuming its attachments
+			virtual void finishFrame(core::CommandBuffer& command_buffer, RenderTarget& render_target);
+
+			// Subpasses with late draws get a second rendering scope on the same attachments, dynamic rendering only.
+			// prepareLateDraws() runs between the two scopes with the attachments stored, drawLate() records into the second one.
+			// Subpasses only report late draws while isLateDrawsSupported(), otherwise they defer that work to finishFrame()
+			virtual bool hasLateDraws() const;
+
+			virtual void prepareLateDraws(core::CommandBuffer& command_buffer, RenderTarget& render_target);
+
+			virtual void drawLate(core::CommandBuffer& command_buffer);
+
+			// Records compute work that only depends on host data or earlier frames. It is submitted to the compute queue
+			// before the frame's graphics work, which waits for it at getComputeWaitStage()
+			virtual void dispatchCompute(core::CommandBuffer& command_buffer);
+
+			// Graphics stages that consume the dispatchCompute() results, none when the subpass has no async compute work
+			virtual vk::PipelineStageFlags getComputeWaitStage() const;
+
+			// Subpasses that record into secondary command buffers return eSecondaryCommandBuffers
+			virtual vk::SubpassContents getSubpassContents() const;
 			
 			template <typename T>
 			void allocateLights(const std::vector<scene::Light*>& scene_lights, size_t max_lights_per_type);
@@ -96,6 +127,9 @@ namespace frame {
 			void setDepthStencilResolveAttachment(uint32_t depth_stencil_resolve);
 			void setDepthStencilResolveMode(vk::ResolveModeFlagBits mode);
 			void setInputAttachments(std::vector<uint32_t> const& input);
+			// Set by the render pipeline when it can split the subpass into two rendering scopes
+			void setLateDrawsSupported(bool supported);
+			bool isLateDrawsSupported() const;
 			void setOutputAttachments(std::vector<uint32_t> const& output);
 			void setSampleCount(vk::SampleCountFlagBits sample_count);
 			
@@ -119,6 +153,8 @@ namespace frame {
 			core::ShaderSource m_fragment_shader;
 			
 			std::vector<uint32_t> m_input_attachments = {};
+
+			bool m_late_draws_supported{ false };
 			
 			std::vector<uint32_t> m_output_attachments = { 0 };
 
@@ -137,13 +173,7 @@ namespace frame {
 			m_lighting_state.spot_lights.clear();
 
 			for (auto& scene_light : scene_lights) {
-				const auto& properties = scene_light->getProperties();
-				auto& transform = scene_light->getNode()->getTransform();
-
-				Light light{ {transform.getTranslation(), static_cast<float>(scene_light->getLightType())},
-							{properties.color, properties.intensity},
-							{transform.getRotation() * properties.direction, properties.range},
-							{properties.inner_cone_angle, properties.outer_cone_angle} };
+				Light light = makeLight(*scene_light);
 
 				switch (scene_light->getLightType()) {
 				case scene::LightType::Directional: {
@@ -0,0 +1,76 @@
+/* Copyright (c) 2025, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "core/timeline_semaphore.h"
+#include "core/device.h"
+
+namespace frame {
+    namespace core {
+        TimelineSemaphore::TimelineSemaphore(Device& device, uint64_t initial_value) :
+            VulkanResource{ VK_NULL_HANDLE, &device },
+            m_pending_value{ initial_value }
+        {
+            vk::SemaphoreTypeCreateInfo type_info{ vk::SemaphoreType::eTimeline, initial_value };
+            vk::SemaphoreCreateInfo create_info{ {}, &type_info };
+
+            try {
+                setHandle(getDevice().getHandle().createSemaphore(create_info));
+            }
+            catch (const std::exception& e) {
+                LOGE(e.what());
+                throw std::runtime_error("[TimelineSemaphore] ERROR: Failed to create timeline semaphore.");
+            }
+        }
+
+        TimelineSemaphore::~TimelineSemaphore() {
+            if (hasHandle()) {
+                getDevice().getHandle().destroySemaphore(getHandle());
+            }
+        }
+
+        uint64_t TimelineSemaphore::advance() {
+            return ++m_pending_value;
+        }
+
+        uint64_t TimelineSemaphore::getPendingValue() const {
+            return m_pending_value;
+        }
+
+        uint64_t TimelineSemaphore::getCompletedValue() const {
+            return getDevice().getHandle().getSemaphoreCounterValue(getHandle());
+        }
+
+        bool TimelineSemaphore::isComplete(uint64_t value) const {
+            return getCompletedValue() >= value;
+        }
+
+        vk::Result TimelineSemaphore::wait(uint64_t value, uint64_t timeout) const {
+            if (value == 0) {
+                return vk::Result::eSuccess;
+            }
+
+            vk::SemaphoreWaitInfo wait_info{ {}, getHandle(), value };
+
+            try {
+                return getDevice().getHandle().waitSemaphores(wait_info, timeout);
+            }
+            catch (const vk::SystemError& e) {
+                return static_cast<vk::Result>(e.code().value());
+            }
+        }
+    }
+}
@@ -0,0 +1,59 @@
+/* Copyright (c) 2025, Arm Limited and Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 the "License";
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include <limits>
+
+#include "core/vulkan_resource.h"
+#include "common/helper.h"
+#include "common/common.h"
+
+namespace frame {
+    namespace core {
+        class Device;
+
+        /*
+         * Semaphore with a monotonically increasing 64-bit counter. A submit signals the value returned by advance(),
+         * the host polls getCompletedValue() or blocks in wait() instead of juggling one fence per submission.
+         */
+        class TimelineSemaphore : public VulkanResource<vk::Semaphore> {
+        public:
+            TimelineSemaphore(Device& device, uint64_t initial_value = 0);
+
+            TimelineSemaphore(const TimelineSemaphore&) = delete;
+            TimelineSemaphore(TimelineSemaphore&&) = delete;
+            TimelineSemaphore& operator=(const TimelineSemaphore&) = delete;
+            TimelineSemaphore& operator=(TimelineSemaphore&&) = delete;
+
+            ~TimelineSemaphore();
+
+            // Reserves the next value, the caller must signal it in its next submit
+            uint64_t advance();
+
+            // Last value handed out by advance(), it completes once all work submitted so far has finished
+            uint64_t getPendingValue() const;
+            uint64_t getCompletedValue() const;
+            bool isComplete(uint64_t value) const;
+            vk::Result wait(uint64_t value, uint64_t timeout = std::numeric_limits<uint64_t>::max()) const;
+
+        private:
+            uint64_t m_pending_value{ 0 };
+        };
+    }
+}
@@ -49,8 +49,8 @@ namespace frame {
 				render_context.getFormat() == vk::Format::eB8G8R8A8Srgb);
 			
 			auto& frame = render_context.getLastRenderedFrame();
-			assert(!frame.getRenderTarget().getViews().empty());
-			auto& src_image_view = frame.getRenderTarget().getViews()[0];
+			assert(!frame.getSwapchainRenderTarget().getViews().empty());
+			auto& src_image_view = frame.getSwapchainRenderTarget().getViews()[0];
 			
 			auto width = render_context.getSurfaceExtent().width;
 			auto height = render_context.getSurfaceExtent().height;
@@ -75,7 +75,7 @@ namespace frame {
 				cmd_buf.bufferMemoryBarrier(dst_buffer, 0, dst_size, buffer_barrier);
 			
 				common::ImageMemoryBarrier img_barrier_to_src{};
-				img_barrier_to_src.m_old_layout = vk::ImageLayout::ePresentSrcKHR;
+				img_barrier_to_src.m_old_layout = render_context.getOutputLayout();
 				img_barrier_to_src.m_new_layout = vk::ImageLayout::eTransferSrcOptimal;
 				img_barrier_to_src.m_src_stage_mask = vk::PipelineStageFlagBits::eTransfer;
 				img_barrier_to_src.m_dst_stage_mask = vk::PipelineStageFlagBits::eTransfer;
@@ -103,7 +103,7 @@ namespace frame {
 			
 				common::ImageMemoryBarrier img_barrier_to_present{};
 				img_barrier_to_present.m_old_layout = vk::ImageLayout::eTransferSrcOptimal;
-				img_barrier_to_present.m_new_layout = vk::ImageLayout::ePresentSrcKHR;
+				img_barrier_to_present.m_new_layout = render_context.getOutputLayout();
 				img_barrier_to_present.m_src_stage_mask = vk::PipelineStageFlagBits::eTransfer;
 				img_barrier_to_present.m_dst_stage_mask = vk::PipelineStageFlagBits::eTransfer;
 				cmd_buf.imageMemoryBarrier(src_image_view, img_barrier_to_present);
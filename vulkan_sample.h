@@ -26,6 +26,8 @@
 #include "common/strings.h"
 #include "platform/application.h"
 #include "platform/configuration.h"
+#include "rendering/dynamic_resolution.h"
+#include "rendering/render_graph.h"
 #include "rendering/render_pipeline.h"
 #include "scene/components/camera/camera.h"
 #include "scene/scene.h"
@@ -94,8 +96,19 @@ namespace frame {
 		void createGui(const platform::Window& m_window, stats::Stats const* stats = nullptr, const float font_size = 21.0f, bool explicit_update = false);
 		void createRenderContext(const std::vector<vk::SurfaceFormatKHR>& surface_priority_list);
 
+		// Renders the scene at a scale picked from the measured GPU frame time and upscales it to the swapchain image.
+		// GPU times come from the stats timestamps once requestStats() was called, the CPU frame time is used otherwise.
+		// The render context is best prepared with RenderTarget::DEFAULT_CREATE_FUNC, the scene attachments live in the scaled targets
+		void enableDynamicResolution(float frame_budget, rendering::RenderTarget::CreateFunc create_render_target_func = rendering::RenderTarget::CREATE_FUNC);
+
+		// Delays input sampling and simulation until just before the predicted frame deadline, see rendering::FramePacer.
+		// Uses present-wait when the device supports it, GPU times come from the stats timestamps like for dynamic resolution
+		void enableLowLatency(bool enable);
+		bool waitForFrame() override;
+
 		core::Device& getDevice();
 		core::Device const& getDevice() const;
+		rendering::DynamicResolution* getDynamicResolution();
 		gui::Gui& getGui();
 		gui::Gui const& getGui() const;
 		core::Instance& getInstance();
@@ -112,10 +125,13 @@ namespace frame {
 		bool hasGui() const;
 		bool hasRenderPipeline() const;
 		bool hasScene();
+		bool isDynamicRenderingSupported() const;
 
-		void loadScene(const std::string& path);
+		void loadScene(const std::string& path, bool pack_geometry = false, bool generate_lods = false);
 		bool prepare(const platform::ApplicationOptions& options) override;
 		void setApiVersion(uint32_t requested_api_version);
+		// Frames the CPU may record ahead of the GPU, independent of the swapchain image count. 0 uses one frame per image
+		void setFramesInFlight(uint32_t frames_in_flight);
 		void setHighPriorityGraphicsQueueEnable(bool enable);
 		void setRenderContext(std::unique_ptr<rendering::RenderContext>&& render_context);
 		void setRenderPipeline(std::unique_ptr<rendering::RenderPipeline>&& render_pipeline);
@@ -126,6 +142,7 @@ namespace frame {
 		static void setViewportAndScissor(core::CommandBuffer const& command_buffer, vk::Extent2D const& extent);
 
 	private:
+		void createFrameGraph(size_t attachment_count, bool upscale);
 		std::unordered_map<const char*, bool> const& getDeviceExtensions() const;
 		std::unordered_map<const char*, bool> const& getInstanceExtensions() const;
 		std::unordered_map<const char*, bool> const& getInstanceLayers() const;
@@ -139,6 +156,12 @@ namespace frame {
 		std::unique_ptr<scene::Scene> m_scene;
 		std::unique_ptr<gui::Gui> m_gui;
 		std::unique_ptr<stats::Stats> m_stats;
+		std::unique_ptr<rendering::RenderGraph> m_frame_graph;
+		std::vector<rendering::RenderGraph::ImageHandle> m_frame_graph_images;
+		rendering::RenderTarget* m_frame_graph_target{ nullptr };
+		rendering::RenderGraph::ImageHandle m_frame_graph_swapchain{ 0 };
+		bool m_frame_graph_upscale{ false };
+		std::unique_ptr<rendering::DynamicResolution> m_dynamic_resolution;
 
 		static constexpr float STATS_VIEW_RESET_TIME{ 10.0f };
 
@@ -154,6 +177,11 @@ namespace frame {
 		std::vector<vk::LayerSettingEXT> m_layer_settings;
 		uint32_t m_api_version = VK_API_VERSION_1_3;
 		bool m_high_priority_graphics_queue{ false };
+		uint32_t m_frames_in_flight{ 2 };
+		bool m_dynamic_rendering_supported{ false };
+		bool m_synchronization2_supported{ false };
+		bool m_timeline_semaphore_supported{ false };
+		bool m_present_wait_supported{ false };
 
 		std::unique_ptr<core::DebugUtils> m_debug_utils;
 	};
@@ -166,6 +194,8 @@ namespace frame {
 		m_scene.reset();
 		m_stats.reset();
 		m_gui.reset();
+		m_frame_graph.reset();
+		m_dynamic_resolution.reset();
 		m_render_context.reset();
 		m_device.reset();
 
@@ -210,57 +240,119 @@ namespace frame {
 #endif
 
 		m_render_context = std::make_unique<rendering::RenderContext>(*m_device, m_surface, *m_window, present_mode, present_mode_priority_list, surface_priority_list);
+		m_render_context->setFramesInFlight(m_frames_in_flight);
+	}
+
+	inline void VulkanSample::enableDynamicResolution(float frame_budget, rendering::RenderTarget::CreateFunc create_render_target_func) {
+		assert(m_render_context && "Render context is not valid");
+
+		// The swapchain image is the destination of the upscaling blit
+		if(m_render_context->hasSwapchain() && !(m_render_context->getSwapchain().getUsage() & vk::ImageUsageFlagBits::eTransferDst)) {
+			m_device->getHandle().waitIdle();
+			m_render_context->updateSwapchain(std::set<vk::ImageUsageFlagBits>{ vk::ImageUsageFlagBits::eColorAttachment, vk::ImageUsageFlagBits::eTransferDst });
+		}
+
+		m_dynamic_resolution = std::make_unique<rendering::DynamicResolution>(*m_render_context, frame_budget, std::move(create_render_target_func));
+	}
+
+	inline void VulkanSample::enableLowLatency(bool enable) {
+		assert(m_render_context && "Render context is not valid");
+		m_render_context->setLowLatency(enable, m_present_wait_supported);
+	}
+
+	inline bool VulkanSample::waitForFrame() {
+		if(!m_render_context || !m_render_context->getFramePacer()) {
+			return false;
+		}
+
+		m_render_context->getFramePacer()->wait();
+		return true;
 	}
 
 	inline void VulkanSample::draw(core::CommandBuffer& command_buffer, rendering::RenderTarget& render_target) {
 		auto& views = render_target.getViews();
-		
-		{
-			common::ImageMemoryBarrier color_barrier{};
-			color_barrier.m_old_layout = vk::ImageLayout::eUndefined;
-			color_barrier.m_new_layout = vk::ImageLayout::eColorAttachmentOptimal;
-			color_barrier.m_src_access_mask = {};
-			color_barrier.m_dst_access_mask = vk::AccessFlagBits::eColorAttachmentWrite;
-			color_barrier.m_src_stage_mask = vk::PipelineStageFlagBits::eColorAttachmentOutput;
-			color_barrier.m_dst_stage_mask = vk::PipelineStageFlagBits::eColorAttachmentOutput;
-			
-			command_buffer.imageMemoryBarrier(views[1], color_barrier);
-			render_target.setLayout(1, color_barrier.m_new_layout);
-			
-			for (size_t i = 2; i < views.size(); ++i) {
-				command_buffer.imageMemoryBarrier(views[i], color_barrier);
-				render_target.setLayout(static_cast<size_t>(i), color_barrier.m_new_layout);
-			}
+		const bool upscale = m_dynamic_resolution != nullptr;
+
+		if(!m_frame_graph || m_frame_graph_images.size() != views.size() || m_frame_graph_upscale != upscale ||
+			m_frame_graph->getFrameCount() != m_render_context->getRenderFrames().size()) {
+			createFrameGraph(views.size(), upscale);
 		}
-		
-		{
-			common::ImageMemoryBarrier depth_barrier{};
-			depth_barrier.m_old_layout = vk::ImageLayout::eUndefined;
-			depth_barrier.m_new_layout = vk::ImageLayout::eDepthStencilAttachmentOptimal;
-			depth_barrier.m_src_access_mask = {};
-			depth_barrier.m_dst_access_mask = vk::AccessFlagBits::eDepthStencilAttachmentRead |
-				vk::AccessFlagBits::eDepthStencilAttachmentWrite;
-			depth_barrier.m_src_stage_mask = vk::PipelineStageFlagBits::eTopOfPipe;
-			depth_barrier.m_dst_stage_mask = vk::PipelineStageFlagBits::eEarlyFragmentTests |
-				vk::PipelineStageFlagBits::eLateFragmentTests;
-			
-			command_buffer.imageMemoryBarrier(views[0], depth_barrier);
-			render_target.setLayout(0, depth_barrier.m_new_layout);
+
+		for (size_t i = 0; i < views.size(); ++i) {
+			m_frame_graph->setImportedImage(m_frame_graph_images[i], views[i]);
 		}
-		
-		drawRenderpass(command_buffer, render_target);
-		
-		{
-			common::ImageMemoryBarrier present_barrier{};
-			present_barrier.m_old_layout = vk::ImageLayout::eColorAttachmentOptimal;
-			present_barrier.m_new_layout = vk::ImageLayout::ePresentSrcKHR;
-			present_barrier.m_src_access_mask = vk::AccessFlagBits::eColorAttachmentWrite;
-			present_barrier.m_src_stage_mask = vk::PipelineStageFlagBits::eColorAttachmentOutput;
-			present_barrier.m_dst_stage_mask = vk::PipelineStageFlagBits::eBottomOfPipe;
-			
-			command_buffer.imageMemoryBarrier(views[1], present_barrier);
-			render_target.setLayout(1, present_barrier.m_new_layout);
+
+		if(upscale) {
+			auto& swapchain_views = m_render_context->getActiveFrame().getSwapchainRenderTarget().getViews();
+			m_frame_graph->setImportedImage(m_frame_graph_swapchain, swapchain_views.size() > 1 ? swapchain_views[1] : swapchain_views[0]);
+		}
+
+		m_frame_graph_target = &render_target;
+		m_frame_graph->execute(command_buffer, static_cast<uint32_t>(m_render_context->getActiveFrameIndex()));
+		m_frame_graph_target = nullptr;
+
+		render_target.setLayout(1, upscale ? vk::ImageLayout::eTransferSrcOptimal : m_render_context->getOutputLayout());
+	}
+
+	inline void VulkanSample::createFrameGraph(size_t attachment_count, bool upscale) {
+		// Replacing the graph releases its transients after waiting for the device
+		m_frame_graph.reset();
+		m_frame_graph = std::make_unique<rendering::RenderGraph>(*m_device, m_synchronization2_supported,
+			static_cast<uint32_t>(m_render_context->getRenderFrames().size()));
+		m_frame_graph_images.clear();
+
+		// Attachment contents are discarded every frame, the swapchain image is handed over to presentation.
+		// When upscaling, attachment 1 is the scaled color and the swapchain image is only written by the blit.
+		// The attachments are owned by the frame's render target and imported. The render pipeline records all of its
+		// subpasses in one pass, so this graph only orders that pass against the upscale blit and creates no transients:
+		// nothing here exercises RenderGraph aliasing, which is left to applications adding their own passes. G-buffer
+		// memory is saved by the render target's lazily allocated transient attachments instead.
+		// Depth is shared with the other frames rendering to the same swapchain image, its first write orders after theirs through
+		// the acquire semaphore wait at the fragment test stages
+		m_frame_graph_images.push_back(m_frame_graph->importImage("depth", vk::ImageLayout::eUndefined, vk::ImageLayout::eUndefined,
+			vk::PipelineStageFlagBits2::eEarlyFragmentTests | vk::PipelineStageFlagBits2::eLateFragmentTests));
+		for (size_t i = 1; i < attachment_count; ++i) {
+			m_frame_graph_images.push_back(m_frame_graph->importImage(fmt::format("attachment #{}", i),
+				vk::ImageLayout::eUndefined,
+				i == 1 && !upscale ? m_render_context->getOutputLayout() : vk::ImageLayout::eUndefined,
+				vk::PipelineStageFlagBits2::eColorAttachmentOutput));
+		}
+
+		auto pass = m_frame_graph->addPass("Frame", [this](core::CommandBuffer& command_buffer) {
+			auto& render_target = *m_frame_graph_target;
+
+			render_target.setLayout(0, vk::ImageLayout::eDepthStencilAttachmentOptimal);
+			for (size_t i = 1; i < render_target.getViews().size(); ++i) {
+				render_target.setLayout(i, vk::ImageLayout::eColorAttachmentOptimal);
+			}
+
+			drawRenderpass(command_buffer, render_target);
+
+			// Nothing in the graph reads depth afterwards, so finishFrame may leave it in any layout
+			if(m_render_pipeline) {
+				m_render_pipeline->finishFrame(command_buffer, render_target);
+			}
+		});
+
+		pass.useImage(m_frame_graph_images[0], rendering::RenderGraphAccess::DepthAttachment);
+		for (size_t i = 1; i < attachment_count; ++i) {
+			pass.useImage(m_frame_graph_images[i], rendering::RenderGraphAccess::ColorAttachment);
+		}
+
+		if(upscale) {
+			m_frame_graph_swapchain = m_frame_graph->importImage("swapchain",
+				vk::ImageLayout::eUndefined, m_render_context->getOutputLayout(), vk::PipelineStageFlagBits2::eColorAttachmentOutput);
+
+			auto upscale_pass = m_frame_graph->addPass("Upscale", [this](core::CommandBuffer& command_buffer) {
+				m_dynamic_resolution->upscale(command_buffer, *m_frame_graph_target, m_frame_graph->getImageView(m_frame_graph_swapchain));
+			});
+
+			upscale_pass.useImage(m_frame_graph_images[1], rendering::RenderGraphAccess::TransferRead);
+			upscale_pass.useImage(m_frame_graph_swapchain, rendering::RenderGraphAccess::TransferWrite);
 		}
+
+		m_frame_graph_upscale = upscale;
+		m_frame_graph->compile();
 	}
 
 	inline void VulkanSample::drawGui() {}
@@ -270,10 +362,32 @@ namespace frame {
 		render(command_buffer);
 
 		if(m_gui) {
-			m_gui->draw(command_buffer);
+			bool secondary_contents = m_render_pipeline &&
+				m_render_pipeline->getActiveSubpassContents() == vk::SubpassContents::eSecondaryCommandBuffers;
+
+			if(secondary_contents) {
+				const auto& queue = m_device->getQueueByFlags(vk::QueueFlagBits::eGraphics, 0);
+				auto& gui_command_buffer = m_render_context->getActiveFrame().requestCommandBuffer(queue,
+					core::CommandBuffer::ResetMode::ResetPool, vk::CommandBufferLevel::eSecondary);
+
+				gui_command_buffer.begin(vk::CommandBufferUsageFlagBits::eOneTimeSubmit | vk::CommandBufferUsageFlagBits::eRenderPassContinue, &command_buffer);
+				setViewportAndScissor(gui_command_buffer, render_target.getExtent());
+				m_gui->draw(gui_command_buffer);
+				gui_command_buffer.end();
+
+				command_buffer.executeCommands(gui_command_buffer);
+			}
+			else {
+				m_gui->draw(command_buffer);
+			}
 		}
 
-		command_buffer.getHandle().endRenderPass();
+		if(m_render_pipeline && m_render_pipeline->isDynamicRendering()) {
+			command_buffer.endRendering();
+		}
+		else {
+			command_buffer.endRenderPass();
+		}
 	}
 
 	inline void VulkanSample::finish() {
@@ -300,6 +414,10 @@ namespace frame {
 		return m_device_extensions;
 	}
 
+	inline rendering::DynamicResolution* VulkanSample::getDynamicResolution() {
+		return m_dynamic_resolution.get();
+	}
+
 	inline gui::Gui& VulkanSample::getGui() {
 		return *m_gui;
 	}
@@ -397,6 +515,10 @@ namespace frame {
 		return m_scene != nullptr;
 	}
 
+	inline bool VulkanSample::isDynamicRenderingSupported() const {
+		return m_dynamic_rendering_supported;
+	}
+
 	inline void VulkanSample::inputEvent(const platform::InputEvent& input_event) {
 		Parent::inputEvent(input_event);
 
@@ -426,9 +548,9 @@ namespace frame {
 		}
 	}
 
-	inline void VulkanSample::loadScene(const std::string& path) {
+	inline void VulkanSample::loadScene(const std::string& path, bool pack_geometry, bool generate_lods) {
 		common::GltfLoader loader(*m_device);
-		m_scene = loader.readSceneFromFile(path);
+		m_scene = loader.readSceneFromFile(path, -1, {}, pack_geometry, generate_lods);
 
 		if(!m_scene) {
 			LOGE("Cannot load scene: {}", path.c_str());
@@ -484,7 +606,7 @@ namespace frame {
 
 		m_surface = m_window->createSurface(*m_instance);
 
-		if(!m_surface) {
+		if(!m_surface && !m_window->isHeadless()) {
 			throw std::runtime_error("Failed to create m_window surface.");
 		}
 
@@ -495,11 +617,43 @@ namespace frame {
 			gpu.getMutableRequestedFeatures().textureCompressionASTC_LDR = true;
 		}
 
+		// GPU-driven draws record one multi-draw per batch, with a GPU-written draw count where available
+		if(gpu.getFeatures().multiDrawIndirect) {
+			gpu.getMutableRequestedFeatures().multiDrawIndirect = true;
+		}
+		addDeviceExtension(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME, /*optional=*/true);
+
+		if(m_api_version >= VK_API_VERSION_1_2) {
+			m_timeline_semaphore_supported = gpu.requestOptionalFeature<vk::PhysicalDeviceTimelineSemaphoreFeatures>(
+				&vk::PhysicalDeviceTimelineSemaphoreFeatures::timelineSemaphore, "vk::PhysicalDeviceTimelineSemaphoreFeatures", "timelineSemaphore");
+		}
+
+		if(m_api_version >= VK_API_VERSION_1_3) {
+			m_dynamic_rendering_supported = gpu.requestOptionalFeature<vk::PhysicalDeviceDynamicRenderingFeatures>(
+				&vk::PhysicalDeviceDynamicRenderingFeatures::dynamicRendering, "vk::PhysicalDeviceDynamicRenderingFeatures", "dynamicRendering");
+			m_synchronization2_supported = gpu.requestOptionalFeature<vk::PhysicalDeviceSynchronization2Features>(
+				&vk::PhysicalDeviceSynchronization2Features::synchronization2, "vk::PhysicalDeviceSynchronization2Features", "synchronization2");
+		}
+
 		requestGpuFeatures(gpu);
 
-		{
+		// Headless runs render into offscreen targets and never present
+		if(m_surface) {
 			addDeviceExtension(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
 
+			// Lets the low-latency pacer block until a frame reached the display
+			bool present_id_supported = gpu.requestOptionalFeature<vk::PhysicalDevicePresentIdFeaturesKHR>(
+				&vk::PhysicalDevicePresentIdFeaturesKHR::presentId, "vk::PhysicalDevicePresentIdFeaturesKHR", "presentId");
+			bool present_wait_supported = gpu.requestOptionalFeature<vk::PhysicalDevicePresentWaitFeaturesKHR>(
+				&vk::PhysicalDevicePresentWaitFeaturesKHR::presentWait, "vk::PhysicalDevicePresentWaitFeaturesKHR", "presentWait");
+			if(present_id_supported) {
+				addDeviceExtension(VK_KHR_PRESENT_ID_EXTENSION_NAME, /*optional=*/true);
+			}
+			if(present_wait_supported) {
+				addDeviceExtension(VK_KHR_PRESENT_WAIT_EXTENSION_NAME, /*optional=*/true);
+			}
+			m_present_wait_supported = present_id_supported && present_wait_supported;
+
 			if(m_instance_extensions.find(VK_KHR_DISPLAY_EXTENSION_NAME) != m_instance_extensions.end()) {
 				addDeviceExtension(VK_KHR_DISPLAY_SWAPCHAIN_EXTENSION_NAME, /*optional=*/true);
 			}
@@ -537,6 +691,10 @@ namespace frame {
 		m_device = createDevice(gpu);
 
 		VULKAN_HPP_DEFAULT_DISPATCHER.init(m_device->getHandle());
+
+		if(m_timeline_semaphore_supported) {
+			m_device->enableTimelineSemaphores();
+		}
 		
 		createRenderContext();
 		prepareRenderContext();
@@ -610,6 +768,10 @@ namespace frame {
 		m_api_version = requested_api_version;
 	}
 
+	inline void VulkanSample::setFramesInFlight(uint32_t frames_in_flight) {
+		m_frames_in_flight = frames_in_flight;
+	}
+
 	inline void VulkanSample::setHighPriorityGraphicsQueueEnable(bool enable) {
 		m_high_priority_graphics_queue = enable;
 	}
@@ -636,6 +798,29 @@ namespace frame {
 		auto& command_buffer = m_render_context->begin();
 		updateStats(delta_time);
 
+		float gpu_frame_time = m_stats->getGpuFrameTime();
+		if(m_dynamic_resolution) {
+			m_dynamic_resolution->update(gpu_frame_time > 0.0f ? gpu_frame_time : delta_time);
+			m_render_context->getActiveFrame().setRenderTargetOverride(&m_dynamic_resolution->getRenderTarget());
+		}
+
+		if(auto frame_pacer = m_render_context->getFramePacer()) {
+			frame_pacer->update(gpu_frame_time > 0.0f ? gpu_frame_time : delta_time);
+		}
+
+		// Async compute work is submitted first so it can run alongside the graphics work recorded below
+		if(m_render_pipeline) {
+			auto compute_wait_stages = m_render_pipeline->getComputeWaitStages();
+			if(compute_wait_stages) {
+				auto& compute_command_buffer = m_render_context->beginCompute();
+				compute_command_buffer.begin(vk::CommandBufferUsageFlagBits::eOneTimeSubmit);
+				m_render_pipeline->dispatchCompute(compute_command_buffer);
+				compute_command_buffer.end();
+
+				m_render_context->submitCompute({ &compute_command_buffer }, compute_wait_stages);
+			}
+		}
+
 		command_buffer.begin(vk::CommandBufferUsageFlagBits::eOneTimeSubmit);
 		m_stats->beginSampling(command_buffer);
 
@@ -653,10 +838,10 @@ namespace frame {
 
 		getDebugInfo().insert<common::field::Static, std::string>("driver_version", driver_version_str);
 		getDebugInfo().insert<common::field::Static, std::string>("resolution",
-			common::toString(m_render_context->getSwapchain().getExtent()));
+			common::toString(m_render_context->getSurfaceExtent()));
 		getDebugInfo().insert<common::field::Static, std::string>("surface_format",
-			common::toString(m_render_context->getSwapchain().getFormat()) + " (" +
-			common::toString(common::getBitsPerPixel(m_render_context->getSwapchain().getFormat())) + "bpp)");
+			common::toString(m_render_context->getFormat()) + " (" +
+			common::toString(common::getBitsPerPixel(m_render_context->getFormat())) + "bpp)");
 
 		if(m_scene != nullptr) {
 			getDebugInfo().insert<common::field::Static, uint32_t>("mesh_count", common::toU32(m_scene->getComponents<scene::SubMesh>().size()));
@@ -32,15 +32,18 @@ namespace frame {
 			rendering::RenderContext& render_context) :
 			m_render_context(render_context)
 		{
-			if (!isSupported(sampling_config)) {
-				return;
-			}
-
 			core::Device& device = m_render_context.getDevice();
 			const core::PhysicalDevice& gpu = device.getPhysicalDevice();
 
 			m_has_timestamps = gpu.getProperties().limits.timestampComputeAndGraphics;
 			m_timestamp_period = gpu.getProperties().limits.timestampPeriod;
+
+			// Frame timestamps do not depend on performance query support, they also feed getGpuFrameTime()
+			createTimestampPool();
+
+			if (!isSupported(sampling_config)) {
+				return;
+			}
 			
 			uint32_t queue_family_index = device.getQueueFamilyIndex(vk::QueueFlagBits::eGraphics);
 			
@@ -218,18 +221,47 @@ namespace frame {
 			}
 			
 			m_query_pool->hostReset(0, num_framebuffers);
+			m_queue_family_index = queue_family_index;
+			m_query_count = num_framebuffers;
+			m_queries_ready = 0;
 
-			if (m_has_timestamps) {
+			return true;
+		}
 
-				vk::QueryPoolCreateInfo timestamp_pool_create_info{};
-				timestamp_pool_create_info.sType = vk::StructureType::eQueryPoolCreateInfo;
-				timestamp_pool_create_info.queryType = vk::QueryType::eTimestamp;
-				timestamp_pool_create_info.queryCount = num_framebuffers * 2;
+		void VulkanStatsProvider::resizeQueryPools() {
+			// The frame count follows the swapchain image count and can grow after creation, the pools hold one slot per frame
+			const size_t frame_count = m_render_context.getRenderFrames().size();
+			const bool resize_timestamps = m_timestamp_pool && m_timestamps_written.size() != frame_count;
+			const bool resize_queries = m_query_pool && m_query_count != frame_count;
+			if (!resize_timestamps && !resize_queries) {
+				return;
+			}
+
+			m_render_context.getDevice().getHandle().waitIdle();
 
-				m_timestamp_pool = std::make_unique<core::QueryPool>(device, timestamp_pool_create_info);
+			if (resize_timestamps) {
+				createTimestampPool();
 			}
 
-			return true;
+			if (resize_queries && !createQueryPools(m_queue_family_index)) {
+				m_query_pool.reset();
+			}
+		}
+
+		void VulkanStatsProvider::createTimestampPool() {
+			if (!m_has_timestamps) {
+				return;
+			}
+
+			uint32_t num_framebuffers = static_cast<uint32_t>(m_render_context.getRenderFrames().size());
+
+			vk::QueryPoolCreateInfo timestamp_pool_create_info{};
+			timestamp_pool_create_info.sType = vk::StructureType::eQueryPoolCreateInfo;
+			timestamp_pool_create_info.queryType = vk::QueryType::eTimestamp;
+			timestamp_pool_create_info.queryCount = num_framebuffers * 2;
+
+			m_timestamp_pool = std::make_unique<core::QueryPool>(m_render_context.getDevice(), timestamp_pool_create_info);
+			m_timestamps_written.assign(num_framebuffers, false);
 		}
 
 		bool VulkanStatsProvider::isSupported(const CounterSamplingConfig& sampling_config) const {
@@ -275,10 +307,23 @@ namespace frame {
 		}
 
 		void VulkanStatsProvider::beginSampling(core::CommandBuffer& command_buffer) {
+			resizeQueryPools();
 
 			uint32_t active_frame_idx = m_render_context.getActiveFrameIndex();
 
 			if (m_timestamp_pool) {
+				// The frame that last used this slot has been waited for, read its timestamps before they are reset
+				if (m_timestamps_written[active_frame_idx]) {
+					std::array<uint64_t, 2> timestamps;
+					vk::Result r = m_timestamp_pool->getResults(active_frame_idx * 2, 2,
+						timestamps.size() * sizeof(uint64_t),
+						timestamps.data(), sizeof(uint64_t),
+						vk::QueryResultFlagBits::e64);
+					if (r == vk::Result::eSuccess) {
+						m_gpu_frame_time = m_timestamp_period * static_cast<float>(timestamps[1] - timestamps[0]) * 0.000000001f;
+					}
+				}
+
 				command_buffer.resetQueryPool(*m_timestamp_pool, active_frame_idx * 2, 1);
 				command_buffer.writeTimestamp(vk::PipelineStageFlagBits::eBottomOfPipe, *m_timestamp_pool, active_frame_idx * 2);
 			}
@@ -304,9 +349,14 @@ namespace frame {
 			if (m_timestamp_pool) {
 				command_buffer.resetQueryPool(*m_timestamp_pool, active_frame_idx * 2 + 1, 1);
 				command_buffer.writeTimestamp(vk::PipelineStageFlagBits::eBottomOfPipe, *m_timestamp_pool, active_frame_idx * 2 + 1);
+				m_timestamps_written[active_frame_idx] = true;
 			}
 		}
 
+		float VulkanStatsProvider::getGpuFrameTime() const {
+			return m_gpu_frame_time;
+		}
+
 		static double getCounterValue(const vk::PerformanceCounterResultKHR& result, vk::PerformanceCounterStorageKHR storage) {
 			switch (storage) {
 			case vk::PerformanceCounterStorageKHR::eInt32:
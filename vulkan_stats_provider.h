@@ -90,10 +90,15 @@ namespace frame {
 			void beginSampling(core::CommandBuffer& cb) override;
 			void endSampling(core::CommandBuffer& cb) override;
 
+			// GPU time between beginSampling() and endSampling() of the last completed frame in seconds, 0 until one is measured
+			float getGpuFrameTime() const;
+
 		private:
 			bool isSupported(const CounterSamplingConfig& sampling_config) const;
 			bool fillVendorData();
 			bool createQueryPools(uint32_t queue_family_index);
+			void createTimestampPool();
+			void resizeQueryPools();
 			float getBestDeltaTime(float sw_delta_time) const;
 
 		private:
@@ -102,10 +107,14 @@ namespace frame {
 			bool m_has_timestamps{ false };
 			float m_timestamp_period{ 1.0f };
 			std::unique_ptr<core::QueryPool> m_timestamp_pool;
+			std::vector<bool> m_timestamps_written;
+			float m_gpu_frame_time{ 0.0f };
 			VendorStatMap m_vendor_data;
 			StatDataMap m_stat_data;
 			std::vector<uint32_t> m_counter_indices;
 			uint32_t m_queries_ready = 0;
+			uint32_t m_queue_family_index = 0;
+			uint32_t m_query_count = 0;
 		};
 	}
 }
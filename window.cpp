@@ -215,6 +215,10 @@ namespace frame {
             case Backend::GLFW:
                 success = window->initGLFW();
                 break;
+            case Backend::Headless:
+                LOGI("Headless window, rendering offscreen");
+                success = true;
+                break;
             default:
                 LOGE("Unsupported window backend");
                 break;
@@ -320,6 +324,9 @@ namespace frame {
             if (m_properties.backend == Backend::GLFW) {
                 return m_glfw_handle ? glfwWindowShouldClose(m_glfw_handle) : true;
             }
+            if (m_properties.backend == Backend::Headless) {
+                return m_close_requested;
+            }
             return true;
         }
 
@@ -333,6 +340,7 @@ namespace frame {
             if (m_properties.backend == Backend::GLFW && m_glfw_handle) {
                 glfwSetWindowShouldClose(m_glfw_handle, GLFW_TRUE);
             }
+            m_close_requested = true;
         }
 
         float Window::getDpiFactor() const {
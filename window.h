@@ -34,7 +34,9 @@ namespace frame {
         public:
             enum class Backend {
                 GLFW,
-                WIN
+                WIN,
+                // No surface, the RenderContext renders into offscreen targets
+                Headless
             };
             
             struct Extent {
@@ -65,6 +67,7 @@ namespace frame {
                 std::optional<Mode> mode;
                 std::optional<bool> resizable;
                 std::optional<Vsync> vsync;
+                std::optional<Backend> backend;
                 OptionalExtent extent;
             };
             
@@ -114,6 +117,8 @@ namespace frame {
             
             GLFWwindow* getGLFWHandle() const { return m_glfw_handle; }
 
+            bool isHeadless() const { return m_properties.backend == Backend::Headless; }
+
         private:
             
             Window(Platform* platform, const Properties& properties);
@@ -124,6 +129,7 @@ namespace frame {
             Platform* m_platform;
             Properties m_properties;
             GLFWwindow* m_glfw_handle{ nullptr };
+            bool m_close_requested{ false };
         };
     }
 }